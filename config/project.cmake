@@ -451,6 +451,37 @@ if(FLECSI_RUNTIME_MODEL STREQUAL "mpi")
   option(FLECSI_USE_AGGCOMM
 	"Use (lazy) aggregated communication for dense fields"
 	ON)
+
+  #------------------------------------------------------------------------------#
+  # Use split-phase (deferred completion) ghost exchange for dense fields
+  #------------------------------------------------------------------------------#
+  option(FLECSI_USE_SPLIT_PHASE_GHOSTS
+	"Defer completion of non-aggregated dense ghost exchanges until ghosts are read"
+	OFF)
+
+  #------------------------------------------------------------------------------#
+  # Drain asynchronous HDF5 checkpoints from a background I/O thread
+  #------------------------------------------------------------------------------#
+  option(FLECSI_USE_ASYNC_CHECKPOINT
+	"Write asynchronous checkpoints from a background thread (requires MPI_THREAD_MULTIPLE)"
+	OFF)
+
+  #------------------------------------------------------------------------------#
+  # Alignment and huge pages for field data
+  #------------------------------------------------------------------------------#
+  set(FLECSI_FIELD_ALIGNMENT "64" CACHE STRING
+	"Alignment in bytes of field data buffers (a power of two)")
+
+  option(FLECSI_USE_HUGE_PAGES
+	"Request transparent huge pages for field data buffers of at least 2MB"
+	OFF)
+
+  #------------------------------------------------------------------------------#
+  # Fuse the reductions of task results into one collective
+  #------------------------------------------------------------------------------#
+  option(FLECSI_USE_FUSED_REDUCTIONS
+	"Complete pending task reductions with one collective when the first is waited on"
+	OFF)
 endif()
 
 #------------------------------------------------------------------------------#
@@ -15,6 +15,12 @@
 
 /*! @file */
 
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <ostream>
+#include <vector>
+
 #include <flecsi/utils/array_ref.h>
 
 namespace flecsi {
@@ -224,6 +230,51 @@ struct crs_t {
 
 }; // struct crs_t
 
+/*!
+  A read-only view of compressed-storage data that is owned elsewhere, e.g.,
+  by a memory-mapped file. The offsets may be those of a contiguous block
+  of a larger structure: they are taken relative to the first one.
+
+  @ingroup coloring
+ */
+
+struct crs_view_t {
+
+  using value_type = size_t;
+
+  utils::span<const size_t> offsets;
+  utils::span<const size_t> indices;
+
+  size_t size() const {
+    if(offsets.empty())
+      return 0;
+    else
+      return offsets.size() - 1;
+  } // size
+
+  utils::span<const size_t> operator[](size_t i) const {
+    return indices.subspan(
+      offsets[i] - offsets[0], offsets[i + 1] - offsets[i]);
+  }
+
+  utils::span<const size_t> at(size_t i) const {
+    assert(i < size() && "index out of range");
+    return (*this)[i];
+  }
+
+  /// \brief copy the viewed data into a crs_t
+  crs_t to_crs() const {
+    crs_t crs;
+    crs.offsets.reserve(offsets.size());
+    for(auto o : offsets) {
+      crs.offsets.push_back(o - offsets[0]);
+    }
+    crs.indices.assign(indices.begin(), indices.end());
+    return crs;
+  }
+
+}; // struct crs_view_t
+
 /*!
   Helper function to print a crs_t instance.
  */
@@ -24,7 +24,10 @@
 
 #include <mpi.h>
 
+#include <limits>
 #include <map>
+#include <unordered_map>
+#include <vector>
 
 #include <flecsi/coloring/crs.h>
 #include <flecsi/topology/closure_utils.h>
@@ -380,6 +383,113 @@ alltoallv(const SEND_TYPE & sendbuf,
   return ret;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Sparse all-to-all of variable-length buffers.
+///
+/// Every rank sends sendbufs[r] to each rank r it has a buffer for, and
+/// receives the buffers sent to it in recvbufs, keyed by source rank. Ranks
+/// exchange no per-rank counts: the senders are discovered with the NBX
+/// algorithm of Hoefler et al. The buffers are sent with synchronous sends,
+/// and every rank receives whatever arrives until a non-blocking barrier,
+/// entered once its own sends have been matched, completes. The cost is
+/// therefore proportional to the number of neighbors rather than to the
+/// number of ranks.
+///
+/// The exchange runs on a duplicate of \e comm, so that its messages cannot
+/// be matched by any other communication, including another exchange.
+/// Buffers of more than INT_MAX elements are split into several messages,
+/// which arrive in order.
+////////////////////////////////////////////////////////////////////////////////
+template<typename T>
+int
+sparse_alltoallv(const std::map<size_t, std::vector<T>> & sendbufs,
+  std::map<size_t, std::vector<T>> & recvbufs,
+  decltype(MPI_COMM_WORLD) comm) {
+
+  const auto mpi_t = utils::mpi_typetraits_u<T>::type();
+
+  const size_t intmax = std::numeric_limits<int>::max() - 1;
+  const int tag = 0;
+
+  MPI_Comm dup;
+  auto ret = MPI_Comm_dup(comm, &dup);
+  if(ret != MPI_SUCCESS)
+    return ret;
+
+  // the exchange proper, after which the duplicate is freed on every path
+  auto exchange = [&]() {
+    int ret;
+
+    recvbufs.clear();
+
+    // send the non-empty buffers
+    std::vector<MPI_Request> requests;
+
+    for(const auto & buf : sendbufs) {
+      const auto & data = buf.second;
+      for(size_t start = 0; start < data.size(); start += intmax) {
+        auto sz = std::min(data.size() - start, intmax);
+        requests.resize(requests.size() + 1);
+        ret = MPI_Issend(data.data() + start, sz, mpi_t, buf.first, tag, dup,
+          &requests.back());
+        if(ret != MPI_SUCCESS)
+          return ret;
+      }
+    }
+
+    // receive until everybody's sends have been matched
+    MPI_Request barrier;
+    bool in_barrier = false;
+
+    for(;;) {
+      int flag;
+      MPI_Status status;
+
+      ret = MPI_Iprobe(MPI_ANY_SOURCE, tag, dup, &flag, &status);
+      if(ret != MPI_SUCCESS)
+        return ret;
+
+      if(flag) {
+        int count;
+        MPI_Get_count(&status, mpi_t, &count);
+        auto & data = recvbufs[status.MPI_SOURCE];
+        auto start = data.size();
+        data.resize(start + count);
+        ret = MPI_Recv(data.data() + start, count, mpi_t, status.MPI_SOURCE,
+          tag, dup, MPI_STATUS_IGNORE);
+        if(ret != MPI_SUCCESS)
+          return ret;
+      }
+
+      if(in_barrier) {
+        ret = MPI_Test(&barrier, &flag, MPI_STATUS_IGNORE);
+        if(ret != MPI_SUCCESS)
+          return ret;
+        if(flag)
+          break;
+      }
+      else {
+        ret = MPI_Testall(
+          requests.size(), requests.data(), &flag, MPI_STATUSES_IGNORE);
+        if(ret != MPI_SUCCESS)
+          return ret;
+        if(flag) {
+          ret = MPI_Ibarrier(dup, &barrier);
+          if(ret != MPI_SUCCESS)
+            return ret;
+          in_barrier = true;
+        }
+      }
+    }
+
+    return MPI_SUCCESS;
+  };
+
+  ret = exchange();
+  const auto free_ret = MPI_Comm_free(&dup);
+  return ret != MPI_SUCCESS ? ret : free_ret;
+}
+
 template<typename SEND_TYPE, typename ID_TYPE, typename RECV_TYPE>
 auto
 alltoall(const SEND_TYPE & sendbuf,
@@ -543,7 +653,8 @@ make_dcrs_distributed(
   //----------------------------------------------------------------------------
 
   // essentially vertex to cell connectivity
-  std::map<size_t, std::vector<size_t>> vertex2cell;
+  std::unordered_map<size_t, std::vector<size_t>> vertex2cell;
+  vertex2cell.reserve(vertex_local_to_global.size());
 
   using entities_t = decltype(md.entities_crs(0, 0));
   using decayed_entities_t = std::decay_t<entities_t>;
@@ -583,64 +694,24 @@ make_dcrs_distributed(
 
   // We send the results for each vertex to their owner rank, which was
   // defined using the vertex subdivision above
-  std::vector<size_t> sendcounts(size, 0);
+  std::map<size_t, std::vector<size_t>> sendbufs;
 
-  // count
   for(const auto & vs_pair : vertex2cell) {
     size_t global_id = vs_pair.first;
     auto r = rank_owner(vert_dist, global_id);
     // we will be sending vertex id, number of cells, plus cell ids
     if(r != rank) {
-      auto n = 2 + vs_pair.second.size();
-      sendcounts[r] += n;
-    }
-  }
-
-  // finish displacements
-  std::vector<size_t> senddispls(size + 1);
-  senddispls[0] = 0;
-  for(size_t r = 0; r < size; ++r) {
-    senddispls[r + 1] = senddispls[r] + sendcounts[r];
-    sendcounts[r] = 0;
-  }
-
-  // fill buffers
-  std::vector<size_t> sendbuf(senddispls[size]);
-
-  for(const auto & vs_pair : vertex2cell) {
-    size_t global_id = vs_pair.first;
-    auto r = rank_owner(vert_dist, global_id);
-    // we will be sending vertex id, number of cells, plus cell ids
-    if(r != rank) {
-      // get offset
-      auto offset = senddispls[r] + sendcounts[r];
-      // populate data
-      sendbuf[offset++] = global_id;
-      sendbuf[offset++] = vs_pair.second.size();
-      for(auto v : vs_pair.second)
-        sendbuf[offset++] = v;
-      // bump counters
-      auto n = 2 + vs_pair.second.size();
-      sendcounts[r] += n;
+      auto & sendbuf = sendbufs[r];
+      sendbuf.emplace_back(global_id);
+      sendbuf.emplace_back(vs_pair.second.size());
+      sendbuf.insert(
+        sendbuf.end(), vs_pair.second.begin(), vs_pair.second.end());
     }
   }
 
-  std::vector<size_t> recvcounts(size, 0);
-  auto ret = MPI_Alltoall(sendcounts.data(), 1, mpi_size_t, recvcounts.data(),
-    1, mpi_size_t, MPI_COMM_WORLD);
-  if(ret != MPI_SUCCESS)
-    clog_error("Error communicating vertex counts");
-
-  // how much info will we be receiving
-  std::vector<size_t> recvdispls(size + 1);
-  recvdispls[0] = 0;
-  for(size_t r = 0; r < size; ++r)
-    recvdispls[r + 1] = recvdispls[r] + recvcounts[r];
-  std::vector<size_t> recvbuf(recvdispls[size]);
-
   // now send the actual vertex info
-  ret = alltoallv(sendbuf, sendcounts, senddispls, recvbuf, recvcounts,
-    recvdispls, MPI_COMM_WORLD);
+  std::map<size_t, std::vector<size_t>> recvbufs;
+  auto ret = sparse_alltoallv(sendbufs, recvbufs, MPI_COMM_WORLD);
   if(ret != MPI_SUCCESS)
     clog_error("Error communicating vertices");
 
@@ -649,28 +720,34 @@ make_dcrs_distributed(
   //----------------------------------------------------------------------------
 
   // and add the results to our local list
-  std::map<size_t, std::vector<size_t>> vertex2rank;
-
-  for(size_t r = 0; r < size; ++r) {
-    for(size_t i = recvdispls[r]; i < recvdispls[r + 1];) {
-      // get vertex
-      auto vertex = recvbuf[i];
-      ++i;
-      // keep track of ranks that share this vertex
-      vertex2rank[vertex].emplace_back(r);
-      assert(i < recvdispls[r + 1]);
-      // unpack cell neighbors
-      auto n = recvbuf[i];
-      ++i;
-      for(size_t j = 0; j < n; ++j) {
-        assert(i < recvdispls[r + 1]);
-        auto cell = recvbuf[i];
+  std::unordered_map<size_t, std::vector<size_t>> vertex2rank;
+
+  auto unpack_vertices = [&](const auto & recvbufs) {
+    for(const auto & recv_pair : recvbufs) {
+      auto r = recv_pair.first;
+      const auto & recvbuf = recv_pair.second;
+      for(size_t i = 0; i < recvbuf.size();) {
+        // get vertex
+        auto vertex = recvbuf[i];
+        ++i;
+        // keep track of ranks that share this vertex
+        vertex2rank[vertex].emplace_back(r);
+        assert(i < recvbuf.size());
+        // unpack cell neighbors
+        auto n = recvbuf[i];
         ++i;
-        // might not already be there
-        vertex2cell[vertex].emplace_back(cell);
+        for(size_t j = 0; j < n; ++j) {
+          assert(i < recvbuf.size());
+          auto cell = recvbuf[i];
+          ++i;
+          // might not already be there
+          vertex2cell[vertex].emplace_back(cell);
+        }
       }
     }
-  }
+  };
+
+  unpack_vertices(recvbufs);
 
   // remove duplicates
   remove_duplicates(vertex2cell);
@@ -680,71 +757,24 @@ make_dcrs_distributed(
   //----------------------------------------------------------------------------
 
   // now perpare to send results back
-
-  // count send buffer size
-  std::fill(sendcounts.begin(), sendcounts.end(), 0);
+  sendbufs.clear();
   for(const auto & vertex_pair : vertex2rank) {
     auto vertex = vertex_pair.first;
     for(auto r : vertex_pair.second) {
       if(r != rank) { // should always enter anyway!
+        auto & sendbuf = sendbufs[r];
         // better already be there
         const auto & cells = vertex2cell.at(vertex);
         // we will be sending vertex id, number of cells, plus cell ids
-        auto n = 2 + cells.size();
-        sendcounts[r] += n;
+        sendbuf.emplace_back(vertex);
+        sendbuf.emplace_back(cells.size());
+        sendbuf.insert(sendbuf.end(), cells.begin(), cells.end());
       }
     }
   }
 
-  // finish displacements
-  senddispls[0] = 0;
-  for(size_t r = 0; r < size; ++r)
-    senddispls[r + 1] = senddispls[r] + sendcounts[r];
-
-  // resize send buffer
-  sendbuf.clear();
-  sendbuf.resize(senddispls[size]);
-
-  // now fill buffer
-  std::fill(sendcounts.begin(), sendcounts.end(), 0);
-  for(const auto & vertex_pair : vertex2rank) {
-    auto vertex = vertex_pair.first;
-    for(auto r : vertex_pair.second) {
-      if(r != rank) { // should always enter anyway!
-        auto j = senddispls[r] + sendcounts[r];
-        // better already be there
-        const auto & cells = vertex2cell.at(vertex);
-        // we will be sending vertex id, number of cells, plus cell ids
-        auto n = 2 + cells.size();
-        sendbuf[j++] = vertex;
-        sendbuf[j++] = cells.size();
-        for(auto c : cells)
-          sendbuf[j++] = c;
-        // increment send counter
-        sendcounts[r] = j - senddispls[r];
-      }
-    }
-  }
-
-  // send counts
-  std::fill(recvcounts.begin(), recvcounts.end(), 0);
-  ret = MPI_Alltoall(sendcounts.data(), 1, mpi_size_t, recvcounts.data(), 1,
-    mpi_size_t, MPI_COMM_WORLD);
-  if(ret != MPI_SUCCESS)
-    clog_error("Error communicating back vertex counts");
-
-  // how much info will we be receiving
-  recvdispls[0] = 0;
-  for(size_t r = 0; r < size; ++r)
-    recvdispls[r + 1] = recvdispls[r] + recvcounts[r];
-
-  // how much info will we be receiving
-  recvbuf.clear();
-  recvbuf.resize(recvdispls.at(size));
-
   // now send the final vertex info back
-  ret = alltoallv(sendbuf, sendcounts, senddispls, recvbuf, recvcounts,
-    recvdispls, MPI_COMM_WORLD);
+  ret = sparse_alltoallv(sendbufs, recvbufs, MPI_COMM_WORLD);
   if(ret != MPI_SUCCESS)
     clog_error("Error communicating new vertices");
 
@@ -752,26 +782,7 @@ make_dcrs_distributed(
   // Append received vertex information to the local vertex-to-cell graph
   //----------------------------------------------------------------------------
 
-  for(size_t r = 0; r < size; ++r) {
-    for(size_t i = recvdispls[r]; i < recvdispls[r + 1];) {
-      // get vertex
-      auto vertex = recvbuf[i];
-      ++i;
-      // keep track of ranks that share this vertex
-      vertex2rank[vertex].emplace_back(r);
-      assert(i < recvdispls[r + 1]);
-      // unpack cell neighbors
-      auto n = recvbuf[i];
-      ++i;
-      for(size_t j = 0; j < n; ++j) {
-        assert(i < recvdispls[r + 1]);
-        auto cell = recvbuf[i];
-        ++i;
-        // might not already be there
-        vertex2cell[vertex].emplace_back(cell);
-      }
-    }
-  }
+  unpack_vertices(recvbufs);
 
   // remove duplicates
   remove_duplicates(vertex2cell);
@@ -785,12 +796,12 @@ make_dcrs_distributed(
   dcrs.indices.reserve(from_dimension * from_dimension * num_cells); // guess
   dcrs.offsets.push_back(0);
 
-  std::map<size_t, size_t> cell_counts;
+  std::vector<size_t> others;
 
   for(size_t ic = 0; ic < num_cells; ++ic) {
     auto cell = cells_start + ic;
 
-    cell_counts.clear();
+    others.clear();
 
     // iterate over vertices
     auto start = cells2vertex.offsets[ic];
@@ -798,22 +809,27 @@ make_dcrs_distributed(
     for(auto i = start; i < end; ++i) {
       auto iv = cells2vertex.indices[i];
       auto vertex = vertex_local_to_global[iv];
-      // now count attached cells
+      // now collect attached cells
       for(auto other : vertex2cell.at(vertex)) {
-        // new entries are initialized to zero
         if(other != cell)
-          cell_counts[other] += 1;
+          others.emplace_back(other);
       }
     }
 
+    // each cell appears once per shared vertex, so after sorting, the
+    // length of a run is the number of connections
+    std::sort(others.begin(), others.end());
+
     // now add results
     int num_connections{0};
 
-    for(auto count : cell_counts) {
-      if(count.second >= min_connections) {
-        dcrs.indices.emplace_back(count.first);
+    for(auto it = others.begin(); it != others.end();) {
+      auto last = std::upper_bound(it, others.end(), *it);
+      if(size_t(std::distance(it, last)) >= min_connections) {
+        dcrs.indices.emplace_back(*it);
         num_connections++;
       }
+      it = last;
     }
 
     dcrs.offsets.emplace_back(dcrs.offsets.back() + num_connections);
@@ -856,55 +872,39 @@ migrate(size_t dimension,
 
   using byte_t =
     typename topology::parallel_mesh_definition_u<DIMENSION>::byte_t;
-  std::vector<size_t> sendcounts(comm_size, 0);
-  std::vector<size_t> senddispls(comm_size + 1);
-  std::vector<byte_t> sendbuf;
+  std::map<size_t, std::vector<byte_t>> sendbufs;
   std::vector<size_t> erase_local_ids;
 
-  senddispls[0] = 0;
   auto num_elements = dcrs.size();
 
-  // Find the indices we need torequest.
-  for(size_t rank(0); rank < comm_size; ++rank) {
-
-    // keep track of the buffer beginning
-    auto start_buf = sendbuf.size();
+  // loop over entities we partitionied
+  for(size_t local_id(0); local_id < num_elements; ++local_id) {
 
-    // loop over entities we partitionied
-    for(size_t local_id(0); local_id < num_elements && rank != comm_rank;
-        ++local_id) {
+    // the global id
+    auto global_id = dcrs.distribution[comm_rank] + local_id;
+    auto partition_id = partitioning[local_id];
 
-      // the global id
-      auto global_id = dcrs.distribution[comm_rank] + local_id;
-      auto partition_id = partitioning[local_id];
-
-      //------------------------------------------------------------------------
-      // No migration necessary
-      if(owned_by(partition_dist, partition_id, comm_rank)) {
-        // just keep track of the global ids
-      }
-      //------------------------------------------------------------------------
-      // Entity to be migrated
-      else if(owned_by(partition_dist, partition_id, rank)) {
-        // mark for deletion
-        erase_local_ids.emplace_back(local_id);
-        // global id
-        topology::cast_insert(&global_id, 1, sendbuf);
-        // dcrs info
-        auto start = dcrs.offsets[local_id];
-        auto num_offsets = dcrs.offsets[local_id + 1] - start;
-        topology::cast_insert(&num_offsets, 1, sendbuf);
-        topology::cast_insert(&dcrs.indices[start], num_offsets, sendbuf);
-        // now specific info related to mesh
-        md.pack(dimension, local_id, sendbuf);
-      }
-    } // for entities
-
-    // keep track of offsets
-    sendcounts[rank] = sendbuf.size() - start_buf;
-    senddispls[rank + 1] = senddispls[rank] + sendcounts[rank];
+    //--------------------------------------------------------------------------
+    // No migration necessary
+    if(owned_by(partition_dist, partition_id, comm_rank))
+      continue;
 
-  } // for ranks
+    //--------------------------------------------------------------------------
+    // Entity to be migrated
+    auto rank = rank_owner(partition_dist, partition_id);
+    auto & sendbuf = sendbufs[rank];
+    // mark for deletion
+    erase_local_ids.emplace_back(local_id);
+    // global id
+    topology::cast_insert(&global_id, 1, sendbuf);
+    // dcrs info
+    auto start = dcrs.offsets[local_id];
+    auto num_offsets = dcrs.offsets[local_id + 1] - start;
+    topology::cast_insert(&num_offsets, 1, sendbuf);
+    topology::cast_insert(&dcrs.indices[start], num_offsets, sendbuf);
+    // now specific info related to mesh
+    md.pack(dimension, local_id, sendbuf);
+  } // for entities
 
   //----------------------------------------------------------------------------
   // Erase entities to be migrated
@@ -934,22 +934,9 @@ migrate(size_t dimension,
   // the mpi data type for size_t
   const auto mpi_size_t = utils::mpi_typetraits_u<size_t>::type();
 
-  std::vector<size_t> recvcounts(comm_size, 0);
-  auto ret = MPI_Alltoall(sendcounts.data(), 1, mpi_size_t, recvcounts.data(),
-    1, mpi_size_t, MPI_COMM_WORLD);
-  if(ret != MPI_SUCCESS)
-    clog_error("Error communicating vertex counts");
-
-  // how much info will we be receiving
-  std::vector<size_t> recvdispls(comm_size + 1);
-  recvdispls[0] = 0;
-  for(size_t r = 0; r < comm_size; ++r)
-    recvdispls[r + 1] = recvdispls[r] + recvcounts[r];
-  std::vector<byte_t> recvbuf(recvdispls[comm_size]);
-
   // now send the actual info
-  ret = alltoallv(sendbuf, sendcounts, senddispls, recvbuf, recvcounts,
-    recvdispls, MPI_COMM_WORLD);
+  std::map<size_t, std::vector<byte_t>> recvbufs;
+  auto ret = sparse_alltoallv(sendbufs, recvbufs, MPI_COMM_WORLD);
   if(ret != MPI_SUCCESS)
     clog_error("Error communicating vertices");
 
@@ -958,18 +945,18 @@ migrate(size_t dimension,
   //----------------------------------------------------------------------------
 
   // Add indices to primary
-  for(size_t rank(0); rank < comm_size; ++rank) {
+  for(const auto & recv_pair : recvbufs) {
 
-    auto start = recvdispls[rank];
-    auto end = recvdispls[rank + 1];
-    const auto * buffer = &recvbuf[start];
-    const auto * buffer_end = &recvbuf[end];
+    const auto & recvbuf = recv_pair.second;
+    const auto end = recvbuf.size();
+    const auto * buffer = recvbuf.data();
+    const auto * buffer_end = buffer + end;
 
     // Typically, one would check for equality between an iterator address
     // and the ending pointer address.  This might cause an infinate loop
     // if there is an error in unpacking.  So I think testing on byte
     // index is safer since there is no danger of iterating past the end.
-    for(size_t i = start; i < end;) {
+    for(size_t i = 0; i < end;) {
 
       // capture start of buffer
       const auto * buffer_start = buffer;
@@ -1148,31 +1135,7 @@ color_entities(const flecsi::coloring::crs_t & cells2entity,
   // Determine cell-to-vertex connecitivity for my shared cells
   //----------------------------------------------------------------------------
 
-  // first count for storage
-  std::vector<size_t> sendcounts(comm_size, 0);
-  std::vector<size_t> senddispls(comm_size + 1);
-
-  for(const auto & c : cells.shared) {
-    // get cell info
-    auto start = cells2entity.offsets[c.offset];
-    auto end = cells2entity.offsets[c.offset + 1];
-    auto n = end - start;
-    // loop over shared ranks
-    for(auto r : c.shared) {
-      // we will be sending the cell number of vertices, plus vertices
-      if(r != comm_rank)
-        sendcounts[r] += 1 + n;
-    }
-  }
-
-  // finish displacements
-  senddispls[0] = 0;
-  for(size_t r = 0; r < comm_size; ++r)
-    senddispls[r + 1] = senddispls[r] + sendcounts[r];
-
-  // now fill buffers
-  std::vector<size_t> sendbuf(senddispls[comm_size]);
-  std::fill(sendcounts.begin(), sendcounts.end(), 0);
+  std::map<size_t, std::vector<size_t>> sendbufs;
 
   for(const auto & c : cells.shared) {
     // get cell info
@@ -1183,16 +1146,13 @@ color_entities(const flecsi::coloring::crs_t & cells2entity,
     for(auto r : c.shared) {
       // we will be sending number of vertices, plus vertices
       if(r != comm_rank) {
-        // first the id and size
-        auto j = senddispls[r] + sendcounts[r];
-        sendbuf[j++] = n;
+        auto & sendbuf = sendbufs[r];
+        sendbuf.emplace_back(n);
         for(auto i = start; i < end; ++i) {
           auto local_id = cells2entity.indices[i];
           auto global_id = local2global[local_id];
-          sendbuf[j++] = global_id;
+          sendbuf.emplace_back(global_id);
         }
-        // increment send counter
-        sendcounts[r] = j - senddispls[r];
       }
     } // shared ranks
   }
@@ -1201,26 +1161,12 @@ color_entities(const flecsi::coloring::crs_t & cells2entity,
   // Send shared information
   //----------------------------------------------------------------------------
 
-  // send the counts
-  std::vector<size_t> recvcounts(comm_size);
-  auto ret = MPI_Alltoall(sendcounts.data(), 1, mpi_size_t, recvcounts.data(),
-    1, mpi_size_t, MPI_COMM_WORLD);
-  if(ret != MPI_SUCCESS)
-    clog_error("Error communicating vertex counts");
-
-  // how much info will we be receiving
-  std::vector<size_t> recvdispls(comm_size + 1);
-  recvdispls[0] = 0;
-  for(size_t r = 0; r < comm_size; ++r)
-    recvdispls[r + 1] = recvdispls[r] + recvcounts[r];
-  std::vector<size_t> recvbuf(recvdispls[comm_size]);
-
   // figure out the size of the connectivity array
   connectivity_counts = cells2entity.indices.size();
 
   // now send the actual vertex info
-  ret = alltoallv(sendbuf, sendcounts, senddispls, recvbuf, recvcounts,
-    recvdispls, MPI_COMM_WORLD);
+  std::map<size_t, std::vector<size_t>> recvbufs;
+  auto ret = sparse_alltoallv(sendbufs, recvbufs, MPI_COMM_WORLD);
   if(ret != MPI_SUCCESS)
     clog_error("Error communicating vertices");
 
@@ -1231,14 +1177,15 @@ color_entities(const flecsi::coloring::crs_t & cells2entity,
   // set of possible ghost vertices
   std::vector<size_t> potential_ghost;
 
-  for(size_t r = 0; r < comm_size; ++r) {
-    for(size_t i = recvdispls[r]; i < recvdispls[r + 1];) {
+  for(const auto & recv_pair : recvbufs) {
+    const auto & recvbuf = recv_pair.second;
+    for(size_t i = 0; i < recvbuf.size();) {
       // num of vertices
       auto n = recvbuf[i];
       i++;
       connectivity_counts += n;
       // no sift through ghost vertices
-      for(auto j = 0; j < n; ++j, ++i) {
+      for(size_t j = 0; j < n; ++j, ++i) {
         // local and global ids of the vertex (relative to sender)
         auto ent_global_id = recvbuf[i];
         // Don't bother checking if i have this vertex yet, even if I already
@@ -1281,41 +1228,21 @@ color_entities(const flecsi::coloring::crs_t & cells2entity,
     std::vector<size_t> ghost_ranks;
     owner_t(size_t r, size_t id) : rank(r), local_id(id) {}
   };
-  std::map<size_t, owner_t> entities2rank;
+  std::unordered_map<size_t, owner_t> entities2rank;
 
   // We send the results for each vertex to their owner rank, which was
   // defined using the vertex subdivision above
-  std::fill(sendcounts.begin(), sendcounts.end(), 0);
-
-  for(auto local_id : potential_shared) {
-    auto global_id = local2global[local_id];
-    // who owns this vertex
-    auto rank = rank_owner(ent_dist, global_id);
-    // we will be sending global and local ids
-    if(rank != comm_rank)
-      sendcounts[rank] += 2;
-  } // vert
-
-  // finish displacements
-  senddispls[0] = 0;
-  for(size_t r = 0; r < comm_size; ++r)
-    senddispls[r + 1] = senddispls[r] + sendcounts[r];
-
-  // now fill buffers
-  sendbuf.clear();
-  sendbuf.resize(senddispls[comm_size]);
-  std::fill(sendcounts.begin(), sendcounts.end(), 0);
+  sendbufs.clear();
 
   for(const auto & local_id : potential_shared) {
     auto global_id = local2global[local_id];
     // who owns this vertex
     auto rank = rank_owner(ent_dist, global_id);
-    // we will be sending vertex id, number of cells, plus cell ids
+    // we will be sending global and local ids
     if(rank != comm_rank) {
-      auto i = senddispls[rank] + sendcounts[rank];
-      sendbuf[i] = global_id;
-      sendbuf[i + 1] = local_id;
-      sendcounts[rank] += 2;
+      auto & sendbuf = sendbufs[rank];
+      sendbuf.emplace_back(global_id);
+      sendbuf.emplace_back(local_id);
     }
     // if its ours, just add it to the list
     else {
@@ -1323,29 +1250,16 @@ color_entities(const flecsi::coloring::crs_t & cells2entity,
     }
   } // vert
 
-  // send counts
-  ret = MPI_Alltoall(sendcounts.data(), 1, mpi_size_t, recvcounts.data(), 1,
-    mpi_size_t, MPI_COMM_WORLD);
-  if(ret != MPI_SUCCESS)
-    clog_error("Error communicating vertex counts");
-
-  // how much info will we be receiving
-  recvdispls[0] = 0;
-  for(size_t r = 0; r < comm_size; ++r)
-    recvdispls[r + 1] = recvdispls[r] + recvcounts[r];
-
-  recvbuf.clear();
-  recvbuf.resize(recvdispls[comm_size]);
-
   // now send the actual vertex info
-  ret = alltoallv(sendbuf, sendcounts, senddispls, recvbuf, recvcounts,
-    recvdispls, MPI_COMM_WORLD);
+  ret = sparse_alltoallv(sendbufs, recvbufs, MPI_COMM_WORLD);
   if(ret != MPI_SUCCESS)
     clog_error("Error communicating vertices");
 
   // upack results
-  for(size_t r = 0; r < comm_size; ++r) {
-    for(size_t i = recvdispls[r]; i < recvdispls[r + 1]; i += 2) {
+  for(const auto & recv_pair : recvbufs) {
+    auto r = recv_pair.first;
+    const auto & recvbuf = recv_pair.second;
+    for(size_t i = 0; i < recvbuf.size(); i += 2) {
       auto global_id = recvbuf[i];
       auto local_id = recvbuf[i + 1];
       auto res = entities2rank.emplace(global_id, owner_t{r, local_id});
@@ -1361,34 +1275,14 @@ color_entities(const flecsi::coloring::crs_t & cells2entity,
 
   // We send the results for each vertex to their owner rank, which was
   // defined using the vertex subdivision above
-  std::fill(sendcounts.begin(), sendcounts.end(), 0);
-
-  for(auto global_id : potential_ghost) {
-    // who owns this vertex
-    auto rank = rank_owner(ent_dist, global_id);
-    // we will be sending global ids
-    if(rank != comm_rank)
-      sendcounts[rank]++;
-  } // vert
-
-  // finish displacements
-  senddispls[0] = 0;
-  for(size_t r = 0; r < comm_size; ++r)
-    senddispls[r + 1] = senddispls[r] + sendcounts[r];
-
-  // now fill buffers
-  sendbuf.clear();
-  sendbuf.resize(senddispls[comm_size]);
-  std::fill(sendcounts.begin(), sendcounts.end(), 0);
+  sendbufs.clear();
 
   for(const auto & global_id : potential_ghost) {
     // who owns this vertex
     auto rank = rank_owner(ent_dist, global_id);
     // we will be sending global ids
     if(rank != comm_rank) {
-      auto i = senddispls[rank] + sendcounts[rank];
-      sendbuf[i] = global_id;
-      sendcounts[rank]++;
+      sendbufs[rank].emplace_back(global_id);
     }
     // otherwise, i am responsible for this ghost
     else {
@@ -1399,30 +1293,15 @@ color_entities(const flecsi::coloring::crs_t & cells2entity,
     }
   } // vert
 
-  // send counts
-  ret = MPI_Alltoall(sendcounts.data(), 1, mpi_size_t, recvcounts.data(), 1,
-    mpi_size_t, MPI_COMM_WORLD);
-  if(ret != MPI_SUCCESS)
-    clog_error("Error communicating vertex counts");
-
-  // how much info will we be receiving
-  recvdispls[0] = 0;
-  for(size_t r = 0; r < comm_size; ++r)
-    recvdispls[r + 1] = recvdispls[r] + recvcounts[r];
-
-  recvbuf.clear();
-  recvbuf.resize(recvdispls[comm_size]);
-
   // now send the actual vertex info
-  ret = alltoallv(sendbuf, sendcounts, senddispls, recvbuf, recvcounts,
-    recvdispls, MPI_COMM_WORLD);
+  ret = sparse_alltoallv(sendbufs, recvbufs, MPI_COMM_WORLD);
   if(ret != MPI_SUCCESS)
     clog_error("Error communicating vertices");
 
   // upack results
-  for(size_t r = 0; r < comm_size; ++r) {
-    for(size_t i = recvdispls[r]; i < recvdispls[r + 1]; i++) {
-      auto global_id = recvbuf[i];
+  for(const auto & recv_pair : recvbufs) {
+    auto r = recv_pair.first;
+    for(auto global_id : recv_pair.second) {
       // definately a ghost!
       auto & owner = entities2rank.at(global_id);
       if(owner.rank != r) {
@@ -1434,33 +1313,9 @@ color_entities(const flecsi::coloring::crs_t & cells2entity,
   //----------------------------------------------------------------------------
   // Send back the ghost/shared information to everyone that needs it
   //----------------------------------------------------------------------------
-  std::fill(sendcounts.begin(), sendcounts.end(), 0);
+  sendbufs.clear();
 
-  // figure out send counts
   std::vector<size_t> ranks;
-  for(const auto & pair : entities2rank) {
-    const auto owner = pair.second;
-    // who am i sending to
-    ranks.assign(owner.ghost_ranks.begin(), owner.ghost_ranks.end());
-    ranks.push_back(owner.rank);
-    // we will be sending id+rank+offset+num_ghost+ghost_ranks
-    auto n = 4 + owner.ghost_ranks.size();
-    for(auto rank : ranks) {
-      if(rank != comm_rank)
-        sendcounts[rank] += n;
-    }
-  } // vert
-
-  // finish displacements
-  senddispls[0] = 0;
-  for(size_t r = 0; r < comm_size; ++r)
-    senddispls[r + 1] = senddispls[r] + sendcounts[r];
-
-  // now fill buffers
-  sendbuf.clear();
-  sendbuf.resize(senddispls[comm_size]);
-  std::fill(sendcounts.begin(), sendcounts.end(), 0);
-
   for(const auto & pair : entities2rank) {
     auto global_id = pair.first;
     const auto owner = pair.second;
@@ -1468,45 +1323,29 @@ color_entities(const flecsi::coloring::crs_t & cells2entity,
     ranks.assign(owner.ghost_ranks.begin(), owner.ghost_ranks.end());
     ranks.push_back(owner.rank);
     // we will be sending id+rank+offset+num_ghost+ghost_ranks
-    auto n = 4 + owner.ghost_ranks.size();
     for(auto rank : ranks) {
       // we will be sending global ids
       if(rank != comm_rank) {
-        auto i = senddispls[rank] + sendcounts[rank];
-        sendbuf[i++] = global_id;
-        sendbuf[i++] = owner.rank;
-        sendbuf[i++] = owner.local_id;
-        sendbuf[i++] = owner.ghost_ranks.size();
-        for(auto r : owner.ghost_ranks)
-          sendbuf[i++] = r;
-        sendcounts[rank] += n;
+        auto & sendbuf = sendbufs[rank];
+        sendbuf.emplace_back(global_id);
+        sendbuf.emplace_back(owner.rank);
+        sendbuf.emplace_back(owner.local_id);
+        sendbuf.emplace_back(owner.ghost_ranks.size());
+        sendbuf.insert(
+          sendbuf.end(), owner.ghost_ranks.begin(), owner.ghost_ranks.end());
       }
     }
   } // vert
 
-  // send counts
-  ret = MPI_Alltoall(sendcounts.data(), 1, mpi_size_t, recvcounts.data(), 1,
-    mpi_size_t, MPI_COMM_WORLD);
-  if(ret != MPI_SUCCESS)
-    clog_error("Error communicating vertex counts");
-
-  // how much info will we be receiving
-  recvdispls[0] = 0;
-  for(size_t r = 0; r < comm_size; ++r)
-    recvdispls[r + 1] = recvdispls[r] + recvcounts[r];
-
-  recvbuf.clear();
-  recvbuf.resize(recvdispls[comm_size]);
-
   // now send the actual vertex info
-  ret = alltoallv(sendbuf, sendcounts, senddispls, recvbuf, recvcounts,
-    recvdispls, MPI_COMM_WORLD);
+  ret = sparse_alltoallv(sendbufs, recvbufs, MPI_COMM_WORLD);
   if(ret != MPI_SUCCESS)
     clog_error("Error communicating vertices");
 
   // upack results
-  for(size_t r = 0; r < comm_size; ++r) {
-    for(size_t i = recvdispls[r]; i < recvdispls[r + 1];) {
+  for(const auto & recv_pair : recvbufs) {
+    const auto & recvbuf = recv_pair.second;
+    for(size_t i = 0; i < recvbuf.size();) {
       auto global_id = recvbuf[i];
       i++;
       auto rank = recvbuf[i];
@@ -1630,36 +1469,11 @@ match_ids(
     return res.first;
   };
 
-  // first count for storage
-  std::vector<size_t> sendcounts(comm_size, 0);
-  std::vector<size_t> senddispls(comm_size + 1);
+  std::map<size_t, std::vector<size_t>> sendbufs;
 
   // storage for global ids
   std::vector<size_t> global_vs;
 
-  for(const auto & vs : entities2vertex) {
-    // convert to global ids
-    global_vs.clear();
-    global_vs.reserve(vs.size());
-    for(auto v : vs)
-      global_vs.emplace_back(vertex_local2global.at(v));
-    // get the rank owner
-    auto it = std::min_element(global_vs.begin(), global_vs.end());
-    auto r = rank_owner(vert_dist, *it);
-    // we will be sending the number of vertices, plus the vertices
-    if(r != comm_rank)
-      sendcounts[r] += 1 + vs.size();
-  }
-
-  // finish displacements
-  senddispls[0] = 0;
-  for(size_t r = 0; r < comm_size; ++r)
-    senddispls[r + 1] = senddispls[r] + sendcounts[r];
-
-  // now fill buffers
-  std::vector<size_t> sendbuf(senddispls[comm_size]);
-  std::fill(sendcounts.begin(), sendcounts.end(), 0);
-
   for(const auto & vs : entities2vertex) {
     // convert to global ids
     global_vs.clear();
@@ -1671,13 +1485,9 @@ match_ids(
     auto r = rank_owner(vert_dist, *it);
     // we will be sending the number of vertices, plus the vertices
     if(r != comm_rank) {
-      // first the id and size
-      auto j = senddispls[r] + sendcounts[r];
-      sendbuf[j++] = vs.size();
-      for(auto v : global_vs)
-        sendbuf[j++] = v;
-      // increment send counter
-      sendcounts[r] = j - senddispls[r];
+      auto & sendbuf = sendbufs[r];
+      sendbuf.emplace_back(vs.size());
+      sendbuf.insert(sendbuf.end(), global_vs.begin(), global_vs.end());
     }
     // otherwise, if its mine, add it
     else {
@@ -1689,23 +1499,9 @@ match_ids(
   // Send information
   //----------------------------------------------------------------------------
 
-  // send the counts
-  std::vector<size_t> recvcounts(comm_size);
-  auto ret = MPI_Alltoall(sendcounts.data(), 1, mpi_size_t, recvcounts.data(),
-    1, mpi_size_t, MPI_COMM_WORLD);
-  if(ret != MPI_SUCCESS)
-    clog_error("Error communicating vertex counts");
-
-  // how much info will we be receiving
-  std::vector<size_t> recvdispls(comm_size + 1);
-  recvdispls[0] = 0;
-  for(size_t r = 0; r < comm_size; ++r)
-    recvdispls[r + 1] = recvdispls[r] + recvcounts[r];
-  std::vector<size_t> recvbuf(recvdispls[comm_size]);
-
   // now send the actual vertex info
-  ret = alltoallv(sendbuf, sendcounts, senddispls, recvbuf, recvcounts,
-    recvdispls, MPI_COMM_WORLD);
+  std::map<size_t, std::vector<size_t>> recvbufs;
+  auto ret = sparse_alltoallv(sendbufs, recvbufs, MPI_COMM_WORLD);
   if(ret != MPI_SUCCESS)
     clog_error("Error communicating vertices");
 
@@ -1718,9 +1514,10 @@ match_ids(
   // keep track of who needs what
   std::map<size_t, std::vector<pointer_t>> rank_edges;
 
-  for(size_t r = 0; r < comm_size; ++r) {
-    auto & rank_data = rank_edges[r];
-    for(size_t i = recvdispls[r]; i < recvdispls[r + 1];) {
+  for(const auto & recv_pair : recvbufs) {
+    const auto & recvbuf = recv_pair.second;
+    auto & rank_data = rank_edges[recv_pair.first];
+    for(size_t i = 0; i < recvbuf.size();) {
       auto n = recvbuf[i];
       const auto vs = utils::span(&recvbuf[i + 1], n);
       auto it = add_to_map(vs, entities, entities.size());
@@ -1758,19 +1555,14 @@ match_ids(
   // Send back the finished edges to those that sent you the pairs
   //----------------------------------------------------------------------------
 
-  // counts for storage
-  std::fill(sendcounts.begin(), sendcounts.end(), 0);
-  // and fill buffers
-  sendbuf.clear();
+  sendbufs.clear();
 
-  for(size_t r = 0; r < comm_size; ++r) {
-    if(r == comm_rank)
-      continue;
+  for(const auto & rank_pair : rank_edges) {
+    auto & sendbuf = sendbufs[rank_pair.first];
     // we will be sending the edge id, number of vertices, plus the vertices
-    for(auto edge : rank_edges.at(r)) {
+    for(auto edge : rank_pair.second) {
       auto global_id = edge->second;
       auto n = edge->first.size();
-      sendcounts[r] += 2 + n;
       sendbuf.emplace_back(global_id);
       sendbuf.emplace_back(n);
       for(auto v : edge->first)
@@ -1778,31 +1570,12 @@ match_ids(
     }
   }
 
-  // finish displacements
-  senddispls[0] = 0;
-  for(size_t r = 0; r < comm_size; ++r)
-    senddispls[r + 1] = senddispls[r] + sendcounts[r];
-
   //----------------------------------------------------------------------------
   // Send information
   //----------------------------------------------------------------------------
 
-  // send the counts
-  ret = MPI_Alltoall(sendcounts.data(), 1, mpi_size_t, recvcounts.data(), 1,
-    mpi_size_t, MPI_COMM_WORLD);
-  if(ret != MPI_SUCCESS)
-    clog_error("Error communicating vertex counts");
-
-  // how much info will we be receiving
-  recvdispls[0] = 0;
-  for(size_t r = 0; r < comm_size; ++r)
-    recvdispls[r + 1] = recvdispls[r] + recvcounts[r];
-  recvbuf.clear();
-  recvbuf.resize(recvdispls[comm_size]);
-
   // now send the actual vertex info
-  ret = alltoallv(sendbuf, sendcounts, senddispls, recvbuf, recvcounts,
-    recvdispls, MPI_COMM_WORLD);
+  ret = sparse_alltoallv(sendbufs, recvbufs, MPI_COMM_WORLD);
   if(ret != MPI_SUCCESS)
     clog_error("Error communicating vertices");
 
@@ -1810,8 +1583,9 @@ match_ids(
   // Unpack results
   //----------------------------------------------------------------------------
 
-  for(size_t r = 0; r < comm_size; ++r) {
-    for(size_t i = recvdispls[r]; i < recvdispls[r + 1];) {
+  for(const auto & recv_pair : recvbufs) {
+    const auto & recvbuf = recv_pair.second;
+    for(size_t i = 0; i < recvbuf.size();) {
       auto global_id = recvbuf[i];
       auto n = recvbuf[i + 1];
       const auto vs = utils::span(&recvbuf[i + 2], n);
@@ -1855,39 +1629,11 @@ ghost_connectivity(const flecsi::coloring::crs_t & from2to,
   MPI_Comm_size(MPI_COMM_WORLD, &comm_size);
   MPI_Comm_rank(MPI_COMM_WORLD, &comm_rank);
 
-  // the mpi data type for size_t
-  const auto mpi_size_t = utils::mpi_typetraits_u<size_t>::type();
-
   //----------------------------------------------------------------------------
   // Determine cell-to-vertex connecitivity for my shared cells
   //----------------------------------------------------------------------------
 
-  // first count for storage
-  std::vector<size_t> sendcounts(comm_size, 0);
-  std::vector<size_t> senddispls(comm_size + 1);
-
-  for(const auto & e : from_entities.shared) {
-    // get cell info
-    auto start = from2to.offsets[e.offset];
-    auto end = from2to.offsets[e.offset + 1];
-    auto n = end - start;
-    // loop over shared ranks
-    for(auto r : e.shared) {
-      // we will be sending the cell global id, number of vertices, plus
-      // vertices
-      if(r != comm_rank)
-        sendcounts[r] += 2 + n;
-    }
-  }
-
-  // finish displacements
-  senddispls[0] = 0;
-  for(size_t r = 0; r < comm_size; ++r)
-    senddispls[r + 1] = senddispls[r] + sendcounts[r];
-
-  // now fill buffers
-  std::vector<size_t> sendbuf(senddispls[comm_size]);
-  std::fill(sendcounts.begin(), sendcounts.end(), 0);
+  std::map<size_t, std::vector<size_t>> sendbufs;
 
   for(const auto & e : from_entities.shared) {
     // get cell info
@@ -1898,17 +1644,14 @@ ghost_connectivity(const flecsi::coloring::crs_t & from2to,
     for(auto r : e.shared) {
       // we will be sending global id, number of vertices, plus vertices
       if(r != comm_rank) {
-        // first the id and size
-        auto j = senddispls[r] + sendcounts[r];
-        sendbuf[j++] = e.id;
-        sendbuf[j++] = n;
+        auto & sendbuf = sendbufs[r];
+        sendbuf.emplace_back(e.id);
+        sendbuf.emplace_back(n);
         for(auto i = start; i < end; ++i) {
           auto local_id = from2to.indices[i];
           auto global_id = local2global[local_id];
-          sendbuf[j++] = global_id;
+          sendbuf.emplace_back(global_id);
         }
-        // increment send counter
-        sendcounts[r] = j - senddispls[r];
       }
     } // shared ranks
   }
@@ -1917,23 +1660,9 @@ ghost_connectivity(const flecsi::coloring::crs_t & from2to,
   // Send shared information
   //----------------------------------------------------------------------------
 
-  // send the counts
-  std::vector<size_t> recvcounts(comm_size);
-  auto ret = MPI_Alltoall(sendcounts.data(), 1, mpi_size_t, recvcounts.data(),
-    1, mpi_size_t, MPI_COMM_WORLD);
-  if(ret != MPI_SUCCESS)
-    clog_error("Error communicating vertex counts");
-
-  // how much info will we be receiving
-  std::vector<size_t> recvdispls(comm_size + 1);
-  recvdispls[0] = 0;
-  for(size_t r = 0; r < comm_size; ++r)
-    recvdispls[r + 1] = recvdispls[r] + recvcounts[r];
-  std::vector<size_t> recvbuf(recvdispls[comm_size]);
-
   // now send the actual vertex info
-  ret = alltoallv(sendbuf, sendcounts, senddispls, recvbuf, recvcounts,
-    recvdispls, MPI_COMM_WORLD);
+  std::map<size_t, std::vector<size_t>> recvbufs;
+  auto ret = sparse_alltoallv(sendbufs, recvbufs, MPI_COMM_WORLD);
   if(ret != MPI_SUCCESS)
     clog_error("Error communicating vertices");
 
@@ -1945,8 +1674,9 @@ ghost_connectivity(const flecsi::coloring::crs_t & from2to,
   connectivity.offsets.emplace_back(0);
   from_ids.clear();
 
-  for(size_t r = 0; r < comm_size; ++r) {
-    for(size_t i = recvdispls[r]; i < recvdispls[r + 1];) {
+  for(const auto & recv_pair : recvbufs) {
+    const auto & recvbuf = recv_pair.second;
+    for(size_t i = 0; i < recvbuf.size();) {
       // global id
       auto global_id = recvbuf[i];
       from_ids.emplace_back(global_id);
@@ -1955,7 +1685,7 @@ ghost_connectivity(const flecsi::coloring::crs_t & from2to,
       auto n = recvbuf[i];
       i++;
       // no sift through ghost vertices
-      for(auto j = 0; j < n; ++j, ++i) {
+      for(size_t j = 0; j < n; ++j, ++i) {
         // local and global ids of the vertex (relative to sender)
         auto ent_global_id = recvbuf[i];
         // Don't bother checking if i have this vertex yet, even if I already
@@ -21,6 +21,13 @@
 #error FLECSI_ENABLE_MPI not defined! This file depends on MPI!
 #endif
 
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
 #include <mpi.h>
 
 #include <flecsi/coloring/communicator.h>
@@ -49,7 +56,12 @@ public:
   mpi_communicator_t & operator=(const mpi_communicator_t &) = delete;
 
   /// Destructor
-  ~mpi_communicator_t() {}
+  ~mpi_communicator_t() {
+    int finalized;
+    MPI_Finalized(&finalized);
+    if(exchange_comm_ != MPI_COMM_NULL && !finalized)
+      MPI_Comm_free(&exchange_comm_);
+  }
 
   /*!
    Return the size of the communicatora
@@ -81,59 +93,22 @@ public:
     auto ret = MPI_Barrier(MPI_COMM_WORLD);
   };
 
-  /*!
-   Reduces info_indices from all MPI ranks
-
-   @param request_indices  std::set of shared, ghost etc
-   @param max_request_indices Maximum # of indices per rank
-   @param colors Number of MPI ranks
-
-   @return std::vector vith the infirmation for the info_indices from all
-           MPI ranks
-
-   @ingroup coloring
-   */
-
-  std::vector<size_t> get_info_indices(const std::set<size_t> & request_indices,
-    size_t max_request_indices,
-    int colors) {
-    // Pad the request indices with size_t max. We will then set
-    // the indices of the actual request. Each rank that receives
-    // the request will try to provide information about the
-    // non size_t max values in the request. The others will
-    // be ignored.
-    std::vector<size_t> input_indices(
-      colors * max_request_indices, std::numeric_limits<size_t>::max());
-    std::vector<size_t> info_indices(colors * max_request_indices);
-
-    for(size_t c(0); c < colors; ++c) {
-      size_t off(0);
-      const size_t coff = c * max_request_indices;
-
-      for(auto s : request_indices) {
-        input_indices[coff + off++] = s;
-      } // for
-    } // for
-
-    const auto mpi_size_t_type =
-      flecsi::utils::mpi_typetraits_u<size_t>::type();
-
-    // Send the request indices to all other ranks.
-    int result =
-      MPI_Alltoall(&input_indices[0], max_request_indices, mpi_size_t_type,
-        &info_indices[0], max_request_indices, mpi_size_t_type, MPI_COMM_WORLD);
-
-    return info_indices;
-  } // get_info_indices
-
   /*!
    Rerturn a set containing the entity_info_t information for each
    member of the input set request_indices (from other ranks) and
    the information for the local indices in primary.
 
-   @param FIXME
+   The owner of every requested index is found through a distributed
+   directory: every index is registered with, and looked up on, the rank
+   given by directory(), so that every rank only communicates with the
+   ranks that hold its part of the directory.
+
+   @param primary         The indices owned by this rank.
+   @param request_indices The indices for which to return information.
 
-   @return FIXME
+   @return The ranks that requested each primary index (indexed by offset
+           in primary), and the owner and offset of the requested indices
+           that are owned by other ranks.
 
    @ingroup coloring
   */
@@ -141,109 +116,115 @@ public:
   std::pair<std::vector<std::set<size_t>>, std::set<entity_info_t>>
   get_primary_info(const std::set<size_t> & primary,
     const std::set<size_t> & request_indices) override {
-    auto colors = size();
-    auto color = rank();
+    const size_t colors = size();
+    const size_t color = rank();
+
+    // Send the primary indices, with their offsets, and the requested
+    // indices to the directory: [number of primary indices, (index,
+    // offset)..., requested index...].
+    std::map<size_t, std::vector<size_t>> registrations;
+    size_t offset(0);
+    for(auto i : primary) {
+      auto & buffer = registrations[directory(i, colors)];
+      buffer.push_back(i);
+      buffer.push_back(offset++);
+    } // for
 
-    // Store the request in a vector for indexed access below.
-    std::vector<size_t> request_indices_vector(
-      request_indices.begin(), request_indices.end());
+    std::map<size_t, std::vector<size_t>> queries;
+    for(auto i : request_indices) {
+      queries[directory(i, colors)].push_back(i);
+    } // for
 
-    const auto mpi_size_t_type =
-      flecsi::utils::mpi_typetraits_u<size_t>::type();
+    std::map<size_t, std::vector<size_t>> sends;
+    for(const auto & r : registrations) {
+      auto & buffer = sends[r.first];
+      buffer.push_back(r.second.size() / 2);
+      buffer.insert(buffer.end(), r.second.begin(), r.second.end());
+    } // for
+    for(const auto & q : queries) {
+      auto & buffer = sends[q.first];
+      if(buffer.empty())
+        buffer.push_back(0);
+      buffer.insert(buffer.end(), q.second.begin(), q.second.end());
+    } // for
 
-    size_t max_request_indices = get_max_request_size(request_indices.size());
-
-    // Pad the request indices with size_t max. We will then set
-    // the indices of the actual request. Each rank that receives
-    // the request will try to provide information about the
-    // non size_t max values in the request. The others will
-    // be ignored.
-    std::vector<size_t> input_indices(
-      colors * max_request_indices, std::numeric_limits<size_t>::max());
-    std::vector<size_t> info_indices(colors * max_request_indices);
-    info_indices =
-      get_info_indices(request_indices, max_request_indices, colors);
-
-    // For now, we need two arrays for each all-to-all communication:
-    // One for rank ownership of the request indices, and one
-    // for the offsets. We could probably combine these. However,
-    // we would probably have to define a custom MPI type. It
-    // will only be worth the effort if this appraoch is slow.
-    // The input offsets do not need to be initialized because
-    // the information is available in the input_indices array.
-    std::vector<size_t> input_offsets(colors * max_request_indices);
-    std::vector<size_t> info_offsets(colors * max_request_indices);
-
-    // Reset input indices to use to send back information
-    std::fill(input_indices.begin(), input_indices.end(),
-      std::numeric_limits<size_t>::max());
-
-    // For the primary coloring, provide rank and entity information
-    // on indices that are shared with other processes.
-    std::vector<std::set<size_t>> local(primary.size());
+    const auto received = exchange(sends);
 
-    // See if we can fill any requests...
-    for(size_t r(0); r < colors; ++r) {
+    // Fill the directory first, since every rank may query any index.
+    std::unordered_map<size_t, std::pair<size_t, size_t>> owners;
+    for(const auto & r : received) {
+      const size_t * buffer = r.second.data();
+      const size_t n = buffer[0];
+      for(size_t i(0); i < n; ++i) {
+        owners[buffer[1 + 2 * i]] = {r.first, buffer[2 + 2 * i]};
+      } // for
+    } // for
 
-      // Ignore our rank
-      if(r == color) {
+    // Answer the queries with (owner, offset), in order, or with size_t
+    // max if the index is not owned by any rank. Owners are notified of
+    // who requested their indices with (offset, rank) pairs, which follow
+    // the answers.
+    constexpr size_t none = std::numeric_limits<size_t>::max();
+    std::map<size_t, std::vector<size_t>> answers;
+    std::map<size_t, std::vector<size_t>> notices;
+    for(const auto & r : received) {
+      const size_t * buffer = r.second.data();
+      const size_t skip = 1 + 2 * buffer[0];
+      if(skip == r.second.size())
         continue;
-      } // if
 
-      // These array slices are just for convenience.
-      size_t * info = &info_indices[r * max_request_indices];
-      size_t * offset = &input_offsets[r * max_request_indices];
-      size_t * input = &input_indices[r * max_request_indices];
+      auto & answer = answers[r.first];
+      for(size_t i(skip); i < r.second.size(); ++i) {
+        auto match = owners.find(buffer[i]);
 
-      // See which requests we can fulfill.
-      for(size_t i(0); i < max_request_indices; ++i) {
-
-        auto match = primary.find(info[i]);
+        if(match == owners.end()) {
+          answer.push_back(none);
+          answer.push_back(0);
+          continue;
+        } // if
 
-        if(match != primary.end()) {
-          // This is a match, i.e., we own this entity, so we can
-          // set the rank (ownership) and offset.
-          input[i] = color;
-          offset[i] = std::distance(primary.begin(), match);
+        answer.push_back(match->second.first);
+        answer.push_back(match->second.second);
 
-          // We also need to register that this index is shared
-          // with other ranks
-          local[offset[i]].insert(r);
+        if(match->second.first != r.first) {
+          auto & notice = notices[match->second.first];
+          notice.push_back(match->second.second);
+          notice.push_back(r.first);
         } // if
       } // for
     } // for
 
-    // Send the indices information back to all ranks.
-    int result =
-      MPI_Alltoall(&input_indices[0], max_request_indices, mpi_size_t_type,
-        &info_indices[0], max_request_indices, mpi_size_t_type, MPI_COMM_WORLD);
+    for(auto & n : notices) {
+      auto & answer = answers[n.first];
+      answer.insert(answer.end(), n.second.begin(), n.second.end());
+    } // for
 
-    // Send the offsets information back to all ranks.
-    result =
-      MPI_Alltoall(&input_offsets[0], max_request_indices, mpi_size_t_type,
-        &info_offsets[0], max_request_indices, mpi_size_t_type, MPI_COMM_WORLD);
+    const auto replies = exchange(answers);
 
+    std::vector<std::set<size_t>> local(primary.size());
     std::set<entity_info_t> remote;
 
-    // Collect all of the information for the remote entities.
-    for(size_t r(0); r < colors; ++r) {
-      // Skip these (we already know them!)
-      if(r == color) {
-        continue;
+    for(const auto & r : replies) {
+      const size_t * buffer = r.second.data();
+      size_t i(0);
+
+      // The answers to our queries, if we sent any.
+      auto q = queries.find(r.first);
+      if(q != queries.end()) {
+        for(auto index : q->second) {
+          const size_t owner = buffer[i++];
+          const size_t owner_offset = buffer[i++];
+
+          // Skip indices that we own, or that nobody owns.
+          if(owner != none && owner != color) {
+            remote.insert(entity_info_t(index, owner, owner_offset, {}));
+          } // if
+        } // for
       } // if
 
-      // Another slice for convenience.
-      size_t * ranks = &info_indices[r * max_request_indices];
-      size_t * offsets = &info_offsets[r * max_request_indices];
-
-      for(size_t i(0); i < max_request_indices; ++i) {
-
-        if(ranks[i] != std::numeric_limits<size_t>::max()) {
-          // If this is not size_t max, this rank answered our request
-          // and we can set the information.
-          remote.insert(
-            entity_info_t(request_indices_vector[i], ranks[i], offsets[i], {}));
-        } // if
+      // The ranks that requested our indices.
+      for(; i < r.second.size(); i += 2) {
+        local[buffer[i]].insert(buffer[i + 1]);
       } // for
     } // for
 
@@ -251,91 +232,74 @@ public:
   } // get_primary_info
 
   /*!
-   Rerturn FIXME
+   Return the indices that this rank requests together with each other
+   rank. The requests are matched through the same distributed directory
+   as in get_primary_info().
 
-   @param request_indices FIXME...
-                          information.
-   @return A std::unordered_map<size_t, std::set<size_t>> FIXME ...
+   @param request_indices The indices requested by this rank.
+
+   @return A std::unordered_map<size_t, std::set<size_t>> containing, for
+           every other rank with a non-empty intersection, the indices that
+           are requested by both ranks.
 
    @ingroup coloring
   */
 
   std::unordered_map<size_t, std::set<size_t>> get_intersection_info(
     const std::set<size_t> & request_indices) override {
-    auto colors = size();
-    auto color = rank();
+    const size_t colors = size();
 
-    // Store the request in a vector for indexed access below.
-    std::vector<size_t> request_indices_vector(
-      request_indices.begin(), request_indices.end());
-
-    const auto mpi_size_t_type =
-      flecsi::utils::mpi_typetraits_u<size_t>::type();
+    std::map<size_t, std::vector<size_t>> queries;
+    for(auto i : request_indices) {
+      queries[directory(i, colors)].push_back(i);
+    } // for
 
-    size_t max_request_indices = get_max_request_size(request_indices.size());
+    const auto received = exchange(queries);
 
-    // Pad the request indices with size_t max. We will then set
-    // the indices of the actual request. Each rank that receives
-    // the request will try to provide information about the
-    // non size_t max values in the request. The others will
-    // be ignored.
-    std::vector<size_t> input_indices(
-      colors * max_request_indices, std::numeric_limits<size_t>::max());
-    std::vector<size_t> info_indices(colors * max_request_indices);
-    info_indices =
-      get_info_indices(request_indices, max_request_indices, colors);
+    // Every (index, rank) request held by this part of the directory,
+    // sorted by index.
+    std::vector<std::pair<size_t, size_t>> requests;
+    for(const auto & r : received) {
+      for(auto i : r.second) {
+        requests.emplace_back(i, r.first);
+      } // for
+    } // for
+    std::sort(requests.begin(), requests.end());
+
+    // Tell every rank the other ranks that request the same indices, with
+    // (rank, index) pairs.
+    std::map<size_t, std::vector<size_t>> answers;
+    for(size_t b(0), e(0); b < requests.size(); b = e) {
+      for(e = b + 1;
+          e < requests.size() && requests[e].first == requests[b].first; ++e)
+        ;
+      for(size_t i(b); i < e; ++i) {
+        for(size_t j(b); j < e; ++j) {
+          if(i != j) {
+            auto & answer = answers[requests[i].second];
+            answer.push_back(requests[j].second);
+            answer.push_back(requests[b].first);
+          } // if
+        } // for
+      } // for
+    } // for
 
-    // Reset input indices to use to send back information
-    std::fill(input_indices.begin(), input_indices.end(),
-      std::numeric_limits<size_t>::max());
+    const auto replies = exchange(answers);
 
-    {
-      clog_tag_guard(mpi_communicator);
-      clog_container_one(info, "input_indices", info_indices, clog::space);
-    }
-
-    //
     std::unordered_map<size_t, std::set<size_t>> intersection_map;
-
-    for(size_t r(0); r < colors; ++r) {
-
-      // Ignore our rank
-      if(r == color) {
-        continue;
-      } // if
-
-      // Array slice for convenience.
-      size_t * info = &info_indices[r * max_request_indices];
-
-      // Create a set of the off-color request indices.
-      std::set<size_t> intersection_set;
-      for(size_t i(0); i < max_request_indices; ++i) {
-        if(info[i] != std::numeric_limits<size_t>::max()) {
-          intersection_set.insert(info[i]);
-        } // if
+    for(const auto & r : replies) {
+      for(size_t i(0); i < r.second.size(); i += 2) {
+        intersection_map[r.second[i]].insert(r.second[i + 1]);
       } // for
+    } // for
 
-      {
-        clog_tag_guard(mpi_communicator);
-        clog_container_one(
-          info, "intersection_set", intersection_set, clog::space);
-      }
-
-      // Compute the intersection
-      auto intersection =
-        flecsi::utils::set_intersection(intersection_set, request_indices);
-
-      {
-        clog_tag_guard(mpi_communicator);
+    {
+      clog_tag_guard(mpi_communicator);
+      for(const auto & i : intersection_map) {
         clog_container_one(
-          info, "rank " << r << " intersection", intersection, clog::space);
-      }
-
-      // If the intersection is non-empty, add it to the return map
-      if(intersection.size()) {
-        intersection_map[r] = intersection;
-      } // if
-    } // for
+          info, "rank " << i.first << " intersection", i.second, clog::space);
+      } // for
+    }
 
     return intersection_map;
   } // get_intersection_info
@@ -353,30 +317,16 @@ public:
 
   std::unordered_map<size_t, std::set<size_t>> get_entity_reduction(
     const std::set<size_t> & local_indices) override {
-    auto colors = size();
-    auto color = rank();
-
-    size_t max_request_indices = get_max_request_size(local_indices.size());
+    const size_t colors = size();
 
-    auto info_indices =
-      get_info_indices(local_indices, max_request_indices, colors);
+    std::vector<int> displs;
+    const auto indices = allgather(local_indices, displs);
 
     std::unordered_map<size_t, std::set<size_t>> entity_reduction_map;
 
     for(size_t c(0); c < colors; ++c) {
-
-      // Array slice for convenience.
-      size_t * info = &info_indices[c * max_request_indices];
-
-      // Create a set of the off-color request indices.
-      std::set<size_t> reduction_set;
-      for(size_t i(0); i < max_request_indices; ++i) {
-        if(info[i] != std::numeric_limits<size_t>::max()) {
-          reduction_set.insert(info[i]);
-        } // if
-      } // for
-
-      entity_reduction_map[c] = reduction_set;
+      entity_reduction_map[c] = std::set<size_t>(
+        indices.begin() + displs[c], indices.begin() + displs[c + 1]);
     } // for
 
     return entity_reduction_map;
@@ -386,9 +336,9 @@ public:
    Return a set containing the entity_info_t information for each
    member of the input set request_indices (from other ranks).
 
-   @param entity_info FIXME...
-   @param request_indices A set of entity ids for which to return
-                          information.
+   @param entity_info The information of the entities of this rank.
+   @param request_indices The entity ids for which to return information,
+                          by owner rank.
    @return A std::vector<std::set<size_t>> containing the offset
            information for the requested indices.
 
@@ -398,45 +348,18 @@ public:
   std::vector<std::set<size_t>> get_entity_info(
     const std::set<entity_info_t> & entity_info,
     const std::vector<std::set<size_t>> & request_indices) override {
-    auto colors = size();
-    auto color = rank();
+    const size_t colors = size();
 
-    // Collect the size of each rank request to send.
-    std::vector<size_t> send_cnts(colors, 0);
-    for(size_t r(0); r < colors; ++r) {
-      send_cnts[r] = request_indices[r].size();
-    } // for
-
-    // Send the request size (in indices) to each rank.
-    std::vector<size_t> recv_cnts(colors);
-    int result = MPI_Alltoall(&send_cnts[0], 1,
-      utils::mpi_typetraits_u<size_t>::type(), &recv_cnts[0], 1,
-      utils::mpi_typetraits_u<size_t>::type(), MPI_COMM_WORLD);
-
-    // Start receive operations (non-blocking).
-    std::vector<std::vector<size_t>> rbuffers(colors);
-    std::vector<MPI_Request> requests;
+    // Send the requests to the owners only.
+    std::map<size_t, std::vector<size_t>> requests;
     for(size_t r(0); r < colors; ++r) {
-      if(recv_cnts[r]) {
-        rbuffers[r].resize(recv_cnts[r]);
-        requests.push_back({});
-        MPI_Irecv(&rbuffers[r][0], recv_cnts[r],
-          utils::mpi_typetraits_u<size_t>::type(), r, 0, MPI_COMM_WORLD,
-          &requests[requests.size() - 1]);
+      if(!request_indices[r].empty()) {
+        requests[r].assign(
+          request_indices[r].begin(), request_indices[r].end());
       } // if
     } // for
 
-    // Start send operations (blocking is ok here).
-    std::vector<std::vector<size_t>> sbuffers(colors);
-    for(size_t r(0); r < colors; ++r) {
-      if(send_cnts[r]) {
-        std::copy(request_indices[r].begin(), request_indices[r].end(),
-          std::back_inserter(sbuffers[r]));
-
-        MPI_Send(&sbuffers[r][0], send_cnts[r],
-          utils::mpi_typetraits_u<size_t>::type(), r, 0, MPI_COMM_WORLD);
-      } // if
-    } // for
+    const auto received = exchange(requests);
 
     // Create a map version of the entity info for lookups below.
     std::unordered_map<size_t, entity_info_t> entity_info_map;
@@ -444,56 +367,21 @@ public:
       entity_info_map[i.id] = i;
     } // for
 
-    // Wait on the receive operations
-    std::vector<MPI_Status> status(requests.size());
-    MPI_Waitall(requests.size(), &requests[0], &status[0]);
-
-    // Set the offsets for each requested index in the send buffer.
-    for(size_t r(0); r < colors; ++r) {
-      sbuffers[r].resize(rbuffers[r].size());
-
-      size_t offset(0);
-      for(auto i : rbuffers[r]) {
-        sbuffers[r][offset++] = entity_info_map[i].offset;
+    // Answer with the offset of each requested index, in order.
+    std::map<size_t, std::vector<size_t>> answers;
+    for(const auto & r : received) {
+      auto & answer = answers[r.first];
+      answer.reserve(r.second.size());
+      for(auto i : r.second) {
+        answer.push_back(entity_info_map[i].offset);
       } // for
     } // for
 
-    // we are reusing requests in the following code, need to clear the content
-    // first.
-    requests.clear();
-
-    // Start receive operations (non-blocking) to get back the
-    // offsets we requested.
-    for(size_t r(0); r < colors; ++r) {
-      // If we sent a request, prepare to receive an answer.
-      if(send_cnts[r]) {
-        // We're done with our receive buffers, so we can re-use them.
-        rbuffers[r].resize(send_cnts[r], 0);
-        requests.push_back({});
-        MPI_Irecv(&rbuffers[r][0], send_cnts[r],
-          utils::mpi_typetraits_u<size_t>::type(), r, 0, MPI_COMM_WORLD,
-          &requests[requests.size() - 1]);
-      } // if
-    } // for
-
-    // Start send operations (blocking is probably ok here).
-    for(size_t r(0); r < colors; ++r) {
-      // If we received a request, prepare to send an answer.
-      if(recv_cnts[r]) {
-        MPI_Send(&sbuffers[r][0], recv_cnts[r],
-          utils::mpi_typetraits_u<size_t>::type(), r, 0, MPI_COMM_WORLD);
-      } // if
-    } // for
-
-    // Wait on the receive operations
-    status.resize(requests.size());
-    MPI_Waitall(requests.size(), &requests[0], &status[0]);
+    const auto replies = exchange(answers);
 
     std::vector<std::set<size_t>> remote(colors);
-    for(size_t r(0); r < colors; ++r) {
-      for(size_t i(0); i < send_cnts[r]; ++i) {
-        remote[r].insert(rbuffers[r][i]);
-      } // for
+    for(const auto & r : replies) {
+      remote[r.first].insert(r.second.begin(), r.second.end());
     } // for
 
     return remote;
@@ -539,32 +427,16 @@ public:
   template<typename Lambda>
   void alltoall_coloring_info(std::set<size_t> & request_indices,
     Lambda && function) {
-    auto colors = size();
-    auto color = rank();
-
-    size_t max_request_indices = get_max_request_size(request_indices.size());
+    const size_t colors = size();
 
-    // Pad the request indices with size_t max. We will then set
-    // the indices of the actual request. Each rank that receives
-    // the request will try to provide information about the
-    // non size_t max values in the request. The others will
-    // be ignored.
-    std::vector<size_t> info_indices(colors * max_request_indices);
-    info_indices =
-      get_info_indices(request_indices, max_request_indices, colors);
+    std::vector<int> displs;
+    const auto indices = allgather(request_indices, displs);
 
     for(size_t c(0); c < colors; ++c) {
-
-      size_t * info = &info_indices[c * max_request_indices];
-
-      for(size_t i(0); i < max_request_indices; ++i) {
-        if(info[i] != std::numeric_limits<size_t>::max()) {
-          const size_t value = info[i];
-          function(c, value);
-        } // if
+      for(int i(displs[c]); i < displs[c + 1]; ++i) {
+        function(c, indices[i]);
       } // for
     } // for
-
   } // alltoall_coloring_info
 
   /*!
@@ -614,33 +486,132 @@ public:
     return coloring_info;
   } // gather_coloring_info
 
+private:
   /*!
-   Find maximum size for the "requested_indicies" - MPI reduction
+   Return the rank that holds the directory entry of an index.
+   */
 
-   @param request_indices request_indices for local MPI rank
+  static size_t directory(size_t index, size_t colors) {
+    return index % colors;
+  } // directory
 
-   @return max_request_indices Maximum size for the "requested_indicies"
+  /*!
+   Return the communicator of the sparse exchanges, a duplicate of
+   MPI_COMM_WORLD so that probing for their messages does not match any
+   other message.
+   */
 
-   @ingroup coloring
+  MPI_Comm exchange_comm() {
+    if(exchange_comm_ == MPI_COMM_NULL)
+      MPI_Comm_dup(MPI_COMM_WORLD, &exchange_comm_);
+    return exchange_comm_;
+  } // exchange_comm
+
+  /*!
+   Send buffers of indices to some of the ranks, and receive the buffers
+   that the other ranks send to this rank. No rank communicates with the
+   ranks that it has nothing to exchange with: the buffers are sent
+   synchronously, received as they are probed, and the exchange ends with a
+   nonblocking barrier that every rank enters once its sends have been
+   received (nonblocking consensus).
+
+   @param send The buffers to send, by rank. Empty buffers are not sent.
+
+   @return The buffers received, by rank.
    */
 
-  size_t get_max_request_size(size_t request_indices) {
-    size_t max_request_indices = 0;
+  std::map<size_t, std::vector<size_t>> exchange(
+    const std::map<size_t, std::vector<size_t>> & send) {
+    const auto mpi_size_t_type =
+      flecsi::utils::mpi_typetraits_u<size_t>::type();
+    MPI_Comm comm = exchange_comm();
 
-    // Get a valid MPI type for size_t.
+    // Consecutive exchanges alternate tags, so that the messages of a rank
+    // that has already started the next exchange are not received by a
+    // rank that is still finishing this one.
+    const int tag = exchanges_++ % 2;
+
+    std::vector<MPI_Request> requests;
+    requests.reserve(send.size());
+    for(const auto & s : send) {
+      if(s.second.empty())
+        continue;
+      requests.emplace_back();
+      MPI_Issend(s.second.data(), s.second.size(), mpi_size_t_type, s.first,
+        tag, comm, &requests.back());
+    } // for
+
+    std::map<size_t, std::vector<size_t>> recv;
+    MPI_Request barrier = MPI_REQUEST_NULL;
+    bool done = false;
+
+    while(!done) {
+      int arrived;
+      MPI_Status status;
+      MPI_Iprobe(MPI_ANY_SOURCE, tag, comm, &arrived, &status);
+
+      if(arrived) {
+        int count;
+        MPI_Get_count(&status, mpi_size_t_type, &count);
+        auto & buffer = recv[status.MPI_SOURCE];
+        buffer.resize(count);
+        MPI_Recv(buffer.data(), count, mpi_size_t_type, status.MPI_SOURCE,
+          tag, comm, MPI_STATUS_IGNORE);
+      } // if
+
+      if(barrier == MPI_REQUEST_NULL) {
+        int sent;
+        MPI_Testall(
+          requests.size(), requests.data(), &sent, MPI_STATUSES_IGNORE);
+        if(sent)
+          MPI_Ibarrier(comm, &barrier);
+      }
+      else {
+        int complete;
+        MPI_Test(&barrier, &complete, MPI_STATUS_IGNORE);
+        done = complete;
+      } // if
+    } // while
+
+    return recv;
+  } // exchange
+
+  /*!
+   Gather the indices of every rank, without padding.
+
+   @param indices The indices of this rank.
+   @param displs  The offset of the indices of each rank in the result,
+                  followed by their total number.
+   */
+
+  std::vector<size_t> allgather(const std::set<size_t> & indices,
+    std::vector<int> & displs) {
+    const size_t colors = size();
     const auto mpi_size_t_type =
       flecsi::utils::mpi_typetraits_u<size_t>::type();
 
-    // This may be inefficient, but this call is doing a reduction
-    // to determine the maximum number of indices requested by any rank
-    // so that we can pad out the all-to-all communication below.
-    int result = MPI_Allreduce(&request_indices, &max_request_indices, 1,
-      mpi_size_t_type, MPI_MAX, MPI_COMM_WORLD);
+    clog_assert(indices.size() < size_t(std::numeric_limits<int>::max()),
+      "too many indices");
+    const int count = indices.size();
+    std::vector<int> counts(colors);
+    MPI_Allgather(
+      &count, 1, MPI_INT, counts.data(), 1, MPI_INT, MPI_COMM_WORLD);
 
-    return max_request_indices;
-  } // get_max_request_size
+    displs.assign(colors + 1, 0);
+    for(size_t c(0); c < colors; ++c) {
+      displs[c + 1] = displs[c] + counts[c];
+    } // for
 
-private:
+    std::vector<size_t> send(indices.begin(), indices.end());
+    std::vector<size_t> recv(displs[colors]);
+    MPI_Allgatherv(send.data(), count, mpi_size_t_type, recv.data(),
+      counts.data(), displs.data(), mpi_size_t_type, MPI_COMM_WORLD);
+
+    return recv;
+  } // allgather
+
+  MPI_Comm exchange_comm_ = MPI_COMM_NULL;
+  size_t exchanges_ = 0;
 }; // class mpi_communicator_t
 
 } // namespace coloring
@@ -7,6 +7,7 @@
 #include <mpi.h>
 
 #include <flecsi/coloring/dcrs_utils.h>
+#include <flecsi/io/parallel_binary_definition.h>
 #include <flecsi/io/simple_definition.h>
 
 const size_t output_rank(0);
@@ -59,6 +60,66 @@ TEST(dcrs, simple2d_16x16) {
 
 } // TEST
 
+TEST(dcrs, parallel_binary_8x8) {
+
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  flecsi::io::simple_definition_t sd("simple2d-8x8.msh");
+  if(rank == 0)
+    flecsi::io::write_binary_definition(sd, "simple2d-8x8.bin");
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  // Every rank reads a block of cells: the graph must be the one of the
+  // serial definition.
+  flecsi::io::parallel_binary_definition_u<2> pd("simple2d-8x8.bin");
+
+  flecsi::coloring::dcrs_t dcrs;
+  pd.create_graph(2, 0, 2, dcrs);
+  auto expected = flecsi::coloring::make_dcrs(sd);
+
+  CINCH_ASSERT(EQ, dcrs.distribution, expected.distribution);
+  CINCH_ASSERT(EQ, dcrs.offsets, expected.offsets);
+  for(size_t c(0); c < dcrs.size(); ++c) {
+    auto row = flecsi::utils::to_vector(dcrs[c]);
+    auto expected_row = flecsi::utils::to_vector(expected[c]);
+    std::sort(expected_row.begin(), expected_row.end());
+    CINCH_ASSERT(EQ, row, expected_row);
+  } // for
+
+  // Deal the cells round-robin and migrate them.
+  std::vector<size_t> partitioning(dcrs.size());
+  for(size_t c(0); c < dcrs.size(); ++c) {
+    partitioning[c] = (dcrs.distribution[rank] + c) % size;
+  } // for
+
+  std::vector<size_t> partition_dist;
+  flecsi::coloring::subdivide(size, size, partition_dist);
+  flecsi::coloring::migrate<2>(2, partitioning, partition_dist, dcrs, pd);
+
+  CINCH_ASSERT(EQ, pd.num_entities(2), dcrs.size());
+
+  const auto & cells = pd.local_to_global(2);
+  const auto & vertices = pd.local_to_global(0);
+  for(size_t c(0); c < pd.num_entities(2); ++c) {
+    CINCH_ASSERT(EQ, cells[c] % size, rank);
+
+    auto local = pd.entities(2, 0, c);
+    auto global = sd.entities(2, 0, cells[c]);
+    CINCH_ASSERT(EQ, local.size(), global.size());
+    for(size_t v(0); v < local.size(); ++v) {
+      CINCH_ASSERT(EQ, vertices[local[v]], global[v]);
+
+      double coords[2];
+      pd.vertex(local[v], coords);
+      CINCH_ASSERT(EQ, coords[0], sd.vertex(global[v])[0]);
+      CINCH_ASSERT(EQ, coords[1], sd.vertex(global[v])[1]);
+    } // for
+  } // for
+
+} // TEST
+
 /*----------------------------------------------------------------------------*
  * Cinch test Macros
  *
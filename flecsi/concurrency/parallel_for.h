@@ -0,0 +1,122 @@
+/*~--------------------------------------------------------------------------~*
+ *~--------------------------------------------------------------------------~*/
+
+#pragma once
+
+//----------------------------------------------------------------------------//
+//! @file
+//----------------------------------------------------------------------------//
+
+#include <algorithm>
+#include <cstddef>
+
+#include <flecsi/concurrency/thread_pool.h>
+
+namespace flecsi {
+
+//------------------------------------------------------------------------//
+//! A blocked partition of the index range [0, n) into contiguous chunks.
+//! The number of chunks only depends on the range and the pool, so that
+//! callers can size per-chunk buffers before running a parallel_for
+//! over the same partition.
+//!
+//! @ingroup concurrency
+//------------------------------------------------------------------------//
+class parallel_range_t
+{
+public:
+  //---------------------------------------------------------------------//
+  //! Constructor
+  //!
+  //! @param pool  The pool that will execute the chunks, or nullptr
+  //!              to run everything on the calling thread.
+  //! @param n     The size of the index range.
+  //! @param grain The minimum number of indices per chunk.
+  //---------------------------------------------------------------------//
+  parallel_range_t(const thread_pool * pool, size_t n, size_t grain = 1024)
+    : n_(n) {
+    size_t workers = pool ? pool->num_threads() + 1 : 1;
+
+    // A few chunks per worker helps balancing irregular work.
+    chunks_ = std::min(workers > 1 ? 4 * workers : 1,
+      std::max<size_t>(n / std::max<size_t>(grain, 1), 1));
+  } // parallel_range_t
+
+  //---------------------------------------------------------------------//
+  //! Return the number of chunks.
+  //---------------------------------------------------------------------//
+  size_t size() const {
+    return chunks_;
+  } // size
+
+  //---------------------------------------------------------------------//
+  //! Return the first index of a chunk.
+  //---------------------------------------------------------------------//
+  size_t first(size_t chunk) const {
+    return n_ * chunk / chunks_;
+  } // first
+
+  //---------------------------------------------------------------------//
+  //! Return one past the last index of a chunk.
+  //---------------------------------------------------------------------//
+  size_t last(size_t chunk) const {
+    return n_ * (chunk + 1) / chunks_;
+  } // last
+
+private:
+  size_t n_;
+  size_t chunks_;
+}; // class parallel_range_t
+
+//------------------------------------------------------------------------//
+//! Execute f(chunk, first, last) for every chunk of a range and wait for
+//! all of them to finish. The calling thread takes part in the work. If
+//! no pool is given, or the range has a single chunk, the chunks are run
+//! in order on the calling thread.
+//!
+//! @ingroup concurrency
+//------------------------------------------------------------------------//
+template<typename F>
+void
+parallel_for(thread_pool * pool, const parallel_range_t & range, F && f) {
+  const size_t chunks = range.size();
+
+  if(!pool || pool->num_threads() == 0 || chunks == 1) {
+    for(size_t c{0}; c < chunks; ++c) {
+      f(c, range.first(c), range.last(c));
+    } // for
+    return;
+  } // if
+
+  wait_group wg;
+
+  for(size_t c{1}; c < chunks; ++c) {
+    pool->queue(
+      wg, [&f, &range, c]() { f(c, range.first(c), range.last(c)); });
+  } // for
+
+  f(0, range.first(0), range.last(0));
+
+  pool->wait(wg);
+} // parallel_for
+
+//------------------------------------------------------------------------//
+//! Execute f(i) for every i in [0, n) and wait for all of them to finish.
+//!
+//! @ingroup concurrency
+//------------------------------------------------------------------------//
+template<typename F>
+void
+parallel_for(thread_pool * pool, size_t n, F && f, size_t grain = 1024) {
+  parallel_for(pool, parallel_range_t(pool, n, grain),
+    [&f](size_t, size_t first, size_t last) {
+      for(size_t i{first}; i < last; ++i) {
+        f(i);
+      } // for
+    });
+} // parallel_for
+
+} // namespace flecsi
+
+/*~-------------------------------------------------------------------------~-*
+ *~-------------------------------------------------------------------------~-*/
@@ -0,0 +1,114 @@
+/*~--------------------------------------------------------------------------~*
+ *~--------------------------------------------------------------------------~*/
+
+#pragma once
+
+//----------------------------------------------------------------------------//
+//! @file
+//----------------------------------------------------------------------------//
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include <flecsi/concurrency/parallel_for.h>
+
+namespace flecsi {
+
+//------------------------------------------------------------------------//
+//! Sort unsigned integer keys together with their values using a stable
+//! least-significant-digit radix sort with 8-bit digits. Digits that are
+//! the same for all keys are skipped, so keys that only use their low
+//! bits (or share their high bits) are sorted in fewer passes.
+//!
+//! Every pass counts the digits of each chunk of the input, computes the
+//! output position of every (digit, chunk) pair, and scatters the chunks
+//! concurrently. The result does not depend on the number of threads.
+//!
+//! @param pool   The pool used for the passes, or nullptr to sort on the
+//!               calling thread.
+//! @param keys   The keys to sort.
+//! @param values The values, permuted like the keys.
+//!
+//! @ingroup concurrency
+//------------------------------------------------------------------------//
+template<typename K, typename V>
+void
+radix_sort(thread_pool * pool, std::vector<K> & keys, std::vector<V> & values) {
+  static_assert(std::is_unsigned<K>::value, "radix_sort needs unsigned keys");
+  assert(keys.size() == values.size());
+
+  constexpr size_t radix = 256;
+  using histogram_t = std::array<size_t, radix>;
+
+  const size_t n = keys.size();
+  parallel_range_t range(pool, n, 1 << 14);
+
+  // Bits that differ between at least two keys.
+  std::vector<K> diffs(range.size(), K(0));
+  parallel_for(pool, range, [&](size_t c, size_t first, size_t last) {
+    for(size_t i{first}; i < last; ++i) {
+      diffs[c] |= keys[i] ^ keys[0];
+    } // for
+  });
+
+  K diff = 0;
+  for(auto d : diffs) {
+    diff |= d;
+  } // for
+
+  std::vector<K> keys_tmp;
+  std::vector<V> values_tmp;
+  std::vector<histogram_t> offsets(range.size());
+
+  for(size_t shift{0}; shift < 8 * sizeof(K); shift += 8) {
+    if(((diff >> shift) & K(radix - 1)) == 0) {
+      continue;
+    } // if
+
+    if(keys_tmp.empty()) {
+      keys_tmp.resize(n);
+      values_tmp.resize(n);
+    } // if
+
+    parallel_for(pool, range, [&](size_t c, size_t first, size_t last) {
+      histogram_t & h = offsets[c];
+      h.fill(0);
+
+      for(size_t i{first}; i < last; ++i) {
+        ++h[(keys[i] >> shift) & K(radix - 1)];
+      } // for
+    });
+
+    // Turn the counts into output positions: digit-major, chunk-minor,
+    // which keeps the sort stable.
+    size_t position = 0;
+    for(size_t d{0}; d < radix; ++d) {
+      for(auto & h : offsets) {
+        const size_t count = h[d];
+        h[d] = position;
+        position += count;
+      } // for
+    } // for
+
+    parallel_for(pool, range, [&](size_t c, size_t first, size_t last) {
+      histogram_t & h = offsets[c];
+
+      for(size_t i{first}; i < last; ++i) {
+        const size_t j = h[(keys[i] >> shift) & K(radix - 1)]++;
+        keys_tmp[j] = keys[i];
+        values_tmp[j] = values[i];
+      } // for
+    });
+
+    keys.swap(keys_tmp);
+    values.swap(values_tmp);
+  } // for
+} // radix_sort
+
+} // namespace flecsi
+
+/*~-------------------------------------------------------------------------~-*
+ *~-------------------------------------------------------------------------~-*/
@@ -0,0 +1,54 @@
+/*~--------------------------------------------------------------------------~*
+ *~--------------------------------------------------------------------------~*/
+
+#include <cinchtest.h>
+
+#include <flecsi/concurrency/radix_sort.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace flecsi;
+
+TEST(radix_sort, stable) {
+  for(size_t threads : {0, 1, 4}) {
+    thread_pool pool;
+    pool.start(threads);
+
+    std::mt19937_64 rng(threads);
+
+    // Few distinct keys, spread over the high bits, to exercise both the
+    // digit skipping and the stability of the sort.
+    std::vector<uint64_t> keys(100000);
+    std::vector<size_t> values(keys.size());
+
+    for(size_t i = 0; i < keys.size(); ++i) {
+      keys[i] = (rng() % 1000) << 40 | 7;
+      values[i] = i;
+    } // for
+
+    std::vector<size_t> expected(values);
+    std::stable_sort(expected.begin(), expected.end(),
+      [&](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+    radix_sort(&pool, keys, values);
+
+    ASSERT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+    ASSERT_TRUE(values == expected);
+  } // for
+} // TEST
+
+TEST(radix_sort, serial) {
+  std::vector<uint32_t> keys = {5, 3, 3, 0, 4294967295u, 17};
+  std::vector<char> values = {'a', 'b', 'c', 'd', 'e', 'f'};
+
+  radix_sort(nullptr, keys, values);
+
+  ASSERT_TRUE(keys == std::vector<uint32_t>({0, 3, 3, 5, 17, 4294967295u}));
+  ASSERT_TRUE(values == std::vector<char>({'d', 'b', 'c', 'a', 'f', 'e'}));
+} // TEST
+
+/*~-------------------------------------------------------------------------~-*
+ *~-------------------------------------------------------------------------~-*/
@@ -0,0 +1,78 @@
+/*~--------------------------------------------------------------------------~*
+ *~--------------------------------------------------------------------------~*/
+
+#include <cinchtest.h>
+
+#include <flecsi/concurrency/parallel_for.h>
+#include <flecsi/concurrency/thread_pool.h>
+
+#include <array>
+#include <atomic>
+#include <numeric>
+#include <vector>
+
+using namespace flecsi;
+
+// Recursive fork/join: every task forks its children and waits for them,
+// so the waiting threads must help executing tasks.
+size_t
+fib(thread_pool & pool, size_t n) {
+  if(n < 12) {
+    return n < 2 ? n : fib(pool, n - 1) + fib(pool, n - 2);
+  } // if
+
+  size_t a, b;
+  wait_group wg;
+  pool.queue(wg, [&]() { a = fib(pool, n - 1); });
+  b = fib(pool, n - 2);
+  pool.wait(wg);
+
+  return a + b;
+} // fib
+
+TEST(thread_pool, fork_join) {
+  for(size_t threads : {0, 1, 4}) {
+    thread_pool pool;
+    pool.start(threads);
+    ASSERT_EQ(fib(pool, 25), 75025);
+  } // for
+} // TEST
+
+TEST(thread_pool, many_tasks) {
+  thread_pool pool;
+  pool.start(4);
+
+  std::atomic<size_t> sum{0};
+  wait_group wg;
+
+  // Large callables do not fit in a task record and use the heap.
+  std::array<size_t, 64> big;
+  std::iota(big.begin(), big.end(), 0);
+
+  for(size_t i = 0; i < 100000; ++i) {
+    if(i % 1000) {
+      pool.queue(wg, [&sum, i]() { sum += i; });
+    }
+    else {
+      pool.queue(wg, [&sum, big, i]() { sum += i + big[63] - 63; });
+    } // if
+  } // for
+
+  pool.wait(wg);
+  ASSERT_EQ(sum, size_t(100000) * 99999 / 2);
+} // TEST
+
+TEST(thread_pool, parallel_for) {
+  thread_pool pool;
+  pool.start(3);
+
+  std::vector<size_t> v(100000, 0);
+  parallel_for(&pool, v.size(), [&](size_t i) { v[i] = 2 * i; });
+
+  for(size_t i = 0; i < v.size(); ++i) {
+    ASSERT_EQ(v[i], 2 * i);
+  } // for
+} // TEST
+
+/*~-------------------------------------------------------------------------~-*
+ *~-------------------------------------------------------------------------~-*/
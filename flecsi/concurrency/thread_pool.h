@@ -9,30 +9,261 @@
 //----------------------------------------------------------------------------//
 
 #include <algorithm>
+#include <array>
 #include <atomic>
+#include <cassert>
 #include <condition_variable>
-#include <functional>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <new>
 #include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-#include <flecsi/concurrency/virtual_semaphore.h>
-
 namespace flecsi {
 
+//------------------------------------------------------------------------//
+//! A counter of outstanding tasks used for fork/join parallelism with a
+//! thread_pool: tasks queued with thread_pool::queue(wait_group &, ...)
+//! are added to the group, and thread_pool::wait() returns once all of
+//! them have finished.
+//!
+//! @ingroup concurrency
+//------------------------------------------------------------------------//
+class wait_group
+{
+public:
+  wait_group() = default;
+  wait_group(const wait_group &) = delete;
+  wait_group & operator=(const wait_group &) = delete;
+
+  //---------------------------------------------------------------------//
+  //! Add n outstanding tasks.
+  //---------------------------------------------------------------------//
+  void add(size_t n = 1) {
+    count_.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  //---------------------------------------------------------------------//
+  //! Mark one task as finished.
+  //---------------------------------------------------------------------//
+  void done() {
+    count_.fetch_sub(1, std::memory_order_release);
+  }
+
+  //---------------------------------------------------------------------//
+  //! Return true if all tasks of the group have finished.
+  //---------------------------------------------------------------------//
+  bool idle() const {
+    return count_.load(std::memory_order_acquire) == 0;
+  }
+
+private:
+  std::atomic<size_t> count_{0};
+}; // class wait_group
+
 //------------------------------------------------------------------------//
 //! This class provides a thread pool mechanism by which callable objects
 //! and associated arguments can be executed by a pool of worker threads.
 //!
+//! Each worker owns a lock-free work-stealing deque (Chase-Lev): tasks
+//! queued from a worker are pushed to and popped from the bottom of its
+//! own deque, and idle workers steal from the top of the others. Tasks
+//! queued from other threads go through a shared injection queue.
+//!
+//! Queued callables are stored inline in fixed-size task records, so that
+//! queueing small, trivially copyable callables (e.g., lambdas capturing
+//! pointers, references and scalars) does not allocate. Larger callables
+//! fall back to the heap.
+//!
 //! @ingroup concurrency
 //------------------------------------------------------------------------//
 class thread_pool
 {
-public:
-  //! signature of internally queued function
-  using function_t = std::function<void(void)>;
+  //! number of machine words in a task record
+  static constexpr size_t task_words = 16;
+
+  //---------------------------------------------------------------------//
+  //! A type-erased callable with inline storage.
+  //---------------------------------------------------------------------//
+  struct task_t {
+    static constexpr size_t capacity = (task_words - 1) * sizeof(uintptr_t);
+
+    void (*run)(task_t &);
+    alignas(uintptr_t) unsigned char data[capacity];
+
+    template<typename F>
+    static task_t make(F && f) {
+      using functor_t = std::decay_t<F>;
+      task_t t;
+
+      if constexpr(sizeof(functor_t) <= capacity &&
+                   alignof(functor_t) <= alignof(uintptr_t) &&
+                   std::is_trivially_copyable_v<functor_t>) {
+        new(t.data) functor_t(std::forward<F>(f));
+        t.run = [](task_t & self) {
+          (*std::launder(reinterpret_cast<functor_t *>(self.data)))();
+        };
+      }
+      else {
+        functor_t * p = new functor_t(std::forward<F>(f));
+        std::memcpy(t.data, &p, sizeof(p));
+        t.run = [](task_t & self) {
+          functor_t * p;
+          std::memcpy(&p, self.data, sizeof(p));
+          std::unique_ptr<functor_t> guard(p);
+          (*p)();
+        };
+      } // if
+
+      return t;
+    } // make
+  }; // struct task_t
+
+  static_assert(sizeof(task_t) == task_words * sizeof(uintptr_t),
+    "unexpected task record layout");
+  static_assert(std::is_trivially_copyable_v<task_t>,
+    "task records must be trivially copyable");
 
+  //---------------------------------------------------------------------//
+  //! A deque slot. Task records are copied in and out word by word with
+  //! relaxed atomics, because a thief may read a slot that is being
+  //! overwritten by the owner (the read is then discarded).
+  //---------------------------------------------------------------------//
+  struct slot_t {
+    std::array<std::atomic<uintptr_t>, task_words> words;
+
+    void store(const task_t & t) {
+      uintptr_t w[task_words];
+      std::memcpy(w, &t, sizeof(t));
+      for(size_t i{0}; i < task_words; ++i)
+        words[i].store(w[i], std::memory_order_relaxed);
+    }
+
+    task_t load() const {
+      uintptr_t w[task_words];
+      for(size_t i{0}; i < task_words; ++i)
+        w[i] = words[i].load(std::memory_order_relaxed);
+      task_t t;
+      std::memcpy(&t, w, sizeof(t));
+      return t;
+    }
+  }; // struct slot_t
+
+  //---------------------------------------------------------------------//
+  //! The Chase-Lev work-stealing deque, following Le et al.,
+  //! "Correct and Efficient Work-Stealing for Weak Memory Models".
+  //---------------------------------------------------------------------//
+  class deque_t
+  {
+    struct array_t {
+      explicit array_t(size_t capacity)
+        : mask(capacity - 1), slots(new slot_t[capacity]) {}
+
+      size_t capacity() const {
+        return mask + 1;
+      }
+
+      size_t mask;
+      std::unique_ptr<slot_t[]> slots;
+    }; // struct array_t
+
+  public:
+    deque_t() {
+      arrays_.emplace_back(new array_t(256));
+      array_.store(arrays_.back().get(), std::memory_order_relaxed);
+    }
+
+    //! Push a task at the bottom. Only called by the owner.
+    void push(const task_t & t) {
+      int64_t b = bottom_.load(std::memory_order_relaxed);
+      int64_t s = top_.load(std::memory_order_acquire);
+      array_t * a = array_.load(std::memory_order_relaxed);
+
+      if(b - s > int64_t(a->capacity()) - 1) {
+        a = grow_(a, s, b);
+      } // if
+
+      a->slots[b & a->mask].store(t);
+      std::atomic_thread_fence(std::memory_order_release);
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    } // push
+
+    //! Pop a task from the bottom. Only called by the owner.
+    bool pop(task_t & t) {
+      int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+      array_t * a = array_.load(std::memory_order_relaxed);
+      bottom_.store(b, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      int64_t s = top_.load(std::memory_order_relaxed);
+
+      if(s > b) {
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return false;
+      } // if
+
+      t = a->slots[b & a->mask].load();
+
+      if(s == b) {
+        // Last task: race against thieves.
+        bool won = top_.compare_exchange_strong(
+          s, s + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return won;
+      } // if
+
+      return true;
+    } // pop
+
+    //! Steal a task from the top. Called by any thread.
+    bool steal(task_t & t) {
+      int64_t s = top_.load(std::memory_order_acquire);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      int64_t b = bottom_.load(std::memory_order_acquire);
+
+      if(s >= b) {
+        return false;
+      } // if
+
+      array_t * a = array_.load(std::memory_order_acquire);
+      t = a->slots[s & a->mask].load();
+
+      return top_.compare_exchange_strong(
+        s, s + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    } // steal
+
+  private:
+    array_t * grow_(array_t * a, int64_t s, int64_t b) {
+      auto grown = new array_t(2 * a->capacity());
+      for(int64_t i{s}; i < b; ++i) {
+        grown->slots[i & grown->mask].store(a->slots[i & a->mask].load());
+      } // for
+
+      // Thieves may still be reading the old array, so it is only freed
+      // with the deque.
+      arrays_.emplace_back(grown);
+      array_.store(grown, std::memory_order_release);
+      return grown;
+    } // grow_
+
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    std::atomic<array_t *> array_;
+    std::vector<std::unique_ptr<array_t>> arrays_;
+  }; // class deque_t
+
+  struct worker_t {
+    thread_pool * pool;
+    size_t index;
+    deque_t deque;
+    std::thread thread;
+  }; // struct worker_t
+
+public:
   //---------------------------------------------------------------------//
   //! Constructor
   //---------------------------------------------------------------------//
@@ -40,6 +271,9 @@ public:
     done_ = false;
   }
 
+  thread_pool(const thread_pool &) = delete;
+  thread_pool & operator=(const thread_pool &) = delete;
+
   //---------------------------------------------------------------------//
   //! Destructor
   //---------------------------------------------------------------------//
@@ -48,36 +282,46 @@ public:
   }
 
   //---------------------------------------------------------------------//
-  //! Internal run method. Do not call directly.
+  //! Queue a callable object and associated arguments to the thread pool.
   //---------------------------------------------------------------------//
-  void run_() {
-    for(;;) {
-      sem_.acquire();
-
-      mutex_.lock();
-
-      if(done_) {
-        mutex_.unlock();
-        return;
-      }
+  template<typename FT, typename... ARGS>
+  void queue(FT f, ARGS... args) {
+    push_(task_t::make([f, args...]() mutable { f(args...); }));
+  }
 
-      auto f = queue_.front();
-      queue_.pop();
-      mutex_.unlock();
+  //---------------------------------------------------------------------//
+  //! Queue a callable object as part of a wait group. Use wait() to wait
+  //! for all tasks of the group.
+  //---------------------------------------------------------------------//
+  template<typename FT>
+  void queue(wait_group & wg, FT f) {
+    wg.add();
+    push_(task_t::make([f, &wg]() mutable {
       f();
-    }
+      wg.done();
+    }));
   }
 
   //---------------------------------------------------------------------//
-  //! Queue a callable object and associated arguments to the thread pool.
+  //! Wait for all tasks of a wait group to finish. The calling thread
+  //! executes queued tasks while it waits, so this may be called from
+  //! within a task (nested fork/join) and on a pool without threads.
   //---------------------------------------------------------------------//
-  template<typename FT, typename... ARGS>
-  void queue(FT f, ARGS... args) {
-    mutex_.lock();
-    queue_.emplace(std::bind(f, std::forward<ARGS>(args)...));
-    mutex_.unlock();
-    sem_.release();
-  }
+  void wait(wait_group & wg) {
+    worker_t * self = current_worker_();
+    if(self && self->pool != this)
+      self = nullptr;
+
+    while(!wg.idle()) {
+      task_t t;
+      if(take_(self, t)) {
+        t.run(t);
+      }
+      else {
+        std::this_thread::yield();
+      } // if
+    } // while
+  } // wait
 
   //---------------------------------------------------------------------//
   //! The constructor does not start the thread pool until this method is
@@ -86,11 +330,16 @@ public:
   //! @param num_threads Number of workers threads
   //---------------------------------------------------------------------//
   void start(size_t num_threads) {
-    assert(threads_.empty() && "thread pool already started");
+    assert(workers_.empty() && "thread pool already started");
 
     for(size_t i = 0; i < num_threads; ++i) {
-      auto t = new std::thread(&thread_pool::run_, this);
-      threads_.push_back(t);
+      workers_.emplace_back(new worker_t{this, i, {}, {}});
+    }
+
+    // Start the threads once all deques exist, since workers steal from
+    // each other.
+    for(auto & w : workers_) {
+      w->thread = std::thread(&thread_pool::run_, this, w.get());
     }
   }
 
@@ -102,12 +351,15 @@ public:
       return;
     }
 
-    done_ = true;
-    sem_.interrupt();
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      done_ = true;
+    }
+    sleep_cv_.notify_all();
 
-    for(auto t : threads_) {
-      t->join();
-      delete t;
+    for(auto & w : workers_) {
+      if(w->thread.joinable())
+        w->thread.join();
     }
   }
 
@@ -115,14 +367,122 @@ public:
   //! Return the number of worker threads
   //---------------------------------------------------------------------//
   size_t num_threads() const {
-    return threads_.size();
+    return workers_.size();
   }
 
 private:
-  std::mutex mutex_;
-  std::queue<function_t> queue_;
-  std::vector<std::thread *> threads_;
-  virtual_semaphore sem_;
+  //---------------------------------------------------------------------//
+  //! Worker loop.
+  //---------------------------------------------------------------------//
+  void run_(worker_t * self) {
+    current_worker_() = self;
+
+    for(;;) {
+      task_t t;
+
+      // Spin for a while before going to sleep: fine-grained fork/join
+      // work usually arrives in bursts.
+      bool found = false;
+      for(size_t i{0}; i < 64; ++i) {
+        if(take_(self, t)) {
+          found = true;
+          break;
+        } // if
+        if(done_)
+          return;
+        std::this_thread::yield();
+      } // for
+
+      if(found) {
+        t.run(t);
+        continue;
+      } // if
+
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      sleeping_.fetch_add(1);
+      sleep_cv_.wait(lock, [this] { return done_ || pending_.load() > 0; });
+      sleeping_.fetch_sub(1);
+
+      if(done_)
+        return;
+    } // for
+  } // run_
+
+  //---------------------------------------------------------------------//
+  //! Push a task to the deque of the calling worker, or to the injection
+  //! queue if called from outside the pool.
+  //---------------------------------------------------------------------//
+  void push_(const task_t & t) {
+    worker_t * self = current_worker_();
+
+    // Count the task before publishing it, so that the count never drops
+    // below the number of tasks that can be taken.
+    pending_.fetch_add(1);
+
+    if(self && self->pool == this) {
+      self->deque.push(t);
+    }
+    else {
+      std::lock_guard<std::mutex> lock(inject_mutex_);
+      inject_.push_back(t);
+    } // if
+
+    if(sleeping_.load() > 0) {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      sleep_cv_.notify_one();
+    } // if
+  } // push_
+
+  //---------------------------------------------------------------------//
+  //! Take a task: from our own deque first, then from the injection
+  //! queue, then by stealing from the other workers.
+  //---------------------------------------------------------------------//
+  bool take_(worker_t * self, task_t & t) {
+    if(pending_.load(std::memory_order_relaxed) == 0)
+      return false;
+
+    bool found = self && self->deque.pop(t);
+
+    if(!found) {
+      std::lock_guard<std::mutex> lock(inject_mutex_);
+      if(!inject_.empty()) {
+        t = inject_.front();
+        inject_.pop_front();
+        found = true;
+      } // if
+    } // if
+
+    const size_t n = workers_.size();
+    const size_t first = self ? self->index + 1 : 0;
+    for(size_t i{0}; !found && i < n; ++i) {
+      worker_t * victim = workers_[(first + i) % n].get();
+      if(victim != self)
+        found = victim->deque.steal(t);
+    } // for
+
+    if(found)
+      pending_.fetch_sub(1);
+
+    return found;
+  } // take_
+
+  //---------------------------------------------------------------------//
+  //! The worker running on the calling thread, if any.
+  //---------------------------------------------------------------------//
+  static worker_t *& current_worker_() {
+    static thread_local worker_t * worker = nullptr;
+    return worker;
+  }
+
+  std::vector<std::unique_ptr<worker_t>> workers_;
+
+  std::mutex inject_mutex_;
+  std::deque<task_t> inject_;
+
+  std::atomic<size_t> pending_{0};
+  std::atomic<size_t> sleeping_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
   std::atomic_bool done_;
 };
 
@@ -16,6 +16,7 @@
 /*! @file */
 
 #include <algorithm>
+#include <cassert>
 #include <stdint.h>
 
 namespace flecsi {
@@ -40,7 +41,8 @@ struct row_vector_u {
   }
 
   ~row_vector_u() {
-    delete[] datap;
+    if(!borrowed())
+      delete[] datap;
   }
 
   row_vector_u<T> & operator=(const row_vector_u<T> & rhs) {
@@ -85,25 +87,48 @@ struct row_vector_u {
   }
 
   void clear() {
+    if(!borrowed())
+      delete[] datap;
     count = 0;
     capacity = 0;
-    delete[] datap;
     datap = nullptr;
   }
 
+  /*!
+    Point the row at external storage, e.g., a slice of a contiguous
+    buffer shared by all rows of a field. The row does not own this
+    storage: it is never freed by the row, and the row moves its entries
+    to its own heap storage if it has to grow beyond \e new_cap.
+   */
+  void attach(T * ptr, uint32_t new_count, uint32_t new_cap) {
+    assert(new_cap < borrowed_bit);
+    if(!borrowed())
+      delete[] datap;
+    datap = ptr;
+    count = new_count;
+    capacity = new_cap | borrowed_bit;
+  } // attach
+
+  //! True if the entries are stored outside of the row (see attach).
+  bool borrowed() const {
+    return capacity & borrowed_bit;
+  } // borrowed
+
   void assign(const_iterator first, const_iterator last) {
     resize(last - first);
     std::copy(first, last, datap);
   }
 
   void reserve(uint32_t new_cap) {
-    if(new_cap <= capacity) {
+    if(new_cap <= (capacity & ~borrowed_bit)) {
       return;
     }
 
+    assert(new_cap < borrowed_bit);
     auto new_data = new T[new_cap];
     std::copy_n(datap, count, new_data);
-    delete[] datap;
+    if(!borrowed())
+      delete[] datap;
     capacity = new_cap;
     datap = new_data;
   } // reserve
@@ -114,7 +139,7 @@ struct row_vector_u {
   } // resize
 
   void push_back(const T & value) {
-    if(count == capacity) {
+    if(count == (capacity & ~borrowed_bit)) {
       reserve(count + 5);
     }
     datap[count] = value;
@@ -133,7 +158,7 @@ struct row_vector_u {
     auto idx = pos - datap;
     assert(idx >= 0);
     assert(idx <= count);
-    if(count == capacity) {
+    if(count == (capacity & ~borrowed_bit)) {
       reserve(count + 5);
     }
     auto newpos = datap + idx;
@@ -143,6 +168,10 @@ struct row_vector_u {
     return newpos;
   } // insert
 
+  //! The top bit of capacity marks borrowed storage, so that rows keep
+  //! the layout of the other backends.
+  static constexpr uint32_t borrowed_bit = uint32_t(1) << 31;
+
   uint32_t count = 0;
   uint32_t capacity = 0;
   T * datap = nullptr;
@@ -180,6 +180,13 @@
 
   Access global data
 
+  With the MPI runtime, the value written to global data by a task is only
+  sent from rank 0 to the other ranks when global data is next read: by a
+  task, or when a handle is obtained with this macro. To read global data
+  outside of a task after a task has written it, obtain the handle again
+  after that task rather than reusing an older one. Like task launches,
+  this must be done by every rank.
+
   @param nspace        The namespace to use to access the variable.
   @param name          The name of the data variable to access.
   @param data_type     The data type to access, e.g., double or my_type_t.
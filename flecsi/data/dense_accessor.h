@@ -19,6 +19,7 @@
 #include <flecsi/data/common/data_reference.h>
 #include <flecsi/data/data_constants.h>
 #include <flecsi/data/dense_data_handle.h>
+#include <flecsi/utils/aligned_allocator.h>
 #include <flecsi/utils/target.h>
 
 /*!
@@ -90,7 +91,7 @@ struct accessor_u<data::dense,
   FLECSI_INLINE_TARGET
   T & operator()(size_t index) {
     assert(index < handle.combined_size && "index out of range");
-    return *(handle.combined_data + index);
+    return *(data() + index);
   }
 
   /*!
@@ -105,6 +106,17 @@ struct accessor_u<data::dense,
     return const_cast<accessor_u &>(*this)(index);
   }
 
+  /*!
+   \brief Return a pointer to the data of all the indices, exclusive,
+          shared and ghost, in this order. With the MPI runtime, the
+          compiler may assume that it is aligned to FLECSI_FIELD_ALIGNMENT
+          bytes.
+   */
+  FLECSI_INLINE_TARGET
+  T * data() const {
+    return FLECSI_ASSUME_FIELD_ALIGNED(handle.combined_data);
+  }
+
   /*!
    \brief Return the index space size of the data variable
           referenced by this handle.
@@ -138,33 +138,39 @@ struct storage_class_u<dense> {
     using client_type = typename DATA_CLIENT_TYPE::type_identifier_t;
 
     // get field_info for this data handle
-    auto & field_info = context.get_field_info_from_name(
+    const auto & field_info = context.get_field_info_from_name(
       typeid(typename DATA_CLIENT_TYPE::type_identifier_t).hash_code(),
       utils::hash::field_hash<NAMESPACE, NAME>(VERSION));
 
-    // get color_info for this field.
-    auto & color_info =
-      (context.coloring_info(field_info.index_space)).at(context.color());
-    auto & index_coloring = context.coloring(field_info.index_space);
-
-    auto & registered_field_data = context.registered_field_data();
-    auto fieldDataIter = registered_field_data.find(field_info.fid);
-    if(fieldDataIter == registered_field_data.end()) {
-      size_t size = field_info.size * (color_info.exclusive +
-                                        color_info.shared + color_info.ghost);
-      // TODO: deal with VERSION
-      context.register_field_data(field_info.fid, size);
-    }
-    auto fieldMetaDataIter =
-      context.registered_field_metadata().find(field_info.fid);
-    if(fieldMetaDataIter == context.registered_field_metadata().end()) {
-      context.register_field_metadata<DATA_TYPE>(
-        field_info.fid, color_info, index_coloring);
-    }
-
-    auto & ism = context.index_space_data_map();
-
-    auto data = registered_field_data[field_info.fid].data();
+    if(!context.field_state_resolved(field_info.fid)) {
+      // get color_info for this field.
+      auto & color_info =
+        (context.coloring_info(field_info.index_space)).at(context.color());
+      auto & index_coloring = context.coloring(field_info.index_space);
+
+      auto & registered_field_data = context.registered_field_data();
+      auto fieldDataIter = registered_field_data.find(field_info.fid);
+      if(fieldDataIter == registered_field_data.end()) {
+        size_t size = field_info.size * (color_info.exclusive +
+                                          color_info.shared + color_info.ghost);
+        // TODO: deal with VERSION
+        context.register_field_data(field_info.fid, size);
+      }
+      auto fieldMetaDataIter =
+        context.registered_field_metadata().find(field_info.fid);
+      if(fieldMetaDataIter == context.registered_field_metadata().end()) {
+        context.register_field_metadata<DATA_TYPE>(field_info.fid,
+          field_info.index_space, color_info, index_coloring);
+      }
+
+      context.resolve_field_state(
+        field_info.fid, field_info.index_space, &color_info);
+    } // if
+
+    auto & state = context.field_state(field_info.fid);
+    auto & color_info = *state.coloring_info;
+
+    auto data = state.data->data();
     // populate data member of data_handle_t
     auto & hb = dynamic_cast<dense_data_handle_u<DATA_TYPE, 0, 0, 0> &>(h);
 
@@ -185,8 +191,7 @@ struct storage_class_u<dense> {
     hb.ghost_data = hb.ghost_buf = hb.shared_data + hb.shared_size;
     hb.combined_size += color_info.ghost;
 
-    hb.ghost_is_readable =
-      &(ism[field_info.index_space].ghost_is_readable[field_info.fid]);
+    hb.ghost_is_readable = state.ghost_is_readable;
 
     return h;
   }
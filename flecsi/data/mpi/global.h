@@ -161,18 +161,28 @@ struct storage_class_u<global> {
     handle_t<DATA_TYPE, 0> h;
     auto & context = execution::context_t::instance();
 
-    auto & field_info = context.get_field_info_from_name(
+    // Global data written by a task is only broadcast when it is next read,
+    // so bring it up to date for reads through this handle outside of a
+    // task. This is collective, like the code that gets the handle.
+    context.sync_global_data();
+
+    const auto & field_info = context.get_field_info_from_name(
       typeid(typename DATA_CLIENT_TYPE::type_identifier_t).hash_code(),
       utils::hash::field_hash<NAMESPACE, NAME>(VERSION));
 
-    auto & registered_field_data = context.registered_field_data();
-    auto fieldDataIter = registered_field_data.find(field_info.fid);
-    if(fieldDataIter == registered_field_data.end()) {
-      // TODO: deal with VERSION
-      context.register_field_data(field_info.fid, field_info.size);
-    }
+    if(!context.field_state_resolved(field_info.fid)) {
+      auto & registered_field_data = context.registered_field_data();
+      auto fieldDataIter = registered_field_data.find(field_info.fid);
+      if(fieldDataIter == registered_field_data.end()) {
+        // TODO: deal with VERSION
+        context.register_field_data(field_info.fid, field_info.size);
+      }
+
+      context.resolve_field_state(
+        field_info.fid, field_info.index_space, nullptr);
+    } // if
 
-    auto data = registered_field_data[field_info.fid].data();
+    auto data = context.field_state(field_info.fid).data->data();
 
     h.fid = field_info.fid;
     h.index_space = field_info.index_space;
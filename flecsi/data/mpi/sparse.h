@@ -71,45 +71,49 @@ struct storage_class_u<ragged> {
     using client_type = typename DATA_CLIENT_TYPE::type_identifier_t;
 
     // get field_info for this data handle
-    auto & field_info = context.get_field_info_from_name(
+    const auto & field_info = context.get_field_info_from_name(
       typeid(typename DATA_CLIENT_TYPE::type_identifier_t).hash_code(),
       utils::hash::field_hash<NAMESPACE, NAME>(VERSION));
 
-    auto & registered_sparse_field_data =
-      context.registered_sparse_field_data();
-    auto fieldDataIter = registered_sparse_field_data.find(field_info.fid);
-    if(fieldDataIter == registered_sparse_field_data.end()) {
+    if(!context.field_state_resolved(field_info.fid)) {
       // get color_info for this field.
       auto & color_info =
         (context.coloring_info(field_info.index_space)).at(context.color());
       auto & index_coloring = context.coloring(field_info.index_space);
 
-      auto & im = context.sparse_index_space_info_map();
-      auto iitr = im.find(field_info.index_space);
-      clog_assert(iitr != im.end(),
-        "sparse index space info not registered for index space: "
-          << field_info.index_space);
-
-      // TODO: these parameters need to be passed in field
-      // registration, or defined elsewhere
-      const size_t max_entries_per_index = iitr->second.max_entries_per_index;
-
-      // TODO: deal with VERSION
-      context.register_sparse_field_data(
-        field_info.fid, field_info.size, color_info, max_entries_per_index);
-    }
-    auto fieldMetaDataIter =
-      context.registered_sparse_field_metadata().find(field_info.fid);
-    if(fieldMetaDataIter == context.registered_sparse_field_metadata().end()) {
-      auto & color_info =
-        (context.coloring_info(field_info.index_space)).at(context.color());
-      auto & index_coloring = context.coloring(field_info.index_space);
-
-      context.register_sparse_field_metadata<DATA_TYPE>(
-        field_info.fid, color_info, index_coloring);
-    }
-
-    auto & fd = registered_sparse_field_data[field_info.fid];
+      auto & registered_sparse_field_data =
+        context.registered_sparse_field_data();
+      auto fieldDataIter = registered_sparse_field_data.find(field_info.fid);
+      if(fieldDataIter == registered_sparse_field_data.end()) {
+        auto & im = context.sparse_index_space_info_map();
+        auto iitr = im.find(field_info.index_space);
+        clog_assert(iitr != im.end(),
+          "sparse index space info not registered for index space: "
+            << field_info.index_space);
+
+        // TODO: these parameters need to be passed in field
+        // registration, or defined elsewhere
+        const size_t max_entries_per_index =
+          iitr->second.max_entries_per_index;
+
+        // TODO: deal with VERSION
+        context.register_sparse_field_data(
+          field_info.fid, field_info.size, color_info, max_entries_per_index);
+      }
+      auto fieldMetaDataIter =
+        context.registered_sparse_field_metadata().find(field_info.fid);
+      if(fieldMetaDataIter ==
+         context.registered_sparse_field_metadata().end()) {
+        context.register_sparse_field_metadata<DATA_TYPE>(field_info.fid,
+          field_info.index_space, color_info, index_coloring);
+      }
+
+      context.resolve_field_state(
+        field_info.fid, field_info.index_space, &color_info);
+    } // if
+
+    auto & state = context.field_state(field_info.fid);
+    auto & fd = *state.sparse_data;
 
     handle_u<DATA_TYPE> h(fd.max_entries_per_index);
     h.init(fd.num_exclusive, fd.num_shared, fd.num_ghost);
@@ -122,11 +126,8 @@ struct storage_class_u<ragged> {
     using vector_t = typename ragged_data_handle_u<DATA_TYPE>::vector_t;
     hb.rows = reinterpret_cast<vector_t *>(&fd.rows[0]);
 
-    auto & ism = context.index_space_data_map();
-    hb.ghost_is_readable =
-      &(ism[field_info.index_space].ghost_is_readable[field_info.fid]);
-    hb.ghost_was_resized =
-      &(ism[field_info.index_space].ghost_was_resized[field_info.fid]);
+    hb.ghost_is_readable = state.ghost_is_readable;
+    hb.ghost_was_resized = state.ghost_was_resized;
 
     return h;
   }
@@ -138,8 +139,15 @@ struct storage_class_u<ragged> {
     size_t VERSION>
   static handle_u<DATA_TYPE> get_mutator(const data_client_t & data_client,
     size_t) {
-    return get_handle<DATA_CLIENT_TYPE, DATA_TYPE, NAMESPACE, NAME, VERSION>(
+    auto h = get_handle<DATA_CLIENT_TYPE, DATA_TYPE, NAMESPACE, NAME, VERSION>(
       data_client);
+
+    // The rows may leave the contiguous storage until the mutator is
+    // finalized, which compacts them again.
+    auto & state = execution::context_t::instance().field_state(h.fid);
+    state.sparse_data->compacted = false;
+
+    return h;
   }
 
 }; // struct storage_class_t
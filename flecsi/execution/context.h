@@ -35,6 +35,7 @@
 #include <flecsi/runtime/types.h>
 #include <flecsi/utils/common.h>
 #include <flecsi/utils/hash.h>
+#include <flecsi/utils/id_map.h>
 #include <flecsi/utils/simple_id.h>
 
 clog_register_tag(context);
@@ -323,12 +324,21 @@ struct context_u : public CONTEXT_POLICY {
 
   void add_index_map(size_t index_space, std::vector<size_t> & index_map) {
     index_map_[index_space] = index_map;
-
-    auto & rev_map = reverse_index_map_[index_space];
-    for(size_t i = 0; i < index_map.size(); ++i)
-      rev_map[index_map[i]] = i;
+    build_reverse_index_map(index_space);
   } // add_index_map
 
+  /*!
+    Build the reverse index map of the given index space from its index
+    map, which must have been set.
+
+    @param index_space The map key.
+   */
+
+  void build_reverse_index_map(size_t index_space) {
+    reverse_index_map_[index_space] =
+      reverse_index_map_t::invert(index_map(index_space));
+  } // build_reverse_index_map
+
   /*!
     Return the index map associated with the given index space.
 
@@ -975,8 +985,10 @@ private:
   // key: mesh index space entity id
   //--------------------------------------------------------------------------//
 
+  using reverse_index_map_t = utils::id_map_u<size_t, utils::indices_t>;
+
   std::map<size_t, std::vector<size_t>> index_map_;
-  std::map<size_t, std::map<size_t, utils::indices_t>> reverse_index_map_;
+  std::map<size_t, reverse_index_map_t> reverse_index_map_;
 
   //--------------------------------------------------------------------------//
   // key: index space
@@ -984,14 +996,9 @@ private:
 
   std::map<size_t, sparse_index_space_info_t> sparse_index_space_info_map_;
 
-#if 0
-  std::map<size_t, std::map<size_t, size_t>> cis_to_mis_map_;
-  std::map<size_t, std::map<size_t, size_t>> mis_to_cis_map_;
-#endif
-
   // key: mesh index space entity id
-  std::map<size_t, std::map<size_t, size_t>> cis_to_gis_map_;
-  std::map<size_t, std::map<size_t, size_t>> gis_to_cis_map_;
+  std::map<size_t, utils::id_map_u<size_t, size_t>> cis_to_gis_map_;
+  std::map<size_t, utils::id_map_u<size_t, size_t>> gis_to_cis_map_;
 
   //--------------------------------------------------------------------------//
   // Data members for ntermediate mapping
@@ -1152,6 +1159,7 @@ public:
         using value_type = typename std::tuple_element<1, map_type>::type;
         auto ret = CONTEXT_POLICY::sparse_field_data.emplace(fid, value_type{});
         it = ret.first;
+        CONTEXT_POLICY::new_field_state(fid).sparse_data = &it->second;
       }
       assert(
         it != CONTEXT_POLICY::sparse_field_data.end() && "sparse messed up");
@@ -17,6 +17,8 @@
   @file
  */
 
+#include <flecsi-config.h>
+
 #include <algorithm>
 
 #ifdef FLECSI_ENABLE_KOKKOS
@@ -160,7 +162,481 @@ private:
   reduceall_t{iterator, reducer, name} + KOKKOS_LAMBDA(auto it, auto & tmp)
 
 } // namespace flecsi
+
+#else // FLECSI_ENABLE_KOKKOS
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include <flecsi/concurrency/thread_pool.h>
+
+namespace flecsi {
+
+/*!
+  The distribution of the iterations of a parallel_for or parallel_reduce
+  among the tasks of a kernel, when FleCSI is built without Kokkos. A
+  kernel runs one task per thread of its thread pool, plus one on the
+  calling thread.
+
+  With static chunks, a task runs the same iterations every time, so that
+  the result of a reduction does not depend on timing. A chunk size of zero
+  gives every task one contiguous block of iterations.
+
+  With dynamic chunks, a task takes the next chunk when it is done with
+  the previous one, which balances kernels whose cost varies between
+  entities. A chunk size of zero gives about eight chunks per task.
+ */
+
+struct schedule_t {
+
+  enum kind_t { static_kind, dynamic_kind };
+
+  kind_t kind = static_kind;
+  size_t chunk = 0;
+
+  static schedule_t static_chunks(size_t chunk = 0) {
+    return {static_kind, chunk};
+  } // static_chunks
+
+  static schedule_t dynamic_chunks(size_t chunk = 0) {
+    return {dynamic_kind, chunk};
+  } // dynamic_chunks
+
+}; // struct schedule_t
+
+namespace kernel {
+
+namespace detail {
+
+struct pool_state_t {
+  bool set = false;
+  thread_pool * pool = nullptr;
+  size_t ranks_per_node = 1;
+}; // struct pool_state_t
+
+inline pool_state_t &
+pool_state() {
+  static pool_state_t state;
+  return state;
+} // pool_state
+
+/*!
+  Return the number of threads that the kernels of this rank run on by
+  default, counting the calling thread:
+
+  - the value of the environment variable FLECSI_KERNEL_THREADS, if it is
+    a positive number;
+  - otherwise, the number of cores that the rank may run on, if it is bound
+    to some of the cores of its node;
+  - otherwise, the cores of the node divided among its ranks (see
+    set_ranks_per_node()).
+ */
+
+inline size_t
+default_kernel_threads() {
+  if(const char * threads = std::getenv("FLECSI_KERNEL_THREADS")) {
+    const long n = std::atol(threads);
+    if(n > 0)
+      return n;
+  } // if
+
+  const size_t node_cores = std::max(std::thread::hardware_concurrency(), 1u);
+  size_t cores = node_cores;
+#if defined(__linux__)
+  cpu_set_t set;
+  if(sched_getaffinity(0, sizeof(set), &set) == 0)
+    cores = CPU_COUNT(&set);
 #endif
+  if(cores < node_cores)
+    return cores;
+
+  return std::max(node_cores / pool_state().ranks_per_node, size_t(1));
+} // default_kernel_threads
+
+/*!
+  The thread pool used by the kernels when none has been set. Its threads
+  are started on first use: one less than default_kernel_threads(), so
+  that ranks with a single core run their kernels on the calling thread
+  only.
+ */
+
+inline thread_pool *
+default_thread_pool() {
+  static thread_pool pool;
+  static const bool started = [] {
+    pool.start(default_kernel_threads() - 1);
+    return true;
+  }();
+  (void)started;
+  return &pool;
+} // default_thread_pool
+
+} // namespace detail
+
+/*!
+  Run the kernels of this rank on the given thread pool, or on the calling
+  thread only if \e pool is null. This must not be called while a kernel
+  is running.
+ */
+
+inline void
+set_thread_pool(thread_pool * pool) {
+  auto & state = detail::pool_state();
+  state.set = true;
+  state.pool = pool;
+} // set_thread_pool
+
+/*!
+  Record the number of ranks that run on the node of this rank. When the
+  ranks are not bound to cores, the default thread pool divides the cores
+  of the node among them. This must be called before the first kernel
+  runs on the default pool.
+ */
+
+inline void
+set_ranks_per_node(size_t ranks) {
+  detail::pool_state().ranks_per_node = std::max(ranks, size_t(1));
+} // set_ranks_per_node
+
+/*!
+  Return the thread pool that the kernels of this rank run on.
+ */
+
+inline thread_pool *
+get_thread_pool() {
+  const auto & state = detail::pool_state();
+  return state.set ? state.pool : detail::default_thread_pool();
+} // get_thread_pool
+
+namespace detail {
+
+/*!
+  Return the number of tasks that a kernel on a pool may be split into.
+ */
+
+inline size_t
+kernel_tasks(const thread_pool * pool) {
+  return pool ? pool->num_threads() + 1 : 1;
+} // kernel_tasks
+
+/*!
+  Split the iterations [0, size) into chunks, and call
+  body(task, begin, end) for every chunk, in up to \e tasks tasks on the
+  pool. The task index is less than \e tasks. The calling thread runs the
+  first task, and runs queued tasks while it waits for the others, so
+  that kernels can be called from kernels.
+ */
+
+template<typename BODY>
+void
+run_chunks(thread_pool * pool,
+  size_t size,
+  size_t tasks,
+  const schedule_t & schedule,
+  BODY && body) {
+
+  if(tasks > size)
+    tasks = size;
+
+  if(!pool || tasks <= 1) {
+    if(size > 0)
+      body(size_t(0), size_t(0), size);
+    return;
+  } // if
+
+  const size_t chunk =
+    schedule.chunk ? schedule.chunk : std::max(size_t(1), size / (8 * tasks));
+  std::atomic<size_t> next{0};
+
+  auto task = [&](size_t t) {
+    if(schedule.kind == schedule_t::dynamic_kind) {
+      for(size_t b = next.fetch_add(chunk); b < size;
+          b = next.fetch_add(chunk)) {
+        body(t, b, std::min(size, b + chunk));
+      } // for
+    }
+    else if(schedule.chunk == 0) {
+      const size_t block = size / tasks;
+      const size_t extra = size % tasks;
+      const size_t b = t * block + std::min(t, extra);
+      const size_t e = b + block + (t < extra ? 1 : 0);
+      if(b < e)
+        body(t, b, e);
+    }
+    else {
+      for(size_t b = t * chunk; b < size; b += tasks * chunk) {
+        body(t, b, std::min(size, b + chunk));
+      } // for
+    } // if
+  }; // task
+
+  wait_group wg;
+
+  for(size_t t = 1; t < tasks; ++t) {
+    pool->queue(wg, [&task, t]() { task(t); });
+  } // for
+
+  task(0);
+
+  pool->wait(wg);
+} // run_chunks
+
+} // namespace detail
+
+/*!
+  Apply a function to every entity of a range, e.g., the entities of a
+  mesh or a slice of an index space, using the thread pool of the rank
+  (see set_thread_pool()). The function may be called concurrently, and in
+  any order.
+
+  @param iterator The range, which must provide size() and operator[].
+  @param lambda   The function, called with every entity.
+  @param name     The name of the kernel (unused).
+  @param schedule The distribution of the entities among the tasks.
+ */
+
+template<typename ITERATOR, typename LAMBDA>
+void
+parallel_for(ITERATOR iterator,
+  LAMBDA lambda,
+  std::string const & name = "",
+  schedule_t const & schedule = {}) {
+
+  thread_pool * pool = get_thread_pool();
+  detail::run_chunks(pool, iterator.size(), detail::kernel_tasks(pool),
+    schedule, [&](size_t, size_t begin, size_t end) {
+      for(size_t i = begin; i < end; ++i) {
+        lambda(iterator[i]);
+      } // for
+    });
+
+} // parallel_for
+
+/*!
+  Reduce a function over every entity of a range, using the thread pool of
+  the rank. Every task accumulates into its own value, which starts at the
+  identity of the reducer. The values of the tasks are then joined in the
+  order of the tasks, and the result is stored in the reference of the
+  reducer. With static chunks, the result does not depend on timing.
+
+  @param iterator The range, which must provide size() and operator[].
+  @param lambda   The function, called with every entity and the value of
+                  the calling task.
+  @param result   The reducer, e.g., reducer::sum<double>(value).
+  @param name     The name of the kernel (unused).
+  @param schedule The distribution of the entities among the tasks.
+ */
+
+template<typename ITERATOR, typename LAMBDA, typename REDUCER>
+void
+parallel_reduce(ITERATOR iterator,
+  LAMBDA lambda,
+  REDUCER result,
+  std::string const & name = "",
+  schedule_t const & schedule = {}) {
+
+  using value_type = typename REDUCER::value_type;
+
+  thread_pool * pool = get_thread_pool();
+  const size_t tasks = std::min(detail::kernel_tasks(pool),
+    std::max(size_t(1), size_t(iterator.size())));
+  std::vector<value_type> partial(tasks);
+  for(auto & p : partial) {
+    result.init(p);
+  } // for
+
+  detail::run_chunks(pool, iterator.size(), tasks, schedule,
+    [&](size_t task, size_t begin, size_t end) {
+      value_type tmp = partial[task];
+      for(size_t i = begin; i < end; ++i) {
+        lambda(iterator[i], tmp);
+      } // for
+      partial[task] = tmp;
+    });
+
+  value_type & value = result.reference();
+  result.init(value);
+  for(const auto & p : partial) {
+    result.join(value, p);
+  } // for
+
+} // parallel_reduce
+
+} // namespace kernel
+
+template<typename ITERATOR>
+struct forall_t {
+
+  forall_t(ITERATOR iterator,
+    std::string const & name = "",
+    schedule_t const & schedule = {})
+    : iterator_(iterator), schedule_(schedule) {}
+
+  template<typename LAMBDA>
+  void operator+(LAMBDA lambda) {
+    kernel::parallel_for(iterator_, lambda, "", schedule_);
+  } // operator+
+
+private:
+  ITERATOR iterator_;
+  schedule_t schedule_;
+
+}; // forall_t
+
+#define forall(it, iterator, ...)                                              \
+  forall_t{iterator, __VA_ARGS__} + [=](auto it)
+
+template<typename ITERATOR, typename REDUCER>
+struct reduceall_t {
+
+  reduceall_t(ITERATOR iterator,
+    REDUCER reducer,
+    std::string const & name = "",
+    schedule_t const & schedule = {})
+    : iterator_(iterator), reducer_(reducer), schedule_(schedule) {}
+
+  template<typename LAMBDA>
+  void operator+(LAMBDA lambda) {
+    kernel::parallel_reduce(iterator_, lambda, reducer_, "", schedule_);
+  } // operator+
+
+private:
+  ITERATOR iterator_;
+  REDUCER reducer_;
+  schedule_t schedule_;
+
+}; // reduceall_t
+
+#define reduceall(it, tmp, iterator, reducer, ...)                             \
+  reduceall_t{iterator, reducer, __VA_ARGS__} + [=](auto it, auto & tmp)
+
+/*!
+  Reducers with the semantics of the Kokkos reducers of the same names: a
+  reducer refers to the variable that receives the result, and provides
+  the identity and the join operation of the reduction.
+ */
+
+namespace reducer {
+
+template<typename TYPE>
+struct reducer_base_u {
+
+  using value_type = TYPE;
+
+  reducer_base_u(value_type & value) : value_(&value) {}
+
+  value_type & reference() const {
+    return *value_;
+  }
+
+private:
+  value_type * value_;
+
+}; // struct reducer_base_u
+
+template<typename TYPE>
+struct sum : reducer_base_u<TYPE> {
+  using reducer_base_u<TYPE>::reducer_base_u;
+  static void init(TYPE & v) {
+    v = TYPE(0);
+  }
+  static void join(TYPE & v, const TYPE & w) {
+    v += w;
+  }
+}; // struct sum
+
+template<typename TYPE>
+struct prod : reducer_base_u<TYPE> {
+  using reducer_base_u<TYPE>::reducer_base_u;
+  static void init(TYPE & v) {
+    v = TYPE(1);
+  }
+  static void join(TYPE & v, const TYPE & w) {
+    v *= w;
+  }
+}; // struct prod
+
+template<typename TYPE>
+struct max : reducer_base_u<TYPE> {
+  using reducer_base_u<TYPE>::reducer_base_u;
+  static void init(TYPE & v) {
+    v = std::numeric_limits<TYPE>::lowest();
+  }
+  static void join(TYPE & v, const TYPE & w) {
+    if(w > v)
+      v = w;
+  }
+}; // struct max
+
+template<typename TYPE>
+struct min : reducer_base_u<TYPE> {
+  using reducer_base_u<TYPE>::reducer_base_u;
+  static void init(TYPE & v) {
+    v = std::numeric_limits<TYPE>::max();
+  }
+  static void join(TYPE & v, const TYPE & w) {
+    if(w < v)
+      v = w;
+  }
+}; // struct min
+
+template<typename TYPE>
+struct land : reducer_base_u<TYPE> {
+  using reducer_base_u<TYPE>::reducer_base_u;
+  static void init(TYPE & v) {
+    v = TYPE(1);
+  }
+  static void join(TYPE & v, const TYPE & w) {
+    v = v && w;
+  }
+}; // struct land
+
+template<typename TYPE>
+struct lor : reducer_base_u<TYPE> {
+  using reducer_base_u<TYPE>::reducer_base_u;
+  static void init(TYPE & v) {
+    v = TYPE(0);
+  }
+  static void join(TYPE & v, const TYPE & w) {
+    v = v || w;
+  }
+}; // struct lor
+
+template<typename TYPE>
+struct band : reducer_base_u<TYPE> {
+  using reducer_base_u<TYPE>::reducer_base_u;
+  static void init(TYPE & v) {
+    v = ~TYPE(0);
+  }
+  static void join(TYPE & v, const TYPE & w) {
+    v &= w;
+  }
+}; // struct band
+
+template<typename TYPE>
+struct bor : reducer_base_u<TYPE> {
+  using reducer_base_u<TYPE>::reducer_base_u;
+  static void init(TYPE & v) {
+    v = TYPE(0);
+  }
+  static void join(TYPE & v, const TYPE & w) {
+    v |= w;
+  }
+}; // struct bor
+
+} // namespace reducer
+} // namespace flecsi
+
+#endif // FLECSI_ENABLE_KOKKOS
 
 namespace flecsi {
 
@@ -721,29 +721,26 @@ setup_rank_context_task(const Legion::Task * task,
                  is.second.ghost.size();
 
     auto & _map = context_.new_index_map(is.first);
-    auto & _rev_map = context_.new_reverse_index_map(is.first);
 
     _map.resize(nents);
     size_t counter(0);
 
     for(auto index : is.second.exclusive) {
-      _rev_map[index.id] = counter;
       _map[counter] = index.id;
       counter++;
     } // for
 
     for(auto index : is.second.shared) {
-      _rev_map[index.id] = counter;
       _map[counter] = index.id;
       counter++;
     } // for
 
     for(auto index : is.second.ghost) {
-      _rev_map[index.id] = counter;
       _map[counter] = index.id;
       counter++;
     } // for
 
+    context_.build_reverse_index_map(is.first);
   } // for coloring_map
 
   //////////////////////////////////////////////////////////////////////////////
@@ -753,9 +750,6 @@ setup_rank_context_task(const Legion::Task * task,
   for(auto is : context_.coloring_map()) {
     size_t index_space = is.first;
 
-    auto & _cis_to_gis = context_.cis_to_gis_map(index_space);
-    auto & _gis_to_cis = context_.gis_to_cis_map(index_space);
-
     auto & _color_map = context_.coloring_info(index_space);
 
     std::vector<size_t> _rank_offsets(context_.colors() + 1, 0);
@@ -768,27 +762,29 @@ setup_rank_context_task(const Legion::Task * task,
       offset += (_color_info.exclusive + _color_info.shared);
     } // for
 
-    size_t cid{0};
+    // The color ids are 0, 1, ... in exclusive, shared, ghost order.
+    std::vector<size_t> _cids, _gids;
+    _cids.reserve(is.second.exclusive.size() + is.second.shared.size() +
+                  is.second.ghost.size());
+    _gids.reserve(_cids.capacity());
+
     for(auto entity : is.second.exclusive) {
-      size_t gid = _rank_offsets[entity.rank] + entity.offset;
-      _cis_to_gis[cid] = gid;
-      _gis_to_cis[gid] = cid;
-      ++cid;
+      _cids.push_back(_cids.size());
+      _gids.push_back(_rank_offsets[entity.rank] + entity.offset);
     } // for
 
     for(auto entity : is.second.shared) {
-      size_t gid = _rank_offsets[entity.rank] + entity.offset;
-      _cis_to_gis[cid] = gid;
-      _gis_to_cis[gid] = cid;
-      ++cid;
+      _cids.push_back(_cids.size());
+      _gids.push_back(_rank_offsets[entity.rank] + entity.offset);
     } // for
     for(auto entity : is.second.ghost) {
-      size_t gid = _rank_offsets[entity.rank] + entity.offset;
-      _cis_to_gis[cid] = gid;
-      _gis_to_cis[gid] = cid;
-      ++cid;
+      _cids.push_back(_cids.size());
+      _gids.push_back(_rank_offsets[entity.rank] + entity.offset);
     } // for
 
+    context_.cis_to_gis_map(index_space).assign(_cids, _gids);
+    context_.gis_to_cis_map(index_space)
+      .assign(std::move(_gids), std::move(_cids));
   } // for
 
   //////////////////////////////////////////////////////////////////////////////
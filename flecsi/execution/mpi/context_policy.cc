@@ -14,6 +14,7 @@
 
 /*! @file */
 
+#include <flecsi/execution/kernel.h>
 #include <flecsi/execution/mpi/context_policy.h>
 
 namespace flecsi {
@@ -32,6 +33,20 @@ mpi_context_policy_t::initialize(int argc, char ** argv) {
   MPI_Comm_rank(MPI_COMM_WORLD, &color_);
   MPI_Comm_size(MPI_COMM_WORLD, &colors_);
 
+#if !defined(FLECSI_ENABLE_KOKKOS)
+  //--------------------------------------------------------------------------//
+  // Share the cores of each node among the kernels of its ranks
+  //--------------------------------------------------------------------------//
+
+  MPI_Comm node_comm;
+  MPI_Comm_split_type(
+    MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, color_, MPI_INFO_NULL, &node_comm);
+  int node_ranks;
+  MPI_Comm_size(node_comm, &node_ranks);
+  MPI_Comm_free(&node_comm);
+  kernel::set_ranks_per_node(node_ranks);
+#endif
+
   //--------------------------------------------------------------------------//
   // Add pre-defined MPI ops to reduction map
   //--------------------------------------------------------------------------//
@@ -15,6 +15,8 @@
 
 /*! @file */
 
+#include <algorithm>
+#include <cstring>
 #include <functional>
 #include <istream>
 #include <map>
@@ -40,8 +42,10 @@
 #include <flecsi/execution/common/launch.h>
 #include <flecsi/execution/common/processor.h>
 #include <flecsi/execution/mpi/future.h>
+#include <flecsi/execution/mpi/ghost_plan.h>
 #include <flecsi/execution/mpi/runtime_driver.h>
 #include <flecsi/runtime/types.h>
+#include <flecsi/utils/aligned_allocator.h>
 #include <flecsi/utils/common.h>
 #include <flecsi/utils/mpi_type_traits.h>
 
@@ -106,9 +110,87 @@ struct mpi_context_policy_t {
         serdez->deserialize(row_ptr, is);
         row_ptr += sizeof(data::row_vector_u<uint8_t>);
       }
+      compacted = false;
       return is;
     }
 
+    /*!
+      Move the entries of all rows into one contiguous buffer (values),
+      indexed by a CSR offsets array, and point the rows at their slice of
+      this buffer. This is called after the rows have been mutated or
+      resized, so that accessors and ghost copies work on contiguous
+      memory instead of per-row heap allocations. Nothing is copied if
+      every row is still in its slice of the buffer, with its size.
+     */
+    template<typename T>
+    void compact() {
+      using vector_t = data::row_vector_u<T>;
+      auto * r = reinterpret_cast<vector_t *>(rows.data());
+
+      if(changed_rows<T>() == 0) {
+        compacted = true;
+        return;
+      } // if
+
+      std::vector<size_t> new_offsets(num_total + 1);
+      new_offsets[0] = 0;
+      for(size_t i = 0; i < num_total; ++i)
+        new_offsets[i + 1] = new_offsets[i] + r[i].size();
+
+      std::vector<uint8_t> new_values(new_offsets[num_total] * sizeof(T));
+      auto * v = reinterpret_cast<T *>(new_values.data());
+      for(size_t i = 0; i < num_total; ++i) {
+        std::copy(r[i].begin(), r[i].end(), v + new_offsets[i]);
+        r[i].attach(v + new_offsets[i], r[i].size(), r[i].size());
+      } // for
+
+      values.swap(new_values);
+      offsets.swap(new_offsets);
+      compacted = true;
+    } // compact
+
+    /*!
+      Return the number of rows that have left their slice of the values
+      buffer, or whose size has changed, since the last compaction. All
+      rows are counted if the field was never compacted.
+     */
+    template<typename T>
+    size_t changed_rows() const {
+      using vector_t = data::row_vector_u<T>;
+      auto * r = reinterpret_cast<const vector_t *>(rows.data());
+
+      if(offsets.size() != num_total + 1)
+        return num_total;
+
+      auto * v = reinterpret_cast<const T *>(values.data());
+      size_t changed = 0;
+      for(size_t i = 0; i < num_total; ++i) {
+        if(r[i].data() != v + offsets[i] ||
+           r[i].size() != offsets[i + 1] - offsets[i])
+          ++changed;
+      } // for
+      return changed;
+    } // changed_rows
+
+    /*!
+      Apply a function to the entries of rows [first, first + n). The
+      function is passed a pointer to the entries and their size in bytes.
+      If the field is compacted, the rows are stored back to back and the
+      function is called once for the whole range.
+     */
+    template<typename FUNCTION>
+    void for_each_row_range(size_t first, size_t n, FUNCTION && f) {
+      if(compacted) {
+        f(values.data() + offsets[first] * type_size,
+          (offsets[first + n] - offsets[first]) * type_size);
+        return;
+      } // if
+
+      auto * r = reinterpret_cast<data::row_vector_u<uint8_t> *>(rows.data());
+      for(size_t i = first; i < first + n; ++i)
+        f(r[i].begin(), r[i].size() * type_size);
+    } // for_each_row_range
+
     size_t type_size;
 
     // total # of exclusive, shared, ghost entries
@@ -120,6 +202,13 @@ struct mpi_context_policy_t {
     size_t max_entries_per_index;
 
     std::vector<uint8_t> rows;
+
+    // Contiguous storage of the row entries, see compact()
+    std::vector<uint8_t> values;
+    std::vector<size_t> offsets;
+
+    // true if every row currently lives in values
+    bool compacted = false;
   }; // sparse_field_data_t
 
   /*!
@@ -245,10 +334,7 @@ struct mpi_context_policy_t {
     MPI_Win win = MPI_WIN_NULL;
 
 #if defined(FLECSI_USE_AGGCOMM)
-    std::vector<std::vector<std::array<size_t, 2>>> shared_indices;
-    std::vector<std::vector<std::array<size_t, 2>>> ghost_indices;
-    std::vector<size_t> shared_field_sizes;
-    std::vector<size_t> ghost_field_sizes;
+    size_t type_size;
     unsigned char * shared_data_buffer;
     unsigned char * ghost_data_buffer;
 #endif
@@ -273,8 +359,6 @@ struct mpi_context_policy_t {
     std::map<int, MPI_Datatype> target_types;
 
 #if defined(FLECSI_USE_AGGCOMM)
-    std::map<int, std::vector<size_t>> shared_indices;
-    std::map<int, std::vector<size_t>> ghost_indices;
     std::vector<uint32_t> ghost_row_sizes;
 #endif
 
@@ -290,6 +374,7 @@ struct mpi_context_policy_t {
    */
   template<typename T>
   void register_field_metadata(const field_id_t fid,
+    const size_t index_space,
     const coloring_info_t & coloring_info,
     const index_coloring_t & index_coloring) {
 #if !defined(FLECSI_USE_AGGCOMM)
@@ -332,62 +417,16 @@ struct mpi_context_policy_t {
     MPI_Win_create(shared_data, coloring_info.shared * sizeof(T), sizeof(T),
       MPI_INFO_NULL, MPI_COMM_WORLD, &metadata.win);
 
-    field_metadata.insert({fid, metadata});
+    new_field_state(fid).metadata =
+      &field_metadata.insert({fid, metadata}).first->second;
 #else
     field_metadata_t metadata;
-    int mpiSize;
-    MPI_Comm_size(MPI_COMM_WORLD, &mpiSize);
-
-    // FIXME: Do this per index_space instead of per field id
-
-    metadata.shared_indices.resize(mpiSize);
-    metadata.ghost_indices.resize(mpiSize);
-    metadata.ghost_field_sizes.resize(mpiSize);
-    metadata.shared_field_sizes.resize(mpiSize);
-
-    // indices are stored as vectors of pairs, each pair consisting of: starting
-    // index, how many consecutive indices
-
-    size_t ghost_cnt = 0;
-
-    for(auto const & ghost : index_coloring.ghost) {
-
-      if(metadata.ghost_indices[ghost.rank].size() == 0 ||
-         ghost_cnt * sizeof(T) !=
-           (metadata.ghost_indices[ghost.rank].back()[0] +
-             metadata.ghost_indices[ghost.rank].back()[1]))
-        metadata.ghost_indices[ghost.rank].push_back(
-          {ghost_cnt * sizeof(T), sizeof(T)});
-      else
-        metadata.ghost_indices[ghost.rank].back()[1] += sizeof(T);
-      ++ghost_cnt;
-    }
-
-    for(auto const & shared : index_coloring.shared) {
+    metadata.type_size = sizeof(T);
 
-      for(auto const & s : shared.shared) {
+    register_ghost_plan(index_space, index_coloring);
 
-        if(metadata.shared_indices[s].size() == 0 ||
-           shared.offset * sizeof(T) != (metadata.shared_indices[s].back()[0] +
-                                          metadata.shared_indices[s].back()[1]))
-
-          metadata.shared_indices[s].push_back(
-            {shared.offset * sizeof(T), sizeof(T)});
-
-        else
-
-          metadata.shared_indices[s].back()[1] += sizeof(T);
-      }
-    }
-
-    for(int rank = 0; rank < mpiSize; ++rank) {
-      for(auto const & ind : metadata.ghost_indices[rank])
-        metadata.ghost_field_sizes[rank] += ind[1];
-      for(auto const & ind : metadata.shared_indices[rank])
-        metadata.shared_field_sizes[rank] += ind[1];
-    }
-
-    field_metadata.insert({fid, metadata});
+    new_field_state(fid).metadata =
+      &field_metadata.insert({fid, metadata}).first->second;
 #endif
   }
 
@@ -398,6 +437,7 @@ struct mpi_context_policy_t {
    */
   template<typename T>
   void register_sparse_field_metadata(const field_id_t fid,
+    const size_t index_space,
     const coloring_info_t & coloring_info,
     const index_coloring_t & index_coloring) {
     sparse_field_metadata_t metadata;
@@ -408,17 +448,7 @@ struct mpi_context_policy_t {
       metadata.compact_target_lengs, metadata.compact_target_disps);
 
 #else
-    // compute ghost and shared indicies
-    size_t ghost_count = 0;
-    for(auto const & ghost : index_coloring.ghost) {
-      metadata.ghost_indices[ghost.rank].push_back(ghost_count);
-      ++ghost_count;
-    }
-    for(auto const & shared : index_coloring.shared) {
-      for(auto const & s : shared.shared) {
-        metadata.shared_indices[s].push_back(shared.offset);
-      }
-    }
+    register_ghost_plan(index_space, index_coloring);
 
     // allocate ghost_row_sizes
     metadata.ghost_row_sizes.resize(index_coloring.ghost.size());
@@ -434,7 +464,8 @@ struct mpi_context_policy_t {
         vec[i].clear();
     };
 
-    sparse_field_metadata.insert({fid, metadata});
+    new_field_state(fid).sparse_metadata =
+      &sparse_field_metadata.insert({fid, metadata}).first->second;
   }
 
   /*!
@@ -613,6 +644,152 @@ struct mpi_context_policy_t {
     return field_metadata;
   };
 
+  /*!
+   Build the ghost communication plan of an index space, unless it already
+   exists. Plans are shared by all fields on the index space, and by the
+   exchange of the mesh entities of the index space.
+   */
+  void register_ghost_plan(size_t index_space,
+    const index_coloring_t & index_coloring) {
+    if(ghost_plans_.find(index_space) == ghost_plans_.end())
+      ghost_plans_.emplace(index_space, ghost_plan_t(index_coloring));
+  } // register_ghost_plan
+
+  /*!
+   Return the ghost communication plan of an index space.
+   */
+  const ghost_plan_t & ghost_plan(size_t index_space) const {
+    return ghost_plans_.at(index_space);
+  } // ghost_plan
+
+  /*!
+   Return the persistent exchange used for the mesh entities of an index
+   space. Every index space has its own exchange, so that its requests are
+   kept across tasks even though entity types differ in size.
+   */
+  ghost_exchange_t & entity_ghost_exchange(size_t index_space) {
+    return entity_ghost_exchanges_[index_space];
+  } // entity_ghost_exchange
+
+#if defined(FLECSI_USE_AGGCOMM)
+  /*!
+   Return the persistent exchanges used for aggregated dense fields, sparse
+   field entries and sparse row sizes.
+   */
+  ghost_exchange_t & dense_ghost_exchange() {
+    return dense_ghost_exchange_;
+  } // dense_ghost_exchange
+
+  ghost_exchange_t & sparse_ghost_exchange() {
+    return sparse_ghost_exchange_;
+  } // sparse_ghost_exchange
+
+  ghost_exchange_t & rowsize_ghost_exchange() {
+    return rowsize_ghost_exchange_;
+  } // rowsize_ghost_exchange
+#endif
+
+#if !defined(FLECSI_USE_AGGCOMM)
+  /*!
+   Copy the shared entities of a dense field into the ghosts of the ranks
+   that use them, through the MPI window of the field. With split-phase
+   ghosts, the epoch is left open and ghost_is_readable is set to false;
+   it is closed by complete_ghost_exchange(). This call is collective over
+   the shared users and ghost owners of the field.
+
+   @param fid               The field id.
+   @param ghost_data        The first ghost entity of the field.
+   @param ghost_is_readable The ghost flag of the field.
+   */
+  void start_ghost_exchange(field_id_t fid,
+    void * ghost_data,
+    bool & ghost_is_readable) {
+    auto & metadata = *field_state(fid).metadata;
+    MPI_Win win = metadata.win;
+
+#if defined(FLECSI_USE_SPLIT_PHASE_GHOSTS)
+    // Only one epoch can be open on the window at a time.
+    complete_ghost_exchange(fid, ghost_is_readable);
+#endif
+
+    MPI_Win_post(metadata.shared_users_grp, 0, win);
+    MPI_Win_start(metadata.ghost_owners_grp, 0, win);
+
+    for(auto & origin_type : metadata.origin_types) {
+      const int ghost_owner = origin_type.first;
+      MPI_Get(ghost_data, 1, origin_type.second, ghost_owner, 0, 1,
+        metadata.target_types.at(ghost_owner), win);
+    } // for
+
+#if defined(FLECSI_USE_SPLIT_PHASE_GHOSTS)
+    // The epoch is closed by the prolog of the next task that touches the
+    // shared or ghost indices of this field.
+    ghost_is_readable = false;
+#else
+    MPI_Win_complete(win);
+    MPI_Win_wait(win);
+#endif
+  } // start_ghost_exchange
+#endif
+
+#if defined(FLECSI_USE_SPLIT_PHASE_GHOSTS) && !defined(FLECSI_USE_AGGCOMM)
+  /*!
+   Complete a split-phase ghost exchange that was started by the task epilog
+   for the given dense field. The exchange is pending as long as the
+   ghost_is_readable flag of the field is false. This call is collective
+   over the shared users and ghost owners of the field.
+   */
+  void complete_ghost_exchange(field_id_t fid, bool & ghost_is_readable) {
+    if(ghost_is_readable)
+      return;
+
+    MPI_Win win = field_state(fid).metadata->win;
+
+    MPI_Win_complete(win);
+    MPI_Win_wait(win);
+
+    ghost_is_readable = true;
+  } // complete_ghost_exchange
+
+  /*!
+   Complete all pending split-phase ghost exchanges. This must be called
+   before field data is accessed outside of a task, e.g., for I/O.
+   */
+  void complete_ghost_exchanges() {
+    // Maps are ordered, so every rank completes the epochs in the same order.
+    for(auto & isd : index_space_data_map_) {
+      for(auto & gr : isd.second.ghost_is_readable) {
+        if(field_metadata.find(gr.first) != field_metadata.end()) {
+          complete_ghost_exchange(gr.first, gr.second);
+        } // if
+      } // for
+    } // for
+  } // complete_ghost_exchanges
+#endif
+
+  /*!
+   The buffer type of dense field data. Buffers are aligned to
+   FLECSI_FIELD_ALIGNMENT bytes, and their pages are first touched by the
+   field first-touch function (see set_field_first_touch()).
+   */
+  using field_buffer_t =
+    std::vector<uint8_t, utils::aligned_allocator_u<uint8_t>>;
+
+  /*!
+   A function that zero-initializes new field data. It is the first to
+   write to the pages of the data, so it decides their NUMA placement.
+   */
+  using field_first_touch_t = std::function<void(uint8_t *, size_t)>;
+
+  /*!
+   Set the function that zero-initializes new field data, e.g., to write
+   it from the threads, and in the partition, of the loops that later
+   access it. By default, new field data is zeroed by the calling thread.
+   */
+  void set_field_first_touch(field_first_touch_t first_touch) {
+    field_first_touch_ = std::move(first_touch);
+  } // set_field_first_touch
+
   /*!
    Register new field data, i.e. allocate a new buffer for the specified field
    ID.
@@ -621,14 +798,24 @@ struct mpi_context_policy_t {
     // TODO: VERSIONS
     auto it = field_data.find(fid);
     if(it == field_data.end()) {
-      field_data.insert({fid, std::vector<uint8_t>(size)});
-    }
-    else {
-      it->second.resize(size);
+      it = field_data.emplace(fid, field_buffer_t()).first;
     }
+
+    // The allocator leaves new elements uninitialized.
+    auto & buffer = it->second;
+    const size_t old_size = std::min(buffer.size(), size);
+    buffer.resize(size);
+    if(size > old_size) {
+      if(field_first_touch_)
+        field_first_touch_(buffer.data() + old_size, size - old_size);
+      else
+        std::fill(buffer.begin() + old_size, buffer.end(), 0);
+    } // if
+
+    new_field_state(fid).data = &buffer;
   }
 
-  std::map<field_id_t, std::vector<uint8_t>> & registered_field_data() {
+  std::map<field_id_t, field_buffer_t> & registered_field_data() {
     return field_data;
   }
 
@@ -648,11 +835,12 @@ struct mpi_context_policy_t {
       coloring_info.shared, coloring_info.ghost, max_entries_per_index);
     auto it = sparse_field_data.find(fid);
     if(it == sparse_field_data.end()) {
-      sparse_field_data.emplace(fid, std::move(new_field));
+      it = sparse_field_data.emplace(fid, std::move(new_field)).first;
     }
     else {
       it->second = std::move(new_field);
     }
+    new_field_state(fid).sparse_data = &it->second;
   }
 
   std::map<field_id_t, sparse_field_data_t> & registered_sparse_field_data() {
@@ -664,12 +852,143 @@ struct mpi_context_policy_t {
     return sparse_field_metadata;
   };
 
+  /*!
+   The storage of a field. The data and metadata are set when they are
+   registered, and the coloring and ghost flags are resolved the first time
+   that a handle to the field is created. Handles, task prologs and task
+   epilogs index the field states by field id, instead of searching the
+   field maps for every task argument. The states point into the field
+   maps, whose entries are never erased.
+   */
+  struct field_state_t {
+    bool resolved = false;
+    const coloring_info_t * coloring_info = nullptr;
+    field_buffer_t * data = nullptr;
+    field_metadata_t * metadata = nullptr;
+    sparse_field_data_t * sparse_data = nullptr;
+    sparse_field_metadata_t * sparse_metadata = nullptr;
+    bool * ghost_is_readable = nullptr;
+    bool * ghost_was_resized = nullptr;
+    bool global_dirty = false;
+  }; // struct field_state_t
+
+  /*!
+   Resolve the state of a field. The field data and metadata must have
+   been registered.
+
+   @param fid           The field id.
+   @param index_space   The index space of the field.
+   @param coloring_info The coloring of the index space on this rank, or
+                        null for global and color fields.
+   */
+  field_state_t & resolve_field_state(field_id_t fid,
+    size_t index_space,
+    const coloring_info_t * coloring_info) {
+    auto & state = new_field_state(fid);
+    state.coloring_info = coloring_info;
+
+    if(coloring_info != nullptr) {
+      auto & isd = index_space_data_map_[index_space];
+      state.ghost_is_readable = &isd.ghost_is_readable[fid];
+      if(state.sparse_data != nullptr)
+        state.ghost_was_resized = &isd.ghost_was_resized[fid];
+    } // if
+
+    state.resolved = true;
+    return state;
+  } // resolve_field_state
+
+  bool field_state_resolved(field_id_t fid) const {
+    return fid < field_states_.size() && field_states_[fid].resolved;
+  } // field_state_resolved
+
+  /*!
+   Return the state of a registered field.
+   */
+  field_state_t & field_state(field_id_t fid) {
+    clog_assert(fid < field_states_.size(), "unregistered field: " << fid);
+    return field_states_[fid];
+  } // field_state
+
+  /*!
+   Return the state of a field, adding it if needed.
+   */
+  field_state_t & new_field_state(field_id_t fid) {
+    if(fid >= field_states_.size())
+      field_states_.resize(fid + 1);
+    return field_states_[fid];
+  } // new_field_state
+
+  /*!
+   Mark global data as written by a task. The values of rank 0 are
+   broadcast when global data is next read (see sync_global_data()), so
+   that a task that writes global data does not wait for a collective.
+   */
+  void mark_global_dirty(field_id_t fid) {
+    auto & state = field_state(fid);
+    if(!state.global_dirty) {
+      state.global_dirty = true;
+      dirty_globals_.push_back(fid);
+    } // if
+  } // mark_global_dirty
+
+  /*!
+   Broadcast the values of rank 0 of all global data that was written since
+   the last call, with a single collective. Every rank marks the same data
+   as dirty, in the same order, since tasks are launched by every rank.
+   This is called by the prolog of every task that reads global data, by
+   the global get_handle, and after the specialization top-level task.
+   */
+  void sync_global_data() {
+    if(dirty_globals_.empty())
+      return;
+
+    if(dirty_globals_.size() == 1) {
+      auto & data = *field_state(dirty_globals_.front()).data;
+      MPI_Bcast(data.data(), data.size(), MPI_BYTE, 0, MPI_COMM_WORLD);
+    }
+    else {
+      size_t bytes = 0;
+      for(auto fid : dirty_globals_) {
+        bytes += field_state(fid).data->size();
+      } // for
+      global_buffer_.resize(bytes);
+
+      uint8_t * buf = global_buffer_.data();
+      for(auto fid : dirty_globals_) {
+        const auto & data = *field_state(fid).data;
+        std::memcpy(buf, data.data(), data.size());
+        buf += data.size();
+      } // for
+
+      MPI_Bcast(global_buffer_.data(), bytes, MPI_BYTE, 0, MPI_COMM_WORLD);
+
+      buf = global_buffer_.data();
+      for(auto fid : dirty_globals_) {
+        auto & data = *field_state(fid).data;
+        std::memcpy(data.data(), buf, data.size());
+        buf += data.size();
+      } // for
+    } // if
+
+    for(auto fid : dirty_globals_) {
+      field_state(fid).global_dirty = false;
+    } // for
+    dirty_globals_.clear();
+  } // sync_global_data
+
   std::map<size_t, MPI_Op> & reduction_operations() {
     return reduction_ops_;
   } // reduction_types
 
   void finalize() {
+#if defined(FLECSI_USE_FUSED_REDUCTIONS)
+    reduction_batch_t::instance().finalize();
+#endif
 #if !defined(FLECSI_USE_AGGCOMM)
+#if defined(FLECSI_USE_SPLIT_PHASE_GHOSTS)
+    complete_ghost_exchanges();
+#endif
     for(auto & md : field_metadata) {
       for(auto & ty : md.second.origin_types)
         MPI_Type_free(&ty.second);
@@ -697,6 +1016,13 @@ struct mpi_context_policy_t {
 #endif
       md.second.deleter();
     }
+    for(auto & ex : entity_ghost_exchanges_)
+      ex.second.free();
+#if defined(FLECSI_USE_AGGCOMM)
+    dense_ghost_exchange_.free();
+    sparse_ghost_exchange_.free();
+    rowsize_ghost_exchange_.free();
+#endif
   }
 
   int rank;
@@ -719,7 +1045,8 @@ struct mpi_context_policy_t {
   //    task_info_t
   //  > task_registry_;
 
-  std::map<field_id_t, std::vector<uint8_t>> field_data;
+  std::map<field_id_t, field_buffer_t> field_data;
+  field_first_touch_t field_first_touch_;
   std::map<field_id_t, field_metadata_t> field_metadata;
 
   std::map<size_t, index_space_data_t> index_space_data_map_;
@@ -728,8 +1055,24 @@ struct mpi_context_policy_t {
   std::map<field_id_t, sparse_field_data_t> sparse_field_data;
   std::map<field_id_t, sparse_field_metadata_t> sparse_field_metadata;
 
+  // key: field id
+  std::vector<field_state_t> field_states_;
+
+  // Global data written since the last broadcast, in the order of writes.
+  std::vector<field_id_t> dirty_globals_;
+  std::vector<uint8_t> global_buffer_;
+
   std::map<size_t, MPI_Op> reduction_ops_;
 
+  std::map<size_t, ghost_plan_t> ghost_plans_;
+  std::map<size_t, ghost_exchange_t> entity_ghost_exchanges_;
+
+#if defined(FLECSI_USE_AGGCOMM)
+  ghost_exchange_t dense_ghost_exchange_;
+  ghost_exchange_t sparse_ghost_exchange_;
+  ghost_exchange_t rowsize_ghost_exchange_;
+#endif
+
 }; // class mpi_context_policy_t
 
 } // namespace execution
@@ -52,11 +52,11 @@ struct finalize_handles_t
 #if !defined(FLECSI_USE_AGGCOMM)
     auto & context = context_t::instance();
     const int my_color = context.color();
-    auto & my_coloring_info = context.coloring_info(h.index_space).at(my_color);
-    auto index_coloring = context.coloring(h.index_space);
+    auto & state = context.field_state(h.fid);
+    auto & my_coloring_info = *state.coloring_info;
+    const auto & index_coloring = context.coloring(h.index_space);
 
-    auto & sparse_field_metadata =
-      context.registered_sparse_field_metadata().at(h.fid);
+    auto & sparse_field_metadata = *state.sparse_metadata;
 
     value_t * shared_data =
       new value_t[h.num_shared() * h.max_entries_per_index];
@@ -166,6 +166,11 @@ struct finalize_handles_t
     *h.ghost_is_readable = false;
     *h.ghost_was_resized = true;
 #endif
+
+    // move the mutated rows back into contiguous storage
+    context_t::instance()
+      .field_state(h.fid)
+      .sparse_data->template compact<value_t>();
   } // handle
 
   template<typename T>
@@ -14,6 +14,9 @@
 #pragma once
 
 /*! @file */
+#include <flecsi-config.h>
+
+#include "flecsi/execution/mpi/reduction_batch.h"
 #include "flecsi/utils/mpi_type_traits.h"
 #include "flecsi/utils/type_traits.h"
 
@@ -41,6 +44,12 @@ struct mpi_future_u {
     wait() method
    */
   void wait() const {
+#if defined(FLECSI_USE_FUSED_REDUCTIONS)
+    if(epoch_) {
+      reduction_batch_t::instance().complete(epoch_);
+      epoch_ = 0;
+    }
+#endif
     if(request_) {
       MPI_Status status;
       MPI_Wait(request_.get(), &status);
@@ -66,6 +75,20 @@ struct mpi_future_u {
   }
 
   void reduce(MPI_Op op) {
+#if defined(FLECSI_USE_FUSED_REDUCTIONS)
+    // Queue the reduction; it is completed with the other pending ones.
+    if constexpr(utils::is_container_v<result_t>) {
+      using value_t = typename result_t::value_type;
+      auto datatype = flecsi::utils::mpi_typetraits_u<value_t>::type();
+      epoch_ = reduction_batch_t::instance().add(
+        result_, result_->data(), result_->size(), datatype, op);
+    }
+    else {
+      auto datatype = flecsi::utils::mpi_typetraits_u<result_t>::type();
+      epoch_ = reduction_batch_t::instance().add(
+        result_, result_.get(), 1, datatype, op);
+    }
+#else
     local_result_ = std::make_shared<result_t>(*result_);
     request_ = std::make_shared<MPI_Request>();
     if constexpr(utils::is_container_v<result_t>) {
@@ -79,6 +102,7 @@ struct mpi_future_u {
       MPI_Iallreduce(local_result_.get(), result_.get(), 1, datatype, op,
         MPI_COMM_WORLD, request_.get());
     }
+#endif
   }
 
   operator R &() {
@@ -94,6 +118,10 @@ struct mpi_future_u {
   std::shared_ptr<result_t> local_result_;
   std::shared_ptr<result_t> result_;
   mutable std::shared_ptr<MPI_Request> request_;
+#if defined(FLECSI_USE_FUSED_REDUCTIONS)
+  //! The batch of a pending fused reduction, or zero.
+  mutable size_t epoch_ = 0;
+#endif
 
 }; // struct mpi_future_u
 
@@ -0,0 +1,416 @@
+/*
+    @@@@@@@@  @@           @@@@@@   @@@@@@@@ @@
+   /@@/////  /@@          @@////@@ @@////// /@@
+   /@@       /@@  @@@@@  @@    // /@@       /@@
+   /@@@@@@@  /@@ @@///@@/@@       /@@@@@@@@@/@@
+   /@@////   /@@/@@@@@@@/@@       ////////@@/@@
+   /@@       /@@/@@//// //@@    @@       /@@/@@
+   /@@       @@@//@@@@@@ //@@@@@@  @@@@@@@@ /@@
+   //       ///  //////   //////  ////////  //
+
+   Copyright (c) 2016, Los Alamos National Security, LLC
+   All rights reserved.
+                                                                              */
+#pragma once
+
+/*! @file */
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include <cinchlog.h>
+#include <mpi.h>
+
+#include <flecsi/coloring/index_coloring.h>
+
+namespace flecsi {
+namespace execution {
+
+/*!
+ The ghost_plan_t type caches the communication pattern of the ghost
+ exchange of one index space. It is computed once per coloring and lists
+ only the neighbor ranks, together with the runs of consecutive entities
+ that are sent to (or received from) each neighbor.
+
+ Shared runs are offsets relative to the start of the shared entities,
+ ghost runs are offsets relative to the start of the ghost entities.
+
+ @ingroup mpi-execution
+ */
+
+struct ghost_plan_t {
+
+  //! A run of consecutive entities: (first entity, number of entities).
+  using run_t = std::array<size_t, 2>;
+
+  /*!
+   Construct an empty plan.
+   */
+
+  ghost_plan_t() = default;
+
+  /*!
+   Construct the plan from the coloring of an index space.
+
+   @param index_coloring The coloring of the index space for this color.
+   */
+
+  ghost_plan_t(const coloring::index_coloring_t & index_coloring) {
+    std::map<int, std::vector<run_t>> send;
+    std::map<int, std::vector<run_t>> recv;
+
+    size_t ghost_cnt = 0;
+    for(auto const & ghost : index_coloring.ghost) {
+      add_entity(recv[ghost.rank], ghost_cnt);
+      ++ghost_cnt;
+    } // for
+
+    for(auto const & shared : index_coloring.shared) {
+      for(auto const & s : shared.shared) {
+        add_entity(send[s], shared.offset);
+      } // for
+    } // for
+
+    flatten(send, send_ranks, send_offsets, send_runs, send_counts);
+    flatten(recv, recv_ranks, recv_offsets, recv_runs, recv_counts);
+  } // ghost_plan_t
+
+  /*!
+   Gather the entities sent to the i-th send rank into a packed buffer.
+
+   @param i       The index of the neighbor in send_ranks.
+   @param data    The start of the shared entities of the field.
+   @param size    The size in bytes of one entity of the field.
+   @param buffer  The packed output buffer.
+
+   @return The number of bytes written to the buffer.
+   */
+
+  size_t gather(size_t i,
+    const unsigned char * data,
+    size_t size,
+    unsigned char * buffer) const {
+    size_t bytes = 0;
+    for(size_t r = send_offsets[i]; r < send_offsets[i + 1]; ++r) {
+      const auto & run = send_runs[r];
+      std::memcpy(buffer + bytes, data + run[0] * size, run[1] * size);
+      bytes += run[1] * size;
+    } // for
+    return bytes;
+  } // gather
+
+  /*!
+   Scatter the packed entities received from the i-th receive rank into
+   the ghost entities of a field.
+
+   @param i       The index of the neighbor in recv_ranks.
+   @param buffer  The packed input buffer.
+   @param size    The size in bytes of one entity of the field.
+   @param data    The start of the ghost entities of the field.
+
+   @return The number of bytes read from the buffer.
+   */
+
+  size_t scatter(size_t i,
+    const unsigned char * buffer,
+    size_t size,
+    unsigned char * data) const {
+    size_t bytes = 0;
+    for(size_t r = recv_offsets[i]; r < recv_offsets[i + 1]; ++r) {
+      const auto & run = recv_runs[r];
+      std::memcpy(data + run[0] * size, buffer + bytes, run[1] * size);
+      bytes += run[1] * size;
+    } // for
+    return bytes;
+  } // scatter
+
+  /*!
+   Apply a function to every entity sent to the i-th send rank, in the
+   order in which they are packed.
+   */
+
+  template<typename FUNCTION>
+  void for_each_send(size_t i, FUNCTION && f) const {
+    for(size_t r = send_offsets[i]; r < send_offsets[i + 1]; ++r)
+      for(size_t e = 0; e < send_runs[r][1]; ++e)
+        f(send_runs[r][0] + e);
+  } // for_each_send
+
+  /*!
+   Apply a function to every entity received from the i-th receive rank,
+   in the order in which they are packed.
+   */
+
+  template<typename FUNCTION>
+  void for_each_recv(size_t i, FUNCTION && f) const {
+    for(size_t r = recv_offsets[i]; r < recv_offsets[i + 1]; ++r)
+      for(size_t e = 0; e < recv_runs[r][1]; ++e)
+        f(recv_runs[r][0] + e);
+  } // for_each_recv
+
+  /*!
+   Apply a function to every run (first entity, number of entities) sent
+   to the i-th send rank.
+   */
+
+  template<typename FUNCTION>
+  void for_each_send_run(size_t i, FUNCTION && f) const {
+    for(size_t r = send_offsets[i]; r < send_offsets[i + 1]; ++r)
+      f(send_runs[r][0], send_runs[r][1]);
+  } // for_each_send_run
+
+  /*!
+   Apply a function to every run (first entity, number of entities)
+   received from the i-th receive rank.
+   */
+
+  template<typename FUNCTION>
+  void for_each_recv_run(size_t i, FUNCTION && f) const {
+    for(size_t r = recv_offsets[i]; r < recv_offsets[i + 1]; ++r)
+      f(recv_runs[r][0], recv_runs[r][1]);
+  } // for_each_recv_run
+
+  //! Sorted ranks that depend on our shared entities.
+  std::vector<int> send_ranks;
+  //! CSR offsets of send_runs for each send rank.
+  std::vector<size_t> send_offsets{0};
+  //! Runs of shared entities for all send ranks.
+  std::vector<run_t> send_runs;
+  //! The number of shared entities sent to each send rank.
+  std::vector<size_t> send_counts;
+
+  //! Sorted ranks that own our ghost entities.
+  std::vector<int> recv_ranks;
+  //! CSR offsets of recv_runs for each receive rank.
+  std::vector<size_t> recv_offsets{0};
+  //! Runs of ghost entities for all receive ranks.
+  std::vector<run_t> recv_runs;
+  //! The number of ghost entities received from each receive rank.
+  std::vector<size_t> recv_counts;
+
+private:
+  static void add_entity(std::vector<run_t> & runs, size_t offset) {
+    if(runs.size() == 0 || offset != runs.back()[0] + runs.back()[1])
+      runs.push_back({offset, 1});
+    else
+      ++runs.back()[1];
+  } // add_entity
+
+  static void flatten(const std::map<int, std::vector<run_t>> & in,
+    std::vector<int> & ranks,
+    std::vector<size_t> & offsets,
+    std::vector<run_t> & runs,
+    std::vector<size_t> & counts) {
+    for(auto const & r : in) {
+      size_t count = 0;
+      for(auto const & run : r.second)
+        count += run[1];
+
+      ranks.push_back(r.first);
+      runs.insert(runs.end(), r.second.begin(), r.second.end());
+      offsets.push_back(runs.size());
+      counts.push_back(count);
+    } // for
+  } // flatten
+
+}; // struct ghost_plan_t
+
+/*!
+ The ghost_exchange_t type manages the pooled buffers and the persistent
+ MPI requests of an aggregated ghost exchange. There is one channel per
+ neighbor rank and direction. A channel keeps its buffer and its
+ persistent request between exchanges; the request is only re-initialized
+ when the message size of the channel changes, e.g., because a different
+ set of fields is exchanged.
+
+ Usage for one exchange: reset(), add the message sizes with
+ send_channel()/recv_channel(), start_recvs(), pack the send buffers,
+ start_sends(), wait_recvs(), unpack the receive buffers, wait_sends().
+
+ @ingroup mpi-execution
+ */
+
+struct ghost_exchange_t {
+
+  struct channel_t {
+    //! The number of bytes of the current message.
+    size_t bytes = 0;
+    //! The running offset used while packing or unpacking.
+    size_t offset = 0;
+    //! The pooled buffer.
+    unsigned char * buffer = nullptr;
+
+    size_t capacity_ = 0;
+    size_t request_bytes_ = 0;
+    MPI_Request request_ = MPI_REQUEST_NULL;
+  }; // struct channel_t
+
+  ghost_exchange_t() = default;
+  ghost_exchange_t(const ghost_exchange_t &) = delete;
+  ghost_exchange_t & operator=(const ghost_exchange_t &) = delete;
+
+  /*!
+   Clear the message sizes of all channels.
+   */
+
+  void reset() {
+    for(auto & c : sends_)
+      c.second.bytes = c.second.offset = 0;
+    for(auto & c : recvs_)
+      c.second.bytes = c.second.offset = 0;
+  } // reset
+
+  channel_t & send_channel(int rank) {
+    return sends_[rank];
+  } // send_channel
+
+  channel_t & recv_channel(int rank) {
+    return recvs_[rank];
+  } // recv_channel
+
+  /*!
+   Allocate the receive buffers and start the receives of all channels
+   with a non-empty message. Messages from rank r are tagged with r.
+   */
+
+  void start_recvs(int my_color) {
+    start(recvs_, my_color, false);
+  } // start_recvs
+
+  /*!
+   Start the sends of all channels with a non-empty message. The send
+   buffers must have been allocated with prepare_sends() and packed.
+   */
+
+  void start_sends(int my_color) {
+    start(sends_, my_color, true);
+  } // start_sends
+
+  /*!
+   Allocate the send buffers of all channels with a non-empty message.
+   */
+
+  void prepare_sends(int my_color) {
+    for(auto & c : sends_)
+      prepare(c.first, c.second, my_color, true);
+  } // prepare_sends
+
+  void wait_recvs() {
+    wait(recvs_);
+  } // wait_recvs
+
+  void wait_sends() {
+    wait(sends_);
+  } // wait_sends
+
+  /*!
+   Free all requests and buffers. Must be called before MPI_Finalize.
+   */
+
+  void free() {
+    release(sends_);
+    release(recvs_);
+  } // free
+
+  ~ghost_exchange_t() {
+    int finalized;
+    MPI_Finalized(&finalized);
+    if(!finalized)
+      free();
+  } // ~ghost_exchange_t
+
+private:
+  using channel_map_t = std::map<int, channel_t>;
+
+  void prepare(int rank, channel_t & c, int my_color, bool send) {
+    if(c.bytes == 0 ||
+       (c.bytes == c.request_bytes_ && c.request_ != MPI_REQUEST_NULL))
+      return;
+
+    if(c.request_ != MPI_REQUEST_NULL)
+      MPI_Request_free(&c.request_);
+
+    if(c.bytes > c.capacity_) {
+      if(c.buffer != nullptr)
+        MPI_Free_mem(c.buffer);
+
+      const int result = MPI_Alloc_mem(c.bytes, MPI_INFO_NULL, &c.buffer);
+      if(result != MPI_SUCCESS) {
+        clog_fatal("MPI failed to alloc memory on rank: "
+                   << my_color << " with error code: " << result);
+      }
+      c.capacity_ = c.bytes;
+    } // if
+
+    int result;
+    if(send)
+      result = MPI_Send_init(c.buffer, c.bytes, MPI_BYTE, rank, my_color,
+        MPI_COMM_WORLD, &c.request_);
+    else
+      result = MPI_Recv_init(c.buffer, c.bytes, MPI_BYTE, rank, rank,
+        MPI_COMM_WORLD, &c.request_);
+
+    if(result != MPI_SUCCESS) {
+      clog_fatal("MPI persistent request creation failed on rank "
+                 << my_color << " with error code: " << result);
+    }
+
+    c.request_bytes_ = c.bytes;
+  } // prepare
+
+  void start(channel_map_t & channels, int my_color, bool send) {
+    active_.clear();
+    for(auto & c : channels) {
+      if(c.second.bytes == 0)
+        continue;
+
+      prepare(c.first, c.second, my_color, send);
+      active_.push_back(c.second.request_);
+    } // for
+
+    if(active_.size() == 0)
+      return;
+
+    const int result = MPI_Startall(active_.size(), active_.data());
+    if(result != MPI_SUCCESS) {
+      clog(error) << "MPI_Startall failed on rank " << my_color
+                  << " with error code: " << result << std::endl;
+    }
+  } // start
+
+  void wait(channel_map_t & channels) {
+    // Persistent requests stay allocated after completion, so the request
+    // handles are waited on through a copy.
+    active_.clear();
+    for(auto & c : channels)
+      if(c.second.bytes != 0)
+        active_.push_back(c.second.request_);
+
+    const int result =
+      MPI_Waitall(active_.size(), active_.data(), MPI_STATUSES_IGNORE);
+    if(result != MPI_SUCCESS) {
+      clog_fatal("MPI_Waitall failed with error code: " << result);
+    }
+  } // wait
+
+  void release(channel_map_t & channels) {
+    for(auto & c : channels) {
+      if(c.second.request_ != MPI_REQUEST_NULL)
+        MPI_Request_free(&c.second.request_);
+      if(c.second.buffer != nullptr)
+        MPI_Free_mem(c.second.buffer);
+      c.second = channel_t();
+    } // for
+  } // release
+
+  channel_map_t sends_;
+  channel_map_t recvs_;
+  std::vector<MPI_Request> active_;
+
+}; // struct ghost_exchange_t
+
+} // namespace execution
+} // namespace flecsi
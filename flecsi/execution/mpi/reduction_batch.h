@@ -0,0 +1,200 @@
+/*
+    @@@@@@@@  @@           @@@@@@   @@@@@@@@ @@
+   /@@/////  /@@          @@////@@ @@////// /@@
+   /@@       /@@  @@@@@  @@    // /@@       /@@
+   /@@@@@@@  /@@ @@///@@/@@       /@@@@@@@@@/@@
+   /@@////   /@@/@@@@@@@/@@       ////////@@/@@
+   /@@       /@@/@@//// //@@    @@       /@@/@@
+   /@@       @@@//@@@@@@ //@@@@@@  @@@@@@@@ /@@
+   //       ///  //////   //////  ////////  //
+
+   Copyright (c) 2016, Los Alamos National Security, LLC
+   All rights reserved.
+                                                                              */
+#pragma once
+
+/*! @file */
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <cinchlog.h>
+#include <mpi.h>
+
+namespace flecsi {
+namespace execution {
+
+/*!
+ The reduction_batch_t type queues the reductions of task results, and
+ completes all of them with a single MPI_Allreduce when the first of their
+ futures is waited on.
+
+ The local results are packed into one buffer, which is reduced as a
+ single element of a contiguous type, so that MPI never splits it. The
+ operator of the batch applies the operator of every queued reduction to
+ its part of the buffer with MPI_Reduce_local, so that user-defined and
+ predefined operators can be mixed.
+
+ Every rank must queue the same reductions in the same order, and must
+ complete them at the same point, i.e., futures of fused reductions must be
+ waited on collectively.
+
+ @ingroup mpi-execution
+ */
+
+struct reduction_batch_t {
+
+  /*!
+   Return the batch of the calling process.
+   */
+
+  static reduction_batch_t & instance() {
+    static reduction_batch_t batch;
+    return batch;
+  } // instance
+
+  /*!
+   Queue the reduction of a local result. The result is packed, and is
+   replaced by the reduced value when the batch is completed.
+
+   @param owner    The storage of the result, which is kept alive until the
+                   batch is completed.
+   @param data     The first element of the result.
+   @param count    The number of elements of the result.
+   @param datatype The MPI type of the elements.
+   @param op       The reduction operator.
+
+   @return The epoch of the batch, to be passed to complete(). Epochs
+           start at one.
+   */
+
+  size_t add(std::shared_ptr<void> owner,
+    void * data,
+    int count,
+    MPI_Datatype datatype,
+    MPI_Op op) {
+    int type_size;
+    MPI_Type_size(datatype, &type_size);
+
+    // Keep every part aligned for the operators.
+    constexpr size_t align = alignof(std::max_align_t);
+    const size_t offset = (buffer_.size() + align - 1) / align * align;
+    const size_t bytes = size_t(count) * type_size;
+
+    buffer_.resize(offset + bytes);
+    std::memcpy(buffer_.data() + offset, data, bytes);
+    entries_.push_back(
+      {std::move(owner), data, offset, bytes, count, datatype, op});
+
+    return epoch_;
+  } // add
+
+  /*!
+   Complete the batch of an epoch, if it has not been completed yet.
+   */
+
+  void complete(size_t epoch) {
+    if(epoch == epoch_)
+      flush();
+  } // complete
+
+  /*!
+   Complete the pending reductions, if any.
+   */
+
+  void flush() {
+    if(entries_.empty())
+      return;
+
+    result_.resize(buffer_.size());
+
+    if(entries_.size() == 1) {
+      auto & e = entries_.front();
+      MPI_Allreduce(buffer_.data() + e.offset, result_.data() + e.offset,
+        e.count, e.datatype, e.op, MPI_COMM_WORLD);
+    }
+    else {
+      if(op_ == MPI_OP_NULL)
+        MPI_Op_create(apply, true, &op_);
+
+      if(buffer_.size() != type_bytes_) {
+        if(type_ != MPI_DATATYPE_NULL)
+          MPI_Type_free(&type_);
+        MPI_Type_contiguous(buffer_.size(), MPI_BYTE, &type_);
+        MPI_Type_commit(&type_);
+        type_bytes_ = buffer_.size();
+      } // if
+
+      MPI_Allreduce(
+        buffer_.data(), result_.data(), 1, type_, op_, MPI_COMM_WORLD);
+    } // if
+
+    for(auto & e : entries_) {
+      std::memcpy(e.data, result_.data() + e.offset, e.bytes);
+    } // for
+
+    entries_.clear();
+    buffer_.clear();
+    ++epoch_;
+  } // flush
+
+  /*!
+   Complete the pending reductions, and free the MPI objects of the batch.
+   */
+
+  void finalize() {
+    flush();
+
+    if(op_ != MPI_OP_NULL)
+      MPI_Op_free(&op_);
+    if(type_ != MPI_DATATYPE_NULL)
+      MPI_Type_free(&type_);
+    type_bytes_ = 0;
+  } // finalize
+
+  //! The number of pending reductions.
+  size_t size() const {
+    return entries_.size();
+  } // size
+
+private:
+  struct entry_t {
+    std::shared_ptr<void> owner;
+    void * data;
+    size_t offset;
+    size_t bytes;
+    int count;
+    MPI_Datatype datatype;
+    MPI_Op op;
+  }; // struct entry_t
+
+  /*!
+   The operator of the batch, which applies the operator of every entry to
+   its part of the buffers.
+   */
+
+  static void apply(void * in, void * inout, int * len, MPI_Datatype *) {
+    const auto & batch = instance();
+    clog_assert(*len == 1, "reduction batch was split");
+
+    for(const auto & e : batch.entries_) {
+      MPI_Reduce_local(static_cast<char *>(in) + e.offset,
+        static_cast<char *>(inout) + e.offset, e.count, e.datatype, e.op);
+    } // for
+  } // apply
+
+  std::vector<entry_t> entries_;
+  std::vector<char> buffer_;
+  std::vector<char> result_;
+  size_t epoch_ = 1;
+
+  MPI_Op op_ = MPI_OP_NULL;
+  MPI_Datatype type_ = MPI_DATATYPE_NULL;
+  size_t type_bytes_ = 0;
+
+}; // struct reduction_batch_t
+
+} // namespace execution
+} // namespace flecsi
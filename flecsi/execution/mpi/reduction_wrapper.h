@@ -17,6 +17,7 @@
 
 #include <cinchlog.h>
 
+#include <array>
 #include <type_traits>
 
 #include <flecsi/execution/context.h>
@@ -28,6 +29,16 @@ clog_register_tag(reduction_wrapper);
 namespace flecsi {
 namespace execution {
 
+/*!
+  The predefined MPI operator that implements a reduction type, if any.
+  The value is true, and op() returns the operator, for the built-in
+  reduction types on arithmetic types. Specializations follow the
+  reduction types below.
+ */
+
+template<typename TYPE>
+struct native_mpi_op_u : std::false_type {};
+
 template<size_t HASH, typename TYPE>
 struct reduction_wrapper_u {
 
@@ -44,10 +55,13 @@ struct reduction_wrapper_u {
   static void
   mpi_wrapper(void * in, void * inout, int * len, MPI_Datatype * dptr) {
 
-    lhs_t * lhs = reinterpret_cast<lhs_t *>(inout);
-    rhs_t * rhs = reinterpret_cast<rhs_t *>(in);
+    // The buffers of MPI do not overlap, and reading the length once lets
+    // the compiler vectorize the loop over the elements, e.g., of arrays.
+    lhs_t * __restrict lhs = reinterpret_cast<lhs_t *>(inout);
+    const rhs_t * __restrict rhs = reinterpret_cast<const rhs_t *>(in);
+    const size_t n = *len;
 
-    for(size_t i{0}; i < *len; ++i) {
+    for(size_t i{0}; i < n; ++i) {
       TYPE::apply(lhs[i], rhs[i]);
     } // for
   } // mpi_wrapper
@@ -73,10 +87,16 @@ struct reduction_wrapper_u {
     clog_assert(reduction_ops.find(HASH) == reduction_ops.end(),
       typeid(TYPE).name() << " has already been registered with this name");
 
-    // Create the operator and register it with the runtime
-    MPI_Op mpiop;
-    MPI_Op_create(mpi_wrapper, true, &mpiop);
-    reduction_ops[HASH] = mpiop;
+    // Use the predefined operator if there is one, so that MPI can use its
+    // optimized reductions. Otherwise, create the operator.
+    if constexpr(native_mpi_op_u<TYPE>::value) {
+      reduction_ops[HASH] = native_mpi_op_u<TYPE>::op();
+    }
+    else {
+      MPI_Op mpiop;
+      MPI_Op_create(mpi_wrapper, true, &mpiop);
+      reduction_ops[HASH] = mpiop;
+    } // if
   } // registration_callback
 
 }; // struct reduction_wrapper_u
@@ -371,5 +391,62 @@ struct product {
 }; // struct product
 
 } // namespace reduction
+
+//----------------------------------------------------------------------------//
+// Predefined MPI operators
+//----------------------------------------------------------------------------//
+
+/*!
+  True for the types on which the predefined arithmetic MPI operators are
+  defined, i.e., the C integer and floating point types, but not the
+  character and boolean types.
+ */
+
+template<typename T>
+constexpr bool is_mpi_arithmetic_v =
+  std::is_floating_point_v<T> ||
+  (std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+    !std::is_same_v<T, char> && !std::is_same_v<T, wchar_t> &&
+    !std::is_same_v<T, char16_t> && !std::is_same_v<T, char32_t>);
+
+template<typename T>
+struct native_mpi_op_u<min<T>> : std::bool_constant<is_mpi_arithmetic_v<T>> {
+  static MPI_Op op() {
+    return MPI_MIN;
+  }
+}; // struct native_mpi_op_u
+
+template<typename T>
+struct native_mpi_op_u<reduction::max<T>>
+  : std::bool_constant<is_mpi_arithmetic_v<T>> {
+  static MPI_Op op() {
+    return MPI_MAX;
+  }
+}; // struct native_mpi_op_u
+
+template<typename T>
+struct native_mpi_op_u<reduction::sum<T>>
+  : std::bool_constant<is_mpi_arithmetic_v<T>> {
+  static MPI_Op op() {
+    return MPI_SUM;
+  }
+}; // struct native_mpi_op_u
+
+//! Arrays are reduced element by element.
+template<typename T, std::size_t N>
+struct native_mpi_op_u<reduction::sum<std::array<T, N>>>
+  : std::bool_constant<is_mpi_arithmetic_v<T>> {
+  static MPI_Op op() {
+    return MPI_SUM;
+  }
+}; // struct native_mpi_op_u
+
+template<typename T>
+struct native_mpi_op_u<reduction::product<T>>
+  : std::bool_constant<is_mpi_arithmetic_v<T>> {
+  static MPI_Op op() {
+    return MPI_PROD;
+  }
+}; // struct native_mpi_op_u
 } // namespace execution
 } // namespace flecsi
@@ -97,6 +97,10 @@ runtime_driver(int argc, char ** argv) {
   annotation::end<annotation::spl_tlt_init>();
 #endif // FLECSI_ENABLE_SPECIALIZATION_TLT_INIT
 
+  // The global data written by the specialization is read-only from now on:
+  // make it the same on every rank.
+  context_.sync_global_data();
+
   remap_shared_entities();
 
   // Setup maps from mesh to compacted (local) index space and vice versa
@@ -109,32 +113,29 @@ runtime_driver(int argc, char ** argv) {
                  is.second.ghost.size();
 
     auto & _map = context_.new_index_map(is.first);
-    auto & _rev_map = context_.new_reverse_index_map(is.first);
 
     _map.resize(nents);
     size_t counter(0);
 
     for(auto index : is.second.exclusive) {
-      _rev_map[index.id] = counter;
       _map[counter] = index.id;
       counter++;
     } // for
 
     for(auto index : is.second.shared) {
-      _rev_map[index.id] = counter;
       _map[counter] = index.id;
       counter++;
     } // for
 
     for(auto index : is.second.ghost) {
-      _rev_map[index.id] = counter;
       _map[counter] = index.id;
       counter++;
     } // for
 
+    context_.build_reverse_index_map(is.first);
   } // for
 
-#if defined(FLECSI_USE_AGGCOMM)
+#if defined(FLECSI_USE_AGGCOMM) || defined(FLECSI_USE_SPLIT_PHASE_GHOSTS)
   auto & ispace_dmap = context_.index_space_data_map();
   for(const auto & fi : context_.registered_fields()) {
     auto & ispace_data = ispace_dmap[fi.index_space];
@@ -150,6 +151,8 @@ runtime_driver(int argc, char ** argv) {
     context_.top_level_driver()(argc, argv);
   }
 
+  context_.sync_global_data();
+
 #else
 
   context_.advance_state();
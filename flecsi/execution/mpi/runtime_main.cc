@@ -36,7 +36,13 @@ int
 main(int argc, char ** argv) {
 
   // Initialize the MPI runtime
+#if defined(FLECSI_USE_ASYNC_CHECKPOINT)
+  // Asynchronous checkpoints are written by a background thread
+  int provided;
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+#else
   MPI_Init(&argc, &argv);
+#endif
 
   // get the rank
   int rank{0};
@@ -94,6 +100,15 @@ main(int argc, char ** argv) {
     // Initialize the cinchlog runtime
     clog_init(tags);
 
+#if defined(FLECSI_USE_ASYNC_CHECKPOINT)
+    if(provided < MPI_THREAD_MULTIPLE) {
+      clog_rank(warn, 0) << "MPI does not support MPI_THREAD_MULTIPLE: "
+                            "asynchronous checkpoints will be written "
+                            "synchronously"
+                         << std::endl;
+    } // if
+#endif
+
     // Execute the flecsi runtime.
     result = flecsi::execution::context_t::instance().initialize(argc, argv);
     flecsi::execution::context_t::instance().finalize();
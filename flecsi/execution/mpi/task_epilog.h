@@ -91,25 +91,8 @@ struct task_epilog_t : public flecsi::utils::tuple_walker_u<task_epilog_t> {
     }
     else {
       auto & context = context_t::instance();
-      const int my_color = context.color();
-      auto & my_coloring_info =
-        context.coloring_info(h.index_space).at(my_color);
-
-      auto & field_metadata = context.registered_field_metadata().at(h.fid);
-
-      MPI_Win win = field_metadata.win;
-
-      MPI_Win_post(field_metadata.shared_users_grp, 0, win);
-      MPI_Win_start(field_metadata.ghost_owners_grp, 0, win);
-
-      for(auto ghost_owner : my_coloring_info.ghost_owners) {
-        MPI_Get(h.ghost_data, 1, field_metadata.origin_types[ghost_owner],
-          ghost_owner, 0, 1, field_metadata.target_types[ghost_owner], win);
-      }
-
-      MPI_Win_complete(win);
-      MPI_Win_wait(win);
-
+      context.start_ghost_exchange(
+        h.fid, h.ghost_data, *(h.ghost_is_readable));
     } // else
 #else
     auto & context = context_t::instance();
@@ -129,9 +112,8 @@ struct task_epilog_t : public flecsi::utils::tuple_walker_u<task_epilog_t> {
     if(PERMISSIONS == ro)
       return;
 
-    auto & context = context_t::instance();
-    const int my_color = context.color();
-    MPI_Bcast(&a.data(), sizeof(T), MPI_BYTE, 0, MPI_COMM_WORLD);
+    // The value of rank 0 is broadcast when global data is next read.
+    context_t::instance().mark_global_dirty(h.fid);
   } // handle
 
   template<typename T,
@@ -155,12 +137,11 @@ struct task_epilog_t : public flecsi::utils::tuple_walker_u<task_epilog_t> {
     else {
       auto & context = context_t::instance();
       const int my_color = context.color();
-      auto & my_coloring_info =
-        context.coloring_info(h.index_space).at(my_color);
-      auto index_coloring = context.coloring(h.index_space);
+      auto & state = context.field_state(h.fid);
+      auto & my_coloring_info = *state.coloring_info;
+      const auto & index_coloring = context.coloring(h.index_space);
 
-      auto & sparse_field_metadata =
-        context.registered_sparse_field_metadata().at(h.fid);
+      auto & sparse_field_metadata = *state.sparse_metadata;
 
       value_t * shared_data =
         new value_t[h.num_shared_ * h.max_entries_per_index];
@@ -262,6 +243,9 @@ struct task_epilog_t : public flecsi::utils::tuple_walker_u<task_epilog_t> {
           count * sizeof(value_t));
       }
 
+      // move resized ghost rows back into contiguous storage
+      state.sparse_data->template compact<value_t>();
+
       delete[] shared_data;
       delete[] ghost_data;
     } // else
@@ -309,15 +293,6 @@ struct task_epilog_t : public flecsi::utils::tuple_walker_u<task_epilog_t> {
       constexpr auto DIM = entity_type_t::dimension;
       constexpr auto DOM = entity_type_t::domain;
 
-      // mpi stats
-      int comm_size, comm_rank;
-      MPI_Comm_size(MPI_COMM_WORLD, &comm_size);
-      MPI_Comm_rank(MPI_COMM_WORLD, &comm_rank);
-
-      // loop over entities and exchange the ghost values
-      auto entity_size = sizeof(entity_type_t);
-      auto entities = h.template get_entities<DIM, DOM>();
-
       // get context information
       auto & context = context_t::instance();
       const int my_color = context.color();
@@ -326,85 +301,84 @@ struct task_epilog_t : public flecsi::utils::tuple_walker_u<task_epilog_t> {
       constexpr auto index_space = topology::find_index_space_from_dimension_u<
         std::tuple_size<entity_types_t>::value, entity_types_t, DIM,
         DOM>::find();
-      const auto & index_map = context.index_map(index_space);
 
       // get ghost/shared info
       const auto & my_coloring = context.coloring(index_space);
       const auto & my_coloring_info =
         context.coloring_info(index_space).at(my_color);
 
-      // entity offsets are relative to the start of shared
-      auto offset_start = my_coloring_info.exclusive;
-      entities += offset_start;
-
-      // allocate send and receive buffers
+      // The ids of ghost entities are local to this rank, so entities are
+      // sent without their id: only the bytes before and after it.
       using byte_t = unsigned char;
-
-      // setup send buffers
-      std::vector<size_t> sendcounts(comm_size, 0);
-      for(auto & shared : my_coloring.shared) {
-        for(auto peer : shared.shared) {
-          assert(peer != comm_rank);
-          sendcounts[peer] += entity_size;
-        }
-      }
-
-      std::vector<size_t> senddispls(comm_size + 1);
-      senddispls[0] = 0;
-      for(size_t r = 0; r < comm_size; ++r)
-        senddispls[r + 1] = senddispls[r] + sendcounts[r];
-
-      std::fill(sendcounts.begin(), sendcounts.end(), 0);
-      std::vector<byte_t> sendbuf(senddispls[comm_size], 0);
-      for(auto & shared : my_coloring.shared) {
-        auto eptr = &entities[shared.offset];
-        for(auto peer : shared.shared) {
-          auto offset = senddispls[peer] + sendcounts[peer];
-          std::memcpy(sendbuf.data() + offset, eptr, entity_size);
-          sendcounts[peer] += entity_size;
-        }
-      }
-
-      // setup recv buffers
-      std::vector<size_t> recvcounts(comm_size, 0);
-      for(auto & ghost : my_coloring.ghost)
-        recvcounts[ghost.rank] += entity_size;
-
-      std::vector<size_t> recvdispls(comm_size + 1);
-
-      recvdispls[0] = 0;
-      for(size_t r = 0; r < comm_size; ++r)
-        recvdispls[r + 1] = recvdispls[r] + recvcounts[r];
-
-      std::vector<byte_t> recvbuf(recvdispls[comm_size]);
-
-      // exchange data
-      auto ret = coloring::alltoallv(sendbuf, sendcounts, senddispls, recvbuf,
-        recvcounts, recvdispls, MPI_COMM_WORLD);
-      if(ret != MPI_SUCCESS)
-        clog_error("Error communicating vertices");
-
-      // unpack data
-      using id_t = std::decay_t<decltype(entities->global_id())>;
-      constexpr auto num_domains = T::num_domains;
-
-      size_t i{0};
-      std::fill(recvcounts.begin(), recvcounts.end(), 0);
-
-      for(auto & ghost : my_coloring.ghost) {
-        // get pointer to entity in question
-        auto offset = recvdispls[ghost.rank] + recvcounts[ghost.rank];
-        auto eptr = entities + my_coloring_info.shared + i;
-        // copy the original ids for now (GROSS)
-        auto id = eptr->global_id();
-        // overrite data
-        std::memcpy(eptr, recvbuf.data() + offset, entity_size);
-        // copy back the ids
-        eptr->set_global_id(id);
-        // bump counters
-        recvcounts[ghost.rank] += entity_size;
-        ++i;
-      }
+      using id_t = typename entity_type_t::id_t;
+      constexpr size_t entity_size = sizeof(entity_type_t);
+      constexpr size_t entity_bytes = entity_size - sizeof(id_t);
+
+      if constexpr(entity_bytes != 0) {
+        auto entities = h.template get_entities<DIM, DOM>();
+
+        // plan offsets are relative to the start of shared and ghost
+        auto shared = entities + my_coloring_info.exclusive;
+        auto ghost = shared + my_coloring_info.shared;
+
+        auto id_offset = [](const entity_type_t * e) -> size_t {
+          return reinterpret_cast<const byte_t *>(&e->global_id()) -
+                 reinterpret_cast<const byte_t *>(e);
+        };
+
+        // the exchange follows the ghost plan of the index space, which
+        // only involves the neighbor ranks
+        context.register_ghost_plan(index_space, my_coloring);
+        const auto & plan = context.ghost_plan(index_space);
+        auto & exchange = context.entity_ghost_exchange(index_space);
+
+        exchange.reset();
+        for(size_t i{0}; i < plan.recv_ranks.size(); ++i)
+          exchange.recv_channel(plan.recv_ranks[i]).bytes =
+            plan.recv_counts[i] * entity_bytes;
+
+        for(size_t i{0}; i < plan.send_ranks.size(); ++i)
+          exchange.send_channel(plan.send_ranks[i]).bytes =
+            plan.send_counts[i] * entity_bytes;
+
+        // post receives
+        exchange.start_recvs(my_color);
+
+        // pack and send data
+        exchange.prepare_sends(my_color);
+        for(size_t i{0}; i < plan.send_ranks.size(); ++i) {
+          auto & channel = exchange.send_channel(plan.send_ranks[i]);
+          plan.for_each_send(i, [&](size_t e) {
+            auto eptr = reinterpret_cast<const byte_t *>(shared + e);
+            const size_t head = id_offset(shared + e);
+            auto buffer = channel.buffer + channel.offset;
+            std::memcpy(buffer, eptr, head);
+            std::memcpy(buffer + head, eptr + head + sizeof(id_t),
+              entity_bytes - head);
+            channel.offset += entity_bytes;
+          });
+        } // for
+        exchange.start_sends(my_color);
+
+        // wait for data to arrive
+        exchange.wait_recvs();
+
+        // unpack data around the ids of the ghost entities
+        for(size_t i{0}; i < plan.recv_ranks.size(); ++i) {
+          auto & channel = exchange.recv_channel(plan.recv_ranks[i]);
+          plan.for_each_recv(i, [&](size_t e) {
+            auto eptr = reinterpret_cast<byte_t *>(ghost + e);
+            const size_t head = id_offset(ghost + e);
+            auto buffer = channel.buffer + channel.offset;
+            std::memcpy(eptr, buffer, head);
+            std::memcpy(eptr + head + sizeof(id_t), buffer + head,
+              entity_bytes - head);
+            channel.offset += entity_bytes;
+          });
+        } // for
+
+        exchange.wait_sends();
+      } // if
 
       // recursively call this function
       client_handler<I + 1>(h);
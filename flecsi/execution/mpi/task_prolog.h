@@ -15,6 +15,7 @@ All rights reserved.
 
 /*! @file */
 
+#include <cstring>
 #include <vector>
 
 #include "mpi.h"
@@ -73,12 +74,11 @@ struct task_prolog_t : public flecsi::utils::tuple_walker_u<task_prolog_t> {
     else
       *(h.ghost_is_readable) = true;
 
-    auto & field_metadata = context.registered_field_metadata().at(h.fid);
+    auto & state = context.field_state(h.fid);
+    auto & field_metadata = *state.metadata;
+    auto & my_coloring_info = *state.coloring_info;
 
-    auto & my_coloring_info =
-      context.coloring_info(h.index_space).at(context.color());
-
-    auto data = context.registered_field_data().at(h.fid).data();
+    auto data = state.data->data();
     auto shared_data = data + my_coloring_info.exclusive * sizeof(T);
     auto ghost_data = shared_data + my_coloring_info.shared * sizeof(T);
 
@@ -141,6 +141,32 @@ struct task_prolog_t : public flecsi::utils::tuple_walker_u<task_prolog_t> {
   }
 #endif
 
+#if defined(FLECSI_USE_SPLIT_PHASE_GHOSTS) && !defined(FLECSI_USE_AGGCOMM)
+  /*!
+   Complete a split-phase ghost exchange started by a previous task epilog
+   if this task reads the ghost indices, or modifies the shared or ghost
+   indices that are exposed through the RMA window. Tasks that only touch
+   exclusive indices leave the exchange in flight.
+   */
+
+  template<typename T,
+    size_t EXCLUSIVE_PERMISSIONS,
+    size_t SHARED_PERMISSIONS,
+    size_t GHOST_PERMISSIONS>
+  void handle(dense_accessor<T,
+    EXCLUSIVE_PERMISSIONS,
+    SHARED_PERMISSIONS,
+    GHOST_PERMISSIONS> & a) {
+    auto & h = a.handle;
+
+    if constexpr((GHOST_PERMISSIONS != na) || (SHARED_PERMISSIONS == rw) ||
+                 (SHARED_PERMISSIONS == wo)) {
+      context_t::instance().complete_ghost_exchange(
+        h.fid, *(h.ghost_is_readable));
+    } // if
+  } // handle
+#endif
+
   template<typename T, size_t PERMISSIONS>
   void handle(global_accessor_u<T, PERMISSIONS> & a) {
     if(a.handle.state >= SPECIALIZATION_SPMD_INIT) {
@@ -148,6 +174,9 @@ struct task_prolog_t : public flecsi::utils::tuple_walker_u<task_prolog_t> {
         "you are not allowed "
         "to modify global data in specialization_spmd_init or driver");
     }
+
+    // Broadcast all global data written by earlier tasks at once.
+    context_t::instance().sync_global_data();
   } // handle
 
   template<typename T, size_t PERMISSIONS>
@@ -361,398 +390,221 @@ struct task_prolog_t : public flecsi::utils::tuple_walker_u<task_prolog_t> {
 
 #if defined(FLECSI_USE_AGGCOMM)
   void launch_dense_exchange() {
-    auto & context = context_t::instance();
-    const int my_color = context.color();
-    const int num_colors = context.colors();
-
-    auto & ispace_dmap = context.index_space_data_map();
-
-    std::vector<int> sharedSize(num_colors, 0);
-    std::vector<int> ghostSize(num_colors, 0);
-
     auto & modified_fields = modified_dense_fields;
 
     if(modified_fields.size() == 0)
       return;
 
-    for(auto & fi : modified_fields) {
-      auto & field_metadata = context.registered_field_metadata().at(fi.second);
-
-      for(auto rank = 0; rank < num_colors; ++rank) {
-        ghostSize[rank] += field_metadata.ghost_field_sizes[rank];
-        sharedSize[rank] += field_metadata.shared_field_sizes[rank];
-      }
-    }
-
-    std::vector<unsigned char *> allSendBuffer(num_colors);
-    std::vector<unsigned char *> allRecvBuffer(num_colors);
-
-    std::vector<MPI_Request> allSendRequests(num_colors);
-    std::vector<MPI_Request> allRecvRequests(num_colors);
-
-    // Post receives
-
-    for(int rank = 0; rank < num_colors; ++rank) {
+    auto & context = context_t::instance();
+    const int my_color = context.color();
 
-      const auto & bufSize = ghostSize[rank];
+    auto & exchange = context.dense_ghost_exchange();
 
-      if(bufSize == 0) {
-        allRecvRequests[rank] = MPI_REQUEST_NULL;
-        continue;
-      }
+    // compute aggregated communication sizes from the cached plans
+    exchange.reset();
+    for(auto & fi : modified_fields) {
+      auto & plan = context.ghost_plan(fi.first);
+      auto & field_metadata = *context.field_state(fi.second).metadata;
 
-      const int resultAlloc =
-        MPI_Alloc_mem(bufSize, MPI_INFO_NULL, &allRecvBuffer[rank]);
-      if(resultAlloc != MPI_SUCCESS) {
-        clog_fatal("MPI failed to alloc memory on rank: "
-                   << my_color << " with error code: " << resultAlloc);
-      }
+      for(size_t i{0}; i < plan.recv_ranks.size(); ++i)
+        exchange.recv_channel(plan.recv_ranks[i]).bytes +=
+          plan.recv_counts[i] * field_metadata.type_size;
 
-      const int resultRecv = MPI_Irecv(allRecvBuffer[rank], bufSize, MPI_CHAR,
-        rank, rank, MPI_COMM_WORLD, &allRecvRequests[rank]);
-      if(resultRecv != MPI_SUCCESS) {
-        clog(error) << "MPI_Irecv failed on rank " << my_color
-                    << " with error code: " << resultRecv << std::endl;
-      }
+      for(size_t i{0}; i < plan.send_ranks.size(); ++i)
+        exchange.send_channel(plan.send_ranks[i]).bytes +=
+          plan.send_counts[i] * field_metadata.type_size;
     }
 
-    // pack and send data
-
-    for(int rank = 0; rank < num_colors; ++rank) {
-
-      const auto & bufSize = sharedSize[rank];
-
-      if(bufSize == 0) {
-        allSendRequests[rank] = MPI_REQUEST_NULL;
-        continue;
-      }
-
-      const int resultAlloc =
-        MPI_Alloc_mem(bufSize, MPI_INFO_NULL, &allSendBuffer[rank]);
-      if(resultAlloc != MPI_SUCCESS) {
-        clog_fatal("MPI failed to alloc memory on rank: "
-                   << my_color << " with error code: " << resultAlloc);
-      }
-
-      size_t sendBufferOffset = 0;
-
-      for(auto & fi : modified_fields) {
-        auto & field_metadata =
-          context.registered_field_metadata().at(fi.second);
-
-        for(auto const & ind : field_metadata.shared_indices[rank]) {
+    // post receives
+    exchange.start_recvs(my_color);
 
-          memcpy(&allSendBuffer[rank][sendBufferOffset],
-            &field_metadata.shared_data_buffer[ind[0]], ind[1]);
-          sendBufferOffset += ind[1];
-        }
-      }
+    // pack and send data
+    exchange.prepare_sends(my_color);
+    for(auto & fi : modified_fields) {
+      auto & plan = context.ghost_plan(fi.first);
+      auto & field_metadata = *context.field_state(fi.second).metadata;
 
-      const int resultSend = MPI_Isend(allSendBuffer[rank], bufSize, MPI_CHAR,
-        rank, my_color, MPI_COMM_WORLD, &allSendRequests[rank]);
-      if(resultSend != MPI_SUCCESS) {
-        clog(error) << "ERROR: MPI_Isend of rank " << my_color
-                    << " for data sent to " << rank
-                    << " failed with error code: " << resultSend << std::endl;
+      for(size_t i{0}; i < plan.send_ranks.size(); ++i) {
+        auto & channel = exchange.send_channel(plan.send_ranks[i]);
+        channel.offset += plan.gather(i, field_metadata.shared_data_buffer,
+          field_metadata.type_size, channel.buffer + channel.offset);
       }
     }
+    exchange.start_sends(my_color);
 
     // wait for data to arrive
-    const int result = MPI_Waitall(
-      allRecvRequests.size(), allRecvRequests.data(), MPI_STATUSES_IGNORE);
-    if(result != MPI_SUCCESS) {
-      clog_fatal("ERROR: MPI_Waitall of rank "
-                 << my_color
-                 << " on recv requests failed with error code: " << result);
-    }
+    exchange.wait_recvs();
 
     // unpack data
-    for(int rank = 0; rank < num_colors; ++rank) {
-
-      const auto & bufSize = ghostSize[rank];
-
-      if(bufSize == 0)
-        continue;
-
-      size_t recvBufferOffset = 0;
-
-      for(auto & fi : modified_fields) {
-
-        auto & field_metadata =
-          context.registered_field_metadata().at(fi.second);
-
-        for(auto const & ind : field_metadata.ghost_indices[rank]) {
+    for(auto & fi : modified_fields) {
+      auto & plan = context.ghost_plan(fi.first);
+      auto & field_metadata = *context.field_state(fi.second).metadata;
 
-          memcpy(&field_metadata.ghost_data_buffer[ind[0]],
-            &allRecvBuffer[rank][recvBufferOffset], ind[1]);
-          recvBufferOffset += ind[1];
-        }
+      for(size_t i{0}; i < plan.recv_ranks.size(); ++i) {
+        auto & channel = exchange.recv_channel(plan.recv_ranks[i]);
+        channel.offset += plan.scatter(i, channel.buffer + channel.offset,
+          field_metadata.type_size, field_metadata.ghost_data_buffer);
       }
-
-      MPI_Free_mem(allRecvBuffer[rank]);
     }
 
     // ensure all send are completed
-    MPI_Waitall(
-      allSendRequests.size(), allSendRequests.data(), MPI_STATUSES_IGNORE);
-
-    for(int rank = 0; rank < num_colors; ++rank)
-      MPI_Free_mem(allSendBuffer[rank]);
+    exchange.wait_sends();
   }
 
   void launch_sparse_exchange() {
-    auto & context = context_t::instance();
-    const int my_color = context.color();
-    const int num_colors = context.colors();
-
-    auto & ispace_dmap = context.index_space_data_map();
-
-    std::map<int, int> shared_sizes;
-    std::map<int, int> ghost_sizes;
     auto & modified_fields = modified_sparse_fields;
 
     if(modified_fields.size() == 0)
       return;
 
+    auto & context = context_t::instance();
+    const int my_color = context.color();
+
+    auto & exchange = context.sparse_ghost_exchange();
+
     // compute aggregated communication sizes
+    exchange.reset();
     for(auto & fi : modified_fields) {
-      auto & field_data = context.registered_sparse_field_data().at(fi.second);
-      auto & field_metadata =
-        context.registered_sparse_field_metadata().at(fi.second);
-
-      for(const auto & el : field_metadata.ghost_indices) {
-        for(size_t ind : el.second) {
-          auto count = field_metadata.ghost_row_sizes[ind];
-          auto gsize = ghost_sizes.find(el.first);
-          if(gsize != ghost_sizes.end())
-            gsize->second += (count * field_data.type_size);
-          else
-            ghost_sizes[el.first] = (count * field_data.type_size);
-        }
+      auto & plan = context.ghost_plan(fi.first);
+      auto & field_data = *context.field_state(fi.second).sparse_data;
+      const size_t shared_start = field_data.num_exclusive;
+      const size_t ghost_start = shared_start + field_data.num_shared;
+
+      for(size_t i{0}; i < plan.recv_ranks.size(); ++i) {
+        auto & channel = exchange.recv_channel(plan.recv_ranks[i]);
+        plan.for_each_recv_run(i, [&](size_t g, size_t n) {
+          field_data.for_each_row_range(ghost_start + g, n,
+            [&](uint8_t *, size_t bytes) { channel.bytes += bytes; });
+        });
       }
 
-      auto * rows =
-        reinterpret_cast<data::row_vector_u<uint8_t> *>(field_data.rows.data());
-      for(const auto & el : field_metadata.shared_indices) {
-        for(size_t ind : el.second) {
-          const auto & row = rows[field_data.num_exclusive + ind];
-          auto count = row.size();
-          auto ssize = shared_sizes.find(el.first);
-          if(ssize != shared_sizes.end())
-            ssize->second += (count * field_data.type_size);
-          else
-            shared_sizes[el.first] = (count * field_data.type_size);
-        }
+      for(size_t i{0}; i < plan.send_ranks.size(); ++i) {
+        auto & channel = exchange.send_channel(plan.send_ranks[i]);
+        plan.for_each_send_run(i, [&](size_t s, size_t n) {
+          field_data.for_each_row_range(shared_start + s, n,
+            [&](uint8_t *, size_t bytes) { channel.bytes += bytes; });
+        });
       }
     }
 
-    std::map<int, std::vector<uint8_t>> all_send_buf;
-    std::map<int, std::vector<uint8_t>> all_recv_buf;
-    std::vector<MPI_Request> all_send_req;
-    std::vector<MPI_Request> all_recv_req;
-
     // post recieves
-    for(const auto & el : ghost_sizes) {
-      int rank = el.first;
-      int bufsize = el.second;
-      all_recv_buf.emplace(rank, bufsize);
-      all_recv_req.push_back(MPI_REQUEST_NULL);
-      int err = MPI_Irecv(all_recv_buf[rank].data(), bufsize, MPI_BYTE, rank,
-        rank, MPI_COMM_WORLD, &all_recv_req.back());
-      if(err != MPI_SUCCESS) {
-        clog(error) << "MPI_Irecv failed on rank " << rank
-                    << " with error code: " << err << std::endl;
-      }
-    }
+    exchange.start_recvs(my_color);
 
-    // pack and send data
-    for(const auto & el : shared_sizes) {
-      int rank = el.first;
-      int bufsize = el.second;
-      all_send_buf.emplace(rank, bufsize);
-      all_send_req.push_back(MPI_REQUEST_NULL);
-
-      size_t buf_offset = 0;
-      for(auto & fi : modified_fields) {
-        auto & field_metadata =
-          context.registered_sparse_field_metadata().at(fi.second);
-        auto & field_data =
-          context.registered_sparse_field_data().at(fi.second);
-        auto * rows = reinterpret_cast<data::row_vector_u<uint8_t> *>(
-          field_data.rows.data());
-        for(size_t i : field_metadata.shared_indices[rank]) {
-          int r = i + field_data.num_exclusive;
-          const auto & row = rows[r];
-          size_t count = row.size();
-          std::memcpy(&all_send_buf[rank][buf_offset], row.begin(),
-            count * field_data.type_size);
-          buf_offset += count * field_data.type_size;
-        }
-      }
-
-      int err = MPI_Isend(all_send_buf[rank].data(), bufsize, MPI_BYTE, rank,
-        my_color, MPI_COMM_WORLD, &all_send_req.back());
-      if(err != MPI_SUCCESS) {
-        clog(error) << "MPI_Isend of rank " << my_color
-                    << " with error code: " << err << std::endl;
+    // pack and send data: rows of a compacted field are stored back to back,
+    // so each run of shared entities is copied at once
+    exchange.prepare_sends(my_color);
+    for(auto & fi : modified_fields) {
+      auto & plan = context.ghost_plan(fi.first);
+      auto & field_data = *context.field_state(fi.second).sparse_data;
+      const size_t shared_start = field_data.num_exclusive;
+
+      for(size_t i{0}; i < plan.send_ranks.size(); ++i) {
+        auto & channel = exchange.send_channel(plan.send_ranks[i]);
+        plan.for_each_send_run(i, [&](size_t s, size_t n) {
+          field_data.for_each_row_range(
+            shared_start + s, n, [&](uint8_t * data, size_t bytes) {
+              std::memcpy(channel.buffer + channel.offset, data, bytes);
+              channel.offset += bytes;
+            });
+        });
       }
     }
+    exchange.start_sends(my_color);
 
     // wait for halo data
-    {
-      int err = MPI_Waitall(
-        all_recv_req.size(), all_recv_req.data(), MPI_STATUSES_IGNORE);
-      if(err != MPI_SUCCESS) {
-        clog_fatal("MPI_Waitall "
-                   << " on recv requests failed with error code: " << err);
-      }
-    }
+    exchange.wait_recvs();
 
     // unpack data
-    for(const auto & el : ghost_sizes) {
-      int rank = el.first;
-      int bufsize = el.second;
-
-      size_t buf_offset = 0;
-      for(auto & fi : modified_fields) {
-        auto & field_metadata =
-          context.registered_sparse_field_metadata().at(fi.second);
-        auto & field_data =
-          context.registered_sparse_field_data().at(fi.second);
-        auto * rows = reinterpret_cast<data::row_vector_u<uint8_t> *>(
-          field_data.rows.data());
-        for(size_t i : field_metadata.ghost_indices[rank]) {
-          int r = field_data.num_exclusive + field_data.num_shared + i;
-          auto & row = rows[r];
-          int count = field_metadata.ghost_row_sizes[i];
-          std::memcpy(row.begin(), &all_recv_buf[rank][buf_offset],
-            count * field_data.type_size);
-          buf_offset += count * field_data.type_size;
-        }
+    for(auto & fi : modified_fields) {
+      auto & plan = context.ghost_plan(fi.first);
+      auto & field_data = *context.field_state(fi.second).sparse_data;
+      const size_t ghost_start = field_data.num_exclusive + field_data.num_shared;
+
+      for(size_t i{0}; i < plan.recv_ranks.size(); ++i) {
+        auto & channel = exchange.recv_channel(plan.recv_ranks[i]);
+        plan.for_each_recv_run(i, [&](size_t g, size_t n) {
+          field_data.for_each_row_range(
+            ghost_start + g, n, [&](uint8_t * data, size_t bytes) {
+              std::memcpy(data, channel.buffer + channel.offset, bytes);
+              channel.offset += bytes;
+            });
+        });
       }
     }
 
     // wait for sends
-    MPI_Waitall(all_send_req.size(), all_send_req.data(), MPI_STATUSES_IGNORE);
+    exchange.wait_sends();
   }
 
   void launch_rowsize_exchange() {
-    auto & context = context_t::instance();
-    const int my_color = context.color();
-    const int num_colors = context.colors();
-
-    auto & ispace_dmap = context.index_space_data_map();
-
-    const MPI_Datatype count_mpi_type = utils::mpi_type<std::uint32_t>();
-
-    // maps are rank->buffer_size
-    std::map<int, int> shared_sizes;
-    std::map<int, int> ghost_sizes;
     auto & modified_fields = resized_sparse_fields;
 
     if(modified_fields.size() == 0)
       return;
 
+    auto & context = context_t::instance();
+    const int my_color = context.color();
+
+    auto & exchange = context.rowsize_ghost_exchange();
+
     // compute aggregated communication sizes
+    exchange.reset();
     for(auto & fi : modified_fields) {
-      auto & field_metadata =
-        context.registered_sparse_field_metadata().at(fi.second);
-
-      for(const auto & el : field_metadata.ghost_indices) {
-        auto gsize = ghost_sizes.find(el.first);
-        if(gsize != ghost_sizes.end())
-          gsize->second += el.second.size();
-        else
-          ghost_sizes[el.first] = el.second.size();
-      }
+      auto & plan = context.ghost_plan(fi.first);
 
-      for(const auto & el : field_metadata.shared_indices) {
-        auto ssize = shared_sizes.find(el.first);
-        if(ssize != shared_sizes.end())
-          ssize->second += el.second.size();
-        else
-          shared_sizes[el.first] = el.second.size();
-      }
-    }
+      for(size_t i{0}; i < plan.recv_ranks.size(); ++i)
+        exchange.recv_channel(plan.recv_ranks[i]).bytes +=
+          plan.recv_counts[i] * sizeof(uint32_t);
 
-    // maps are rank->buffer container
-    std::map<int, std::vector<uint32_t>> all_send_buf;
-    std::map<int, std::vector<uint32_t>> all_recv_buf;
-    std::vector<MPI_Request> all_send_req;
-    std::vector<MPI_Request> all_recv_req;
+      for(size_t i{0}; i < plan.send_ranks.size(); ++i)
+        exchange.send_channel(plan.send_ranks[i]).bytes +=
+          plan.send_counts[i] * sizeof(uint32_t);
+    }
 
     // post receives
-    for(const auto & el : ghost_sizes) {
-      int rank = el.first;
-      int bufsize = el.second;
-      all_recv_buf.emplace(rank, bufsize);
-      all_recv_req.push_back(MPI_REQUEST_NULL);
-      int err = MPI_Irecv(all_recv_buf[rank].data(), bufsize, count_mpi_type,
-        rank, rank, MPI_COMM_WORLD, &all_recv_req.back());
-      if(err != MPI_SUCCESS) {
-        clog(error) << "MPI_Irecv failed on rank " << rank
-                    << " with error code: " << err << std::endl;
-      }
-    }
+    exchange.start_recvs(my_color);
 
     // pack and send data
-    for(const auto & el : shared_sizes) {
-      int rank = el.first;
-      int bufsize = el.second;
-      all_send_buf.emplace(rank, std::vector<uint32_t>());
-      all_send_req.push_back(MPI_REQUEST_NULL);
-
-      for(auto & fi : modified_fields) {
-        auto & field_metadata =
-          context.registered_sparse_field_metadata().at(fi.second);
-        auto & field_data =
-          context.registered_sparse_field_data().at(fi.second);
-        auto * rows = reinterpret_cast<data::row_vector_u<uint8_t> *>(
-          field_data.rows.data());
-        for(size_t i : field_metadata.shared_indices[rank]) {
-          int r = i + field_data.num_exclusive;
-          const auto & row = rows[r];
-          size_t count = row.size();
-          all_send_buf[rank].push_back(count);
-        }
-      }
+    exchange.prepare_sends(my_color);
+    for(auto & fi : modified_fields) {
+      auto & plan = context.ghost_plan(fi.first);
+      auto & field_data = *context.field_state(fi.second).sparse_data;
+      auto * rows =
+        reinterpret_cast<data::row_vector_u<uint8_t> *>(field_data.rows.data());
 
-      int err = MPI_Isend(all_send_buf[rank].data(), bufsize, count_mpi_type,
-        rank, my_color, MPI_COMM_WORLD, &all_send_req.back());
-      if(err != MPI_SUCCESS) {
-        clog(error) << "MPI_Isend of rank " << my_color
-                    << " with error code: " << err << std::endl;
+      for(size_t i{0}; i < plan.send_ranks.size(); ++i) {
+        auto & channel = exchange.send_channel(plan.send_ranks[i]);
+        plan.for_each_send(i, [&](size_t s) {
+          uint32_t count = rows[field_data.num_exclusive + s].size();
+          std::memcpy(
+            channel.buffer + channel.offset, &count, sizeof(uint32_t));
+          channel.offset += sizeof(uint32_t);
+        });
       }
     }
+    exchange.start_sends(my_color);
 
     // wait for data
-    {
-      int err = MPI_Waitall(
-        all_recv_req.size(), all_recv_req.data(), MPI_STATUSES_IGNORE);
-      if(err != MPI_SUCCESS) {
-        clog_fatal("MPI_Waitall "
-                   << " on recv requests failed with error code: " << err);
-      }
-    }
+    exchange.wait_recvs();
 
     // unpack data
-    for(const auto & el : ghost_sizes) {
-      int rank = el.first;
-      int bufsize = el.second;
-
-      size_t buf_offset = 0;
-      for(auto & fi : modified_fields) {
-        auto & field_metadata =
-          context.registered_sparse_field_metadata().at(fi.second);
-        for(size_t i : field_metadata.ghost_indices[rank]) {
-          field_metadata.ghost_row_sizes[i] = all_recv_buf[rank][buf_offset];
-          buf_offset++;
-        }
+    for(auto & fi : modified_fields) {
+      auto & plan = context.ghost_plan(fi.first);
+      auto & field_metadata =
+        *context.field_state(fi.second).sparse_metadata;
+
+      for(size_t i{0}; i < plan.recv_ranks.size(); ++i) {
+        auto & channel = exchange.recv_channel(plan.recv_ranks[i]);
+        plan.for_each_recv(i, [&](size_t g) {
+          std::memcpy(&field_metadata.ghost_row_sizes[g],
+            channel.buffer + channel.offset, sizeof(uint32_t));
+          channel.offset += sizeof(uint32_t);
+        });
       }
     }
 
     // wait for sends
-    MPI_Waitall(all_send_req.size(), all_send_req.data(), MPI_STATUSES_IGNORE);
+    exchange.wait_sends();
   }
 
   struct row_resize_t : public flecsi::utils::tuple_walker_u<row_resize_t> {
@@ -841,16 +693,16 @@ struct task_prolog_t : public flecsi::utils::tuple_walker_u<task_prolog_t> {
     void update_ghost_row_sizes(HANDLE_TYPE & h) {
       auto & context = context_t::instance();
       auto & field_metadata =
-        context.registered_sparse_field_metadata().at(h.fid);
-
-      for(const auto & el : field_metadata.ghost_indices) {
-        int rank = el.first;
-        for(size_t i : field_metadata.ghost_indices[rank]) {
-          int r = h.num_exclusive_ + h.num_shared_ + i;
-          auto & row = h.rows[r];
-          row.resize(field_metadata.ghost_row_sizes[i]);
-        }
+        *context.field_state(h.fid).sparse_metadata;
+
+      for(size_t i{0}; i < field_metadata.ghost_row_sizes.size(); ++i) {
+        int r = h.num_exclusive_ + h.num_shared_ + i;
+        auto & row = h.rows[r];
+        row.resize(field_metadata.ghost_row_sizes[i]);
       }
+
+      // move grown ghost rows back into contiguous storage
+      context.field_state(h.fid).sparse_data->template compact<T>();
     }
   }; // struct row_resize_t
 
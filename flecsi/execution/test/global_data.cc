@@ -35,6 +35,13 @@ set_global_int(gint<rw> global, int value) {
   global = value;
 }
 
+// every rank writes a different value, only the one of rank 0 is kept
+void
+set_global_int_by_rank(gint<rw> global, int value) {
+  auto & context = execution::context_t::instance();
+  global = value + context.color();
+}
+
 void
 check_global_int(gint<ro> global, int value) {
   auto & context = execution::context_t::instance();
@@ -50,6 +57,7 @@ hello_world() {
 }
 
 flecsi_register_task_simple(set_global_int, loc, single);
+flecsi_register_task_simple(set_global_int_by_rank, loc, single);
 flecsi_register_task_simple(check_global_int, loc, index);
 flecsi_register_task_simple(hello_world, loc, index);
 
@@ -68,6 +76,14 @@ specialization_tlt_init(int argc, char ** argv) {
   auto gh0 = flecsi_get_global(global, int1, int, 0);
   auto gh1 = flecsi_get_global(global, int2, int, 0);
 
+#if FLECSI_RUNTIME_MODEL == FLECSI_RUNTIME_MODEL_mpi
+  // A handle obtained after a task has written global data reads the value
+  // of rank 0 outside of a task, on every rank.
+  flecsi_execute_task_simple(set_global_int_by_rank, single, gh0, 4200);
+  auto gh2 = flecsi_get_global(global, int1, int, 0);
+  ASSERT_EQ(4200, *gh2.combined_data);
+#endif
+
   // rank 0
   flecsi_execute_task_simple(set_global_int, single, gh0, 42);
 
@@ -110,6 +126,12 @@ driver(int argc, char ** argv) {
   flecsi_execute_task_simple(check_global_int, index, gh0, 42);
   flecsi_execute_task_simple(check_global_int, index, gh1, 2042);
 
+#if FLECSI_RUNTIME_MODEL == FLECSI_RUNTIME_MODEL_mpi
+  // reads outside of a task
+  ASSERT_EQ(42, *gh0.combined_data);
+  ASSERT_EQ(2042, *gh1.combined_data);
+#endif
+
   // flecsi_execute_task_simple(hello_world, index);
 
   // auto& context = execution::context_t::instance();
@@ -0,0 +1,182 @@
+/*
+    @@@@@@@@  @@           @@@@@@   @@@@@@@@ @@
+   /@@/////  /@@          @@////@@ @@////// /@@
+   /@@       /@@  @@@@@  @@    // /@@       /@@
+   /@@@@@@@  /@@ @@///@@/@@       /@@@@@@@@@/@@
+   /@@////   /@@/@@@@@@@/@@       ////////@@/@@
+   /@@       /@@/@@//// //@@    @@       /@@/@@
+   /@@       @@@//@@@@@@ //@@@@@@  @@@@@@@@ /@@
+   //       ///  //////   //////  ////////  //
+
+   Copyright (c) 2016, Los Alamos National Security, LLC
+   All rights reserved.
+                                                                              */
+
+#include <cinchtest.h>
+
+#include <flecsi/execution/kernel.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+using namespace flecsi;
+
+namespace {
+
+std::vector<size_t>
+make_ids(size_t n) {
+  std::vector<size_t> ids(n);
+  for(size_t i = 0; i < n; ++i) {
+    ids[i] = 2 * i + 1;
+  } // for
+  return ids;
+} // make_ids
+
+} // namespace
+
+//----------------------------------------------------------------------------//
+// Every entity is visited exactly once, with every schedule.
+//----------------------------------------------------------------------------//
+
+TEST(kernel, forall) {
+  const auto ids = make_ids(10007);
+
+  for(auto schedule : {schedule_t::static_chunks(),
+        schedule_t::static_chunks(64), schedule_t::dynamic_chunks(),
+        schedule_t::dynamic_chunks(17)}) {
+    std::vector<std::atomic<int>> visits(2 * ids.size() + 1);
+    auto * v = visits.data();
+
+    forall(id, ids, "visit", schedule) {
+      ++v[id];
+    }; // forall
+
+    for(size_t i = 0; i < visits.size(); ++i) {
+      ASSERT_EQ(int(i % 2), visits[i].load());
+    } // for
+  } // for
+
+  std::vector<std::atomic<int>> visits(2 * ids.size() + 1);
+  auto * v = visits.data();
+  kernel::parallel_for(ids, [=](size_t id) { ++v[id]; }, "visit");
+  for(size_t i = 0; i < visits.size(); ++i) {
+    ASSERT_EQ(int(i % 2), visits[i].load());
+  } // for
+} // TEST
+
+//----------------------------------------------------------------------------//
+// Reductions replace the value of their reference, like Kokkos reducers.
+//----------------------------------------------------------------------------//
+
+TEST(kernel, reduceall) {
+  const auto ids = make_ids(10007);
+  const size_t n = ids.size();
+
+  for(auto schedule :
+    {schedule_t::static_chunks(), schedule_t::dynamic_chunks(5)}) {
+    size_t total = 42;
+    reduceall(id, up, ids, reducer::sum<size_t>(total), "sum", schedule) {
+      up += id;
+    }; // reduceall
+    ASSERT_EQ(n * n, total);
+
+    size_t smallest = 0;
+    reduceall(id, up, ids, reducer::min<size_t>(smallest), "min", schedule) {
+      up = std::min(up, id);
+    }; // reduceall
+    ASSERT_EQ(1, smallest);
+
+    size_t largest = 0;
+    reduceall(id, up, ids, reducer::max<size_t>(largest), "max", schedule) {
+      up = std::max(up, id);
+    }; // reduceall
+    ASSERT_EQ(2 * n - 1, largest);
+  } // for
+
+  double product = 0.0;
+  kernel::parallel_reduce(ids, [](size_t, double & up) { up *= 1.001; },
+    reducer::prod<double>(product), "prod");
+  ASSERT_NEAR(std::pow(1.001, n), product, 1.0e-9 * product);
+
+  int all = 0;
+  reduceall(id, up, ids, reducer::land<int>(all), "land") {
+    up = up && (id % 2 == 1);
+  }; // reduceall
+  ASSERT_EQ(1, all);
+} // TEST
+
+//----------------------------------------------------------------------------//
+// An empty range leaves the identity of the reduction.
+//----------------------------------------------------------------------------//
+
+TEST(kernel, empty) {
+  const std::vector<size_t> ids;
+
+  forall(id, ids, "none") {
+    ASSERT_TRUE(false);
+  }; // forall
+
+  double total = 1.0;
+  reduceall(id, up, ids, reducer::sum<double>(total), "none") {
+    up += id;
+  }; // reduceall
+  ASSERT_EQ(0.0, total);
+} // TEST
+
+//----------------------------------------------------------------------------//
+// Kernels run on the pool that has been set, or on the calling thread, and
+// can be nested.
+//----------------------------------------------------------------------------//
+
+TEST(kernel, thread_pool) {
+  const auto ids = make_ids(1000);
+  const size_t n = ids.size();
+
+  thread_pool pool;
+  pool.start(3);
+
+  for(auto p : {&pool, (thread_pool *)nullptr}) {
+    kernel::set_thread_pool(p);
+
+    std::vector<size_t> totals(n);
+    auto * t = totals.data();
+    forall(i, ids, "outer") {
+      size_t total = 0;
+      reduceall(id, up, ids, reducer::sum<size_t>(total), "inner") {
+        up += id;
+      }; // reduceall
+      t[i / 2] = total;
+    }; // forall
+
+    for(auto total : totals) {
+      ASSERT_EQ(n * n, total);
+    } // for
+  } // for
+
+  kernel::set_thread_pool(kernel::detail::default_thread_pool());
+} // TEST
+
+//----------------------------------------------------------------------------//
+// The default pool is sized by FLECSI_KERNEL_THREADS if it is set, and
+// otherwise shares the cores of the node among its ranks.
+//----------------------------------------------------------------------------//
+
+TEST(kernel, default_threads) {
+  setenv("FLECSI_KERNEL_THREADS", "3", 1);
+  ASSERT_EQ(3, kernel::detail::default_kernel_threads());
+
+  // values that are not positive numbers are ignored
+  setenv("FLECSI_KERNEL_THREADS", "none", 1);
+  const size_t threads = kernel::detail::default_kernel_threads();
+  unsetenv("FLECSI_KERNEL_THREADS");
+  ASSERT_EQ(threads, kernel::detail::default_kernel_threads());
+  ASSERT_LE(1, threads);
+
+  kernel::set_ranks_per_node(2);
+  ASSERT_LE(kernel::detail::default_kernel_threads(), threads);
+  ASSERT_LE(1, kernel::detail::default_kernel_threads());
+  kernel::set_ranks_per_node(1);
+} // TEST
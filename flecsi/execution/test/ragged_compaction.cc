@@ -0,0 +1,188 @@
+/*~-------------------------------------------------------------------------~~*
+ * Copyright (c) 2014 Los Alamos National Security, LLC
+ * All rights reserved.
+ *~-------------------------------------------------------------------------~~*/
+
+///
+/// \file
+///
+
+#include <cinchtest.h>
+
+#include <flecsi/execution/execution.h>
+#include <flecsi/supplemental/mesh/test_mesh_2d.h>
+
+clog_register_tag(coloring);
+
+namespace flecsi {
+namespace execution {
+
+using test_mesh_t = flecsi::supplemental::test_mesh_2d_t;
+
+template<typename DC, size_t PS>
+using client_handle_t = data_client_handle_u<DC, PS>;
+
+//----------------------------------------------------------------------------//
+// The entries that a cell should have after a pass: the first pass inserts
+// one to three entries, the second one appends to the even cells and
+// erases the first entry of the odd ones, and the third one leaves them.
+//----------------------------------------------------------------------------//
+
+std::vector<double>
+expected(size_t gid, size_t pass) {
+  std::vector<double> entries;
+  for(size_t j = 0; j < gid % 3 + 1; ++j) {
+    entries.push_back(gid * 100 + j);
+  }
+  if(pass >= 1) {
+    if(gid % 2 == 0)
+      entries.push_back(gid * 100 + 50);
+    else if(entries.size() > 1)
+      entries.erase(entries.begin());
+  }
+  return entries;
+} // expected
+
+void
+mutate(client_handle_t<test_mesh_t, ro> mesh,
+  ragged_mutator<double> rm,
+  size_t pass) {
+  for(auto c : mesh.cells(owned)) {
+    auto gid = c->gid();
+    if(pass == 0) {
+      const auto entries = expected(gid, 0);
+      rm.resize(c, entries.size());
+      for(size_t j = 0; j < entries.size(); ++j) {
+        rm(c, j) = entries[j];
+      }
+    }
+    else if(pass == 1) {
+      if(gid % 2 == 0)
+        rm.push_back(c, gid * 100 + 50);
+      else if(gid % 3 != 0)
+        rm.erase(c, 0);
+    }
+  }
+} // mutate
+
+void
+check(client_handle_t<test_mesh_t, ro> mesh,
+  ragged_accessor<double, ro, ro, ro> rh,
+  size_t pass) {
+  for(auto c : mesh.cells()) {
+    const auto entries = expected(c->gid(), pass);
+    ASSERT_EQ(entries.size(), rh.size(c));
+    for(size_t j = 0; j < entries.size(); ++j) {
+      ASSERT_EQ(entries[j], rh(c, j));
+    }
+  }
+} // check
+
+flecsi_register_data_client(test_mesh_t, meshes, mesh1);
+
+flecsi_register_task_simple(mutate, loc, index);
+flecsi_register_task_simple(check, loc, index);
+
+flecsi_register_field(test_mesh_t,
+  hydro,
+  pressure,
+  double,
+  ragged,
+  1,
+  index_spaces::cells);
+
+//----------------------------------------------------------------------------//
+// Specialization driver.
+//----------------------------------------------------------------------------//
+
+void
+specialization_tlt_init(int argc, char ** argv) {
+  clog(info) << "In specialization top-level-task init" << std::endl;
+  supplemental::do_test_mesh_2d_coloring();
+
+  context_t::sparse_index_space_info_t isi;
+  isi.index_space = index_spaces::cells;
+  isi.max_entries_per_index = 5;
+  isi.exclusive_reserve = 8192;
+  context_t::instance().set_sparse_index_space_info(isi);
+} // specialization_tlt_init
+
+void
+specialization_spmd_init(int argc, char ** argv) {
+  auto mh = flecsi_get_client_handle(test_mesh_t, meshes, mesh1);
+  flecsi_execute_task(initialize_mesh, flecsi::supplemental, index, mh);
+} // specialization_spmd_init
+
+//----------------------------------------------------------------------------//
+// User driver.
+//----------------------------------------------------------------------------//
+
+void
+driver(int argc, char ** argv) {
+  auto ch = flecsi_get_client_handle(test_mesh_t, meshes, mesh1);
+  auto & context = execution::context_t::instance();
+
+  for(size_t pass = 0; pass < 3; ++pass) {
+    auto pm = flecsi_get_mutator(ch, hydro, pressure, double, ragged, 0, 5);
+    flecsi_execute_task_simple(mutate, index, ch, pm, pass);
+
+    // finalizing the mutator moved the rows back into contiguous storage
+    auto ph = flecsi_get_handle(ch, hydro, pressure, double, ragged, 0);
+    const auto & data = *context.field_state(ph.fid).sparse_data;
+    ASSERT_TRUE(data.compacted);
+    ASSERT_EQ(0, data.changed_rows<double>());
+    const auto * values = data.values.data();
+
+    flecsi_execute_task_simple(check, index, ch, ph, pass).wait();
+
+    // reading the field neither moves nor copies the rows
+    ASSERT_EQ(values, data.values.data());
+  } // for
+} // driver
+
+//----------------------------------------------------------------------------//
+// TEST.
+//----------------------------------------------------------------------------//
+
+TEST(ragged_compaction, row_vector) {
+  using row_t = data::row_vector_u<double>;
+
+  // all backends share the layout of the rows
+  ASSERT_EQ(16, sizeof(row_t));
+
+  double storage[4] = {1, 2, 3, 4};
+  row_t row;
+  row.push_back(0);
+  row.attach(storage, 2, 3);
+  ASSERT_TRUE(row.borrowed());
+  ASSERT_EQ(storage, row.data());
+
+  // growing within the attached storage keeps it
+  row.push_back(5);
+  ASSERT_EQ(storage, row.data());
+  ASSERT_EQ(5, storage[2]);
+
+  // growing beyond it moves the entries to the heap
+  row.push_back(6);
+  ASSERT_FALSE(row.borrowed());
+  ASSERT_NE(storage, row.data());
+  ASSERT_EQ(4, row.size());
+  ASSERT_EQ(1, row[0]);
+  ASSERT_EQ(6, row[3]);
+
+  // attaching again frees the heap entries, clearing leaves the storage
+  row.attach(storage + 1, 1, 1);
+  ASSERT_EQ(2, row[0]);
+  row.clear();
+  ASSERT_FALSE(row.borrowed());
+  ASSERT_EQ(0, row.size());
+  ASSERT_EQ(2, storage[1]);
+} // TEST
+
+} // namespace execution
+} // namespace flecsi
+
+/*~------------------------------------------------------------------------~--*
+ * Formatting options for vim.
+ * vim: set tabstop=2 shiftwidth=2 expandtab :
+ *~------------------------------------------------------------------------~--*/
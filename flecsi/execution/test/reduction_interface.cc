@@ -210,6 +210,25 @@ driver(int argc, char ** argv) {
     ASSERT_EQ(res[1], 2 * 256);
   } // scope
 
+  // Several reductions in flight, waited on in another order (these are
+  // completed together when reductions are fused).
+  {
+    auto fmin = flecsi_execute_reduction_task(
+      min_task, flecsi::execution, index, min, double, mh, vh);
+    auto fsum = flecsi_execute_reduction_task(
+      sum_task, flecsi::execution, index, sum, double, mh, vh);
+    auto fmax = flecsi_execute_reduction_task(
+      max_task, flecsi::execution, index, max, double, mh, vh);
+
+    double sum = fsum.get();
+    clog_assert(sum >= 281.6 - .001 && sum <= 281.6 + .001,
+      "incorrect sum from reduction");
+    double max = fmax.get();
+    clog_assert(max == 1.1, "incorrect max from reduction");
+    double min = fmin.get();
+    clog_assert(min == 1.1, "incorrect min from reduction");
+  } // scope
+
 } // driver
 
 } // namespace execution
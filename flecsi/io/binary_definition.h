@@ -0,0 +1,371 @@
+/*
+    @@@@@@@@  @@           @@@@@@   @@@@@@@@ @@
+   /@@/////  /@@          @@////@@ @@////// /@@
+   /@@       /@@  @@@@@  @@    // /@@       /@@
+   /@@@@@@@  /@@ @@///@@/@@       /@@@@@@@@@/@@
+   /@@////   /@@/@@@@@@@/@@       ////////@@/@@
+   /@@       /@@/@@//// //@@    @@       /@@/@@
+   /@@       @@@//@@@@@@ //@@@@@@  @@@@@@@@ /@@
+   //       ///  //////   //////  ////////  //
+
+   Copyright (c) 2016, Los Alamos National Security, LLC
+   All rights reserved.
+                                                                              */
+#pragma once
+
+/*! @file */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <flecsi/coloring/crs.h>
+#include <flecsi/topology/mesh_definition.h>
+#include <flecsi/utils/array_ref.h>
+#include <flecsi/utils/logging.h>
+
+namespace flecsi {
+namespace io {
+
+/*!
+  The header of a binary mesh definition file.
+
+  The header is followed by three arrays, each starting on an 8-byte
+  boundary:
+
+  - the coordinates of the vertices (num_vertices x dimension doubles),
+  - the CRS offsets of the cell-to-vertex connectivity (num_cells + 1
+    64-bit integers, starting at zero),
+  - the vertices of every cell (num_indices 64-bit integers).
+
+  All values are stored in the byte order of the machine that wrote the
+  file.
+ */
+
+struct binary_mesh_header_t {
+  char magic[8];
+  std::uint64_t version;
+  std::uint64_t dimension;
+  std::uint64_t num_vertices;
+  std::uint64_t num_cells;
+  std::uint64_t num_indices;
+
+  static constexpr char magic_string[8] = {
+    'F', 'L', 'E', 'C', 'S', 'I', 'M', 'B'};
+  static constexpr std::uint64_t current_version = 1;
+
+  //! The byte offset of the coordinates in the file.
+  std::uint64_t coordinates_offset() const {
+    return sizeof(binary_mesh_header_t);
+  }
+
+  //! The byte offset of the offsets of a cell in the file.
+  std::uint64_t offsets_offset(std::uint64_t cell = 0) const {
+    return coordinates_offset() +
+           num_vertices * dimension * sizeof(double) +
+           cell * sizeof(std::uint64_t);
+  }
+
+  //! The byte offset of an index of the connectivity in the file.
+  std::uint64_t indices_offset(std::uint64_t index = 0) const {
+    return offsets_offset(num_cells + 1) + index * sizeof(std::uint64_t);
+  }
+
+  //! The size of the file.
+  std::uint64_t file_size() const {
+    return indices_offset(num_indices);
+  }
+
+  bool valid() const {
+    return std::memcmp(magic, magic_string, sizeof(magic)) == 0 &&
+           version == current_version;
+  }
+}; // struct binary_mesh_header_t
+
+static_assert(sizeof(binary_mesh_header_t) == 48, "unexpected padding");
+
+// The connectivity is viewed in place as size_t.
+static_assert(sizeof(size_t) == sizeof(std::uint64_t),
+  "binary mesh definitions need a 64-bit size_t");
+
+/*!
+  A read-only memory mapping of a range of a file. The range does not need
+  to be page-aligned: the mapping starts at the enclosing page, and data()
+  points at the first byte of the range.
+ */
+
+class mapped_file_t
+{
+public:
+  mapped_file_t() = default;
+
+  /*!
+    Map a range of a file.
+
+    @param filename The file to map.
+    @param offset   The first byte of the range.
+    @param length   The length of the range, or -1 for the rest of the
+                    file.
+   */
+
+  explicit mapped_file_t(const std::string & filename,
+    size_t offset = 0,
+    size_t length = size_t(-1)) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    clog_assert(fd >= 0, "failed opening " << filename);
+
+    struct stat st;
+    clog_assert(::fstat(fd, &st) == 0, "failed reading " << filename);
+    const size_t file_size = st.st_size;
+    clog_assert(offset <= file_size, "range past the end of " << filename);
+    size_ = std::min(length, file_size - offset);
+
+    const size_t page = ::sysconf(_SC_PAGESIZE);
+    const size_t start = offset / page * page;
+    map_size_ = size_ + (offset - start);
+
+    if(map_size_ > 0) {
+      map_ = ::mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd, start);
+      clog_assert(map_ != MAP_FAILED, "failed mapping " << filename);
+      data_ = static_cast<const std::uint8_t *>(map_) + (offset - start);
+    } // if
+
+    ::close(fd);
+  } // mapped_file_t
+
+  mapped_file_t(const mapped_file_t &) = delete;
+  mapped_file_t & operator=(const mapped_file_t &) = delete;
+
+  mapped_file_t(mapped_file_t && other) noexcept {
+    *this = std::move(other);
+  }
+
+  mapped_file_t & operator=(mapped_file_t && other) noexcept {
+    std::swap(map_, other.map_);
+    std::swap(map_size_, other.map_size_);
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    return *this;
+  }
+
+  ~mapped_file_t() {
+    if(map_ != nullptr)
+      ::munmap(map_, map_size_);
+  }
+
+  const std::uint8_t * data() const {
+    return data_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  //! View the range as an array of T.
+  template<typename T>
+  utils::span<const T> as() const {
+    return {reinterpret_cast<const T *>(data_), size_ / sizeof(T)};
+  }
+
+private:
+  void * map_ = nullptr;
+  size_t map_size_ = 0;
+  const std::uint8_t * data_ = nullptr;
+  size_t size_ = 0;
+}; // class mapped_file_t
+
+/*!
+  Read the header of a binary mesh definition file.
+ */
+
+inline binary_mesh_header_t
+read_binary_mesh_header(const std::string & filename) {
+  binary_mesh_header_t header;
+  std::ifstream file(filename, std::ifstream::binary);
+  clog_assert(file.good(), "failed opening " << filename);
+  file.read(reinterpret_cast<char *>(&header), sizeof(header));
+  clog_assert(file.good() && header.valid(),
+    filename << " is not a binary mesh definition");
+  return header;
+} // read_binary_mesh_header
+
+/*!
+  A mesh definition read from a binary mesh definition file (see
+  binary_mesh_header_t) through a memory mapping.
+
+  Nothing is parsed or copied when the file is opened: the coordinates and
+  the connectivity are views of the mapped file, and the operating system
+  only reads the pages that are accessed. Use entities_crs() and
+  vertex_coordinates() to access them without copies; the mesh_definition_u
+  interface copies what it returns.
+ */
+
+template<size_t DIMENSION>
+class binary_definition_u : public topology::mesh_definition_u<DIMENSION>
+{
+public:
+  using base_t = topology::mesh_definition_u<DIMENSION>;
+  using point_t = typename base_t::point_t;
+  using connectivity_t = typename base_t::connectivity_t;
+
+  binary_definition_u(const std::string & filename)
+    : header_(read_binary_mesh_header(filename)), file_(filename) {
+    clog_assert(header_.dimension == DIMENSION,
+      filename << " has dimension " << header_.dimension);
+    clog_assert(
+      file_.size() >= header_.file_size(), filename << " is truncated");
+
+    coordinates_ = {
+      reinterpret_cast<const double *>(
+        file_.data() + header_.coordinates_offset()),
+      header_.num_vertices * DIMENSION};
+    cells_.offsets = {reinterpret_cast<const size_t *>(
+                        file_.data() + header_.offsets_offset()),
+      header_.num_cells + 1};
+    cells_.indices = {reinterpret_cast<const size_t *>(
+                        file_.data() + header_.indices_offset()),
+      header_.num_indices};
+  } // binary_definition_u
+
+  /// Copy constructor (disabled)
+  binary_definition_u(const binary_definition_u &) = delete;
+
+  /// Assignment operator (disabled)
+  binary_definition_u & operator=(const binary_definition_u &) = delete;
+
+  size_t num_entities(size_t dimension) const override {
+    if(dimension == 0)
+      return header_.num_vertices;
+    if(dimension == DIMENSION)
+      return header_.num_cells;
+    return 0;
+  } // num_entities
+
+  /*!
+    Return the vertices of a cell.
+   */
+
+  std::vector<size_t>
+  entities(size_t from_dim, size_t to_dim, size_t id) const override {
+    check_dimensions(from_dim, to_dim);
+    return utils::to_vector(cells_.at(id));
+  } // entities
+
+  /*!
+    Return the vertices of all the cells. The connectivity is copied out of
+    the file the first time this is called; prefer entities_crs().
+   */
+
+  const connectivity_t & entities(size_t from_dim,
+    size_t to_dim) const override {
+    check_dimensions(from_dim, to_dim);
+    if(connectivity_.empty() && cells_.size() > 0) {
+      connectivity_.reserve(cells_.size());
+      for(size_t c = 0; c < cells_.size(); ++c) {
+        connectivity_.push_back(utils::to_vector(cells_[c]));
+      } // for
+    } // if
+    return connectivity_;
+  } // entities
+
+  /*!
+    Return a view of the vertices of all the cells in the mapped file.
+   */
+
+  const coloring::crs_view_t & entities_crs(size_t from_dim,
+    size_t to_dim) const {
+    check_dimensions(from_dim, to_dim);
+    return cells_;
+  } // entities_crs
+
+  /*!
+    Return a view of the coordinates of a vertex in the mapped file.
+   */
+
+  utils::span<const double> vertex_coordinates(size_t vertex_id) const {
+    return coordinates_.subspan(vertex_id * DIMENSION, DIMENSION);
+  } // vertex_coordinates
+
+  point_t vertex(size_t vertex_id) const {
+    point_t v;
+    auto coords = vertex_coordinates(vertex_id);
+    for(size_t d = 0; d < DIMENSION; ++d) {
+      v[d] = coords[d];
+    } // for
+    return v;
+  } // vertex
+
+private:
+  void check_dimensions(size_t from_dim, size_t to_dim) const {
+    clog_assert(from_dim == DIMENSION, "invalid dimension " << from_dim);
+    clog_assert(to_dim == 0, "invalid dimension " << to_dim);
+  } // check_dimensions
+
+  binary_mesh_header_t header_;
+  mapped_file_t file_;
+  utils::span<const double> coordinates_;
+  coloring::crs_view_t cells_;
+  mutable connectivity_t connectivity_;
+}; // class binary_definition_u
+
+/*!
+  Write a mesh definition to a binary mesh definition file.
+
+  @tparam MESH_DEFINITION A mesh definition type that provides vertex(id),
+                          e.g., simple_definition_t.
+ */
+
+template<typename MESH_DEFINITION>
+void
+write_binary_definition(const MESH_DEFINITION & md,
+  const std::string & filename) {
+  constexpr size_t dimension = MESH_DEFINITION::dimension();
+
+  binary_mesh_header_t header;
+  std::memcpy(header.magic, binary_mesh_header_t::magic_string,
+    sizeof(header.magic));
+  header.version = binary_mesh_header_t::current_version;
+  header.dimension = dimension;
+  header.num_vertices = md.num_entities(0);
+  header.num_cells = md.num_entities(dimension);
+
+  std::vector<double> coordinates;
+  coordinates.reserve(header.num_vertices * dimension);
+  for(size_t v = 0; v < header.num_vertices; ++v) {
+    auto point = md.vertex(v);
+    for(size_t d = 0; d < dimension; ++d) {
+      coordinates.push_back(point[d]);
+    } // for
+  } // for
+
+  std::vector<std::uint64_t> offsets(1, 0), indices;
+  for(size_t c = 0; c < header.num_cells; ++c) {
+    auto vertices = md.entities(dimension, 0, c);
+    indices.insert(indices.end(), vertices.begin(), vertices.end());
+    offsets.push_back(indices.size());
+  } // for
+  header.num_indices = indices.size();
+
+  std::ofstream file(filename, std::ofstream::binary);
+  clog_assert(file.good(), "failed opening " << filename);
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char *>(coordinates.data()),
+    coordinates.size() * sizeof(double));
+  file.write(reinterpret_cast<const char *>(offsets.data()),
+    offsets.size() * sizeof(std::uint64_t));
+  file.write(reinterpret_cast<const char *>(indices.data()),
+    indices.size() * sizeof(std::uint64_t));
+  clog_assert(file.good(), "failed writing " << filename);
+} // write_binary_definition
+
+} // namespace io
+} // namespace flecsi
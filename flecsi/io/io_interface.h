@@ -24,6 +24,10 @@ struct io_interface : public IO_POLICY {
     IO_POLICY::checkpoint_all_fields(filename);
   }
 
+  auto checkpoint_all_fields_async(const std::string & filename) {
+    return IO_POLICY::checkpoint_all_fields_async(filename);
+  }
+
   void recover_fields(const std::string & filename) {
     IO_POLICY::recover_fields(filename);
   }
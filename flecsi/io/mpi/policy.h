@@ -15,10 +15,20 @@
 
 /*!  @file */
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <hdf5.h>
 #include <mpi.h>
@@ -34,8 +44,97 @@ namespace io {
 
 const auto hsize_mpi_type = utils::mpi_static_type<hsize_t>();
 
+/*!
+  The state of a checkpoint written by checkpoint_all_fields_async(): a
+  copy of the data of every field, taken when the checkpoint was
+  requested, and the thread that writes it to the file, if any.
+ */
+
+struct checkpoint_state_t {
+
+  /*!
+    The global ids of the entities owned by this rank in an index space, if
+    it has any, and its dense fields, packed one after the other. Each field
+    is padded to whole words.
+   */
+
+  struct staged_index_space_t {
+    size_t index_space;
+    bool global_ids = false;
+    std::vector<hsize_t> ids;
+    std::vector<field_id_t> fids;
+    std::vector<hsize_t> entity_sizes;
+    std::vector<hsize_t> sizes;
+    std::vector<std::uint32_t> buffer;
+  }; // struct staged_index_space_t
+
+  /*!
+    A serialized ragged or sparse field.
+   */
+
+  struct staged_field_t {
+    std::string name;
+    std::vector<std::uint32_t> buffer;
+  }; // struct staged_field_t
+
+  ~checkpoint_state_t() {
+    wait();
+  }
+
+  void wait() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(thread.joinable())
+      thread.join();
+  } // wait
+
+  std::string file_name;
+  std::vector<staged_index_space_t> index_spaces;
+  std::vector<staged_field_t> ragged_fields;
+
+  std::mutex mutex;
+  std::thread thread;
+}; // struct checkpoint_state_t
+
+/*!
+  A handle to a checkpoint written in the background.
+ */
+
+class checkpoint_handle_t
+{
+public:
+  checkpoint_handle_t() = default;
+
+  explicit checkpoint_handle_t(std::shared_ptr<checkpoint_state_t> state)
+    : state_(std::move(state)) {}
+
+  /*!
+    Block until the checkpoint has been written to the file.
+   */
+
+  void wait() {
+    if(state_)
+      state_->wait();
+  } // wait
+
+private:
+  std::shared_ptr<checkpoint_state_t> state_;
+}; // class checkpoint_handle_t
+
 struct mpi_policy_t {
 
+  using field_info_t = execution::context_t::field_info_t;
+
+  mpi_policy_t() = default;
+
+  // the policy owns its HDF5 communicator
+  mpi_policy_t(const mpi_policy_t &) = delete;
+  mpi_policy_t & operator=(const mpi_policy_t &) = delete;
+
+  ~mpi_policy_t() {
+    wait_for_checkpoint();
+    free_hdf5_comm();
+  }
+
   bool create_hdf5_file(hid_t & hdf5_file_id,
     const std::string & file_name,
     MPI_Comm mpi_hdf5_comm) {
@@ -81,7 +180,8 @@ struct mpi_policy_t {
 
   bool open_hdf5_file(hid_t & hdf5_file_id,
     const std::string & file_name,
-    MPI_Comm mpi_hdf5_comm) {
+    MPI_Comm mpi_hdf5_comm,
+    const unsigned flags = H5F_ACC_RDWR) {
     int rank;
     MPI_Comm_rank(mpi_hdf5_comm, &rank);
 
@@ -100,8 +200,7 @@ struct mpi_policy_t {
     assert(iret != -1);
 
     assert(hdf5_file_id == -1);
-    hdf5_file_id =
-      H5Fopen(file_name.c_str(), H5F_ACC_RDWR, file_access_plist_id);
+    hdf5_file_id = H5Fopen(file_name.c_str(), flags, file_access_plist_id);
     if(hdf5_file_id < 0 && rank == 0) {
       std::cout << " H5Fopen failed: " << hdf5_file_id << std::endl;
       return false;
@@ -289,7 +388,19 @@ struct mpi_policy_t {
     return true;
   }
 
+  /*!
+    Split MPI_COMM_WORLD into the communicators of the ranks that share a
+    file. The communicator is kept for the following checkpoints and
+    recoveries, and is only split again if ranks_per_file has changed.
+   */
+
   void create_hdf5_comm() {
+    if(mpi_hdf5_comm != MPI_COMM_NULL) {
+      if(hdf5_comm_ranks_per_file_ == ranks_per_file)
+        return;
+      MPI_Comm_free(&mpi_hdf5_comm);
+    } // if
+
     MPI_Comm_size(MPI_COMM_WORLD, &world_size);
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
 
@@ -304,95 +415,538 @@ struct mpi_policy_t {
 
     MPI_Comm_size(new_comm, &new_world_size);
     MPI_Comm_rank(new_comm, &new_rank);
-  }
+    hdf5_comm_ranks_per_file_ = ranks_per_file;
+  } // create_hdf5_comm
+
+  /*!
+    Free the HDF5 communicator, unless MPI has already been finalized.
+   */
+
+  void free_hdf5_comm() {
+    int finalized;
+    MPI_Finalized(&finalized);
+    if(mpi_hdf5_comm != MPI_COMM_NULL && !finalized)
+      MPI_Comm_free(&mpi_hdf5_comm);
+    mpi_hdf5_comm = MPI_COMM_NULL;
+  } // free_hdf5_comm
+
+  /*!
+    Return the number of 32-bit words needed to store a number of bytes.
+   */
+
+  static hsize_t word_count(const size_t bytes) {
+    return (bytes + sizeof(std::uint32_t) - 1) / sizeof(std::uint32_t);
+  } // word_count
+
+  /*!
+    Return the fields that are checkpointed, grouped by index space. All
+    ranks register the same fields, so they all see the same groups in the
+    same order.
+   */
+
+  std::map<size_t, std::vector<const field_info_t *>> index_space_fields() {
+    auto & context = execution::context_t::instance();
+    std::map<size_t, std::vector<const field_info_t *>> fields;
+    for(const auto & info : context.registered_fields()) {
+      switch(info.storage_class) {
+        case data::dense:
+        case data::ragged:
+        case data::sparse:
+          fields[info.index_space].push_back(&info);
+          break;
 
-  void checkpoint_field(const hid_t hdf5_file_id,
-    const std::string & field_name,
-    const void * buffer,
-    const hsize_t size) {
-    // TODO:  do these calcs only once per index space
-    hsize_t nsize = std::ceil(((double)size) / sizeof(std::uint32_t));
-    hsize_t sum_nsize;
-    MPI_Allreduce(
-      &nsize, &sum_nsize, 1, hsize_mpi_type, MPI_SUM, mpi_hdf5_comm);
-    hsize_t displ;
-    MPI_Exscan(&nsize, &displ, 1, hsize_mpi_type, MPI_SUM, mpi_hdf5_comm);
+        default:
+          // do nothing
+          break;
+      }
+    }
+    return fields;
+  } // index_space_fields
+
+  /*!
+    Split fields into the dense ones and the ragged or sparse ones, keeping
+    their order.
+   */
+
+  static void split_fields(const std::vector<const field_info_t *> & infos,
+    std::vector<const field_info_t *> & dense,
+    std::vector<const field_info_t *> & ragged) {
+    for(auto info : infos) {
+      if(info->storage_class == data::dense)
+        dense.push_back(info);
+      else
+        ragged.push_back(info);
+    }
+  } // split_fields
+
+  /*!
+    Return true if the entities of an index space have global ids, i.e., if
+    it is colored.
+   */
+
+  static bool has_global_ids(const size_t index_space) {
+    auto & context = execution::context_t::instance();
+    return context.coloring_map().count(index_space) != 0;
+  } // has_global_ids
+
+  static std::string dense_dataset_name(const size_t index_space) {
+    return "index_space_" + std::to_string(index_space);
+  } // dense_dataset_name
+
+  static std::string ids_dataset_name(const size_t index_space) {
+    return "index_space_" + std::to_string(index_space) + "_ids";
+  } // ids_dataset_name
+
+  /*!
+    Compute the layout of the dataset of an index space with a single pair
+    of scans for all its fields. The dataset is field-major: each field is
+    stored contiguously, in rank order.
+
+    @param sizes   The number of words of each field on this rank.
+    @param offsets The offset of each field in the dataset, followed by the
+                   size of the dataset.
+    @param displs  The offset of this rank within each field.
+   */
+
+  void index_space_layout(const std::vector<hsize_t> & sizes,
+    std::vector<hsize_t> & offsets,
+    std::vector<hsize_t> & displs) {
+    const int nfields = sizes.size();
+    std::vector<hsize_t> sum_sizes(nfields);
+    MPI_Allreduce(sizes.data(), sum_sizes.data(), nfields, hsize_mpi_type,
+      MPI_SUM, mpi_hdf5_comm);
+    displs.assign(nfields, 0);
+    MPI_Exscan(sizes.data(), displs.data(), nfields, hsize_mpi_type, MPI_SUM,
+      mpi_hdf5_comm);
     if(new_rank == 0)
-      displ = 0;
+      std::fill(displs.begin(), displs.end(), 0);
 
-    bool return_val = false;
+    offsets.assign(nfields + 1, 0);
+    for(int i = 0; i < nfields; ++i) {
+      offsets[i + 1] = offsets[i] + sum_sizes[i];
+    }
+  } // index_space_layout
+
+  /*!
+    Select the part of each field owned by this rank in the dataspace of an
+    index space dataset.
+   */
+
+  void select_fields(const hid_t file_dataspace_id,
+    const std::vector<hsize_t> & starts,
+    const std::vector<hsize_t> & sizes) {
+    herr_t status = H5Sselect_none(file_dataspace_id);
+    assert(status >= 0);
+    for(size_t i = 0; i < sizes.size(); ++i) {
+      if(sizes[i] == 0)
+        continue;
+      status = H5Sselect_hyperslab(file_dataspace_id, H5S_SELECT_OR,
+        &starts[i], NULL, &sizes[i], NULL);
+      assert(status >= 0);
+    }
+  } // select_fields
 
-    return_val = create_hdf5_dataset(
-      hdf5_file_id, field_name.data(), sum_nsize, mpi_hdf5_comm);
-    assert(return_val);
+  void write_attribute(const hid_t object_id,
+    const std::string & name,
+    const std::vector<hsize_t> & values) {
+    hsize_t dims[1] = {values.size()};
+    hid_t attribute_space_id = H5Screate_simple(1, dims, NULL);
+    hid_t attribute_id = H5Acreate(object_id, name.c_str(), H5T_NATIVE_HSIZE,
+      attribute_space_id, H5P_DEFAULT, H5P_DEFAULT);
 
-    return_val = write_data_to_hdf5(
-      hdf5_file_id, field_name.data(), buffer, nsize, displ, mpi_hdf5_comm);
-    assert(return_val);
-  } // checkpoint_field
+    herr_t status;
+    status = H5Awrite(attribute_id, H5T_NATIVE_HSIZE, values.data());
+    assert(status == 0);
+    status = H5Aclose(attribute_id);
+    assert(status == 0);
+    status = H5Sclose(attribute_space_id);
+    assert(status == 0);
+  } // write_attribute
 
-  void checkpoint_field_ragged(const hid_t hdf5_file_id,
-    const std::string & field_name,
+  std::vector<hsize_t> read_attribute(const hid_t object_id,
+    const std::string & name) {
+    hid_t attribute_id = H5Aopen(object_id, name.c_str(), H5P_DEFAULT);
+    assert(attribute_id >= 0);
+    hid_t attribute_space_id = H5Aget_space(attribute_id);
+    std::vector<hsize_t> values(
+      H5Sget_simple_extent_npoints(attribute_space_id));
+
+    herr_t status;
+    status = H5Aread(attribute_id, H5T_NATIVE_HSIZE, values.data());
+    assert(status == 0);
+    status = H5Sclose(attribute_space_id);
+    assert(status == 0);
+    status = H5Aclose(attribute_id);
+    assert(status == 0);
+    return values;
+  } // read_attribute
+
+  hid_t create_words_dataset(const hid_t hdf5_file_id,
+    const std::string & dataset_name,
+    const hsize_t size) {
+    hsize_t dims[1] = {size};
+    hid_t file_dataspace_id = H5Screate_simple(1, dims, NULL);
+    hid_t dataset_id = H5Dcreate2(hdf5_file_id, dataset_name.c_str(),
+      H5T_NATIVE_B32, file_dataspace_id, H5P_DEFAULT, H5P_DEFAULT,
+      H5P_DEFAULT);
+    if(dataset_id < 0 && new_rank == 0) {
+      std::cout << " H5Dcreate2 failed: " << dataset_id << std::endl;
+    }
+    assert(dataset_id >= 0);
+
+    herr_t status = H5Sclose(file_dataspace_id);
+    assert(status == 0);
+    return dataset_id;
+  } // create_words_dataset
+
+  hid_t open_dataset(const hid_t hdf5_file_id,
+    const std::string & dataset_name) {
+    hid_t dataset_id =
+      H5Dopen2(hdf5_file_id, dataset_name.c_str(), H5P_DEFAULT);
+    if(dataset_id < 0 && new_rank == 0) {
+      std::cout << " H5Dopen2 failed: " << dataset_id << std::endl;
+    }
+    assert(dataset_id >= 0);
+    return dataset_id;
+  } // open_dataset
+
+  /*!
+    Write the selected parts of a dataset of words with a single collective
+    write. The buffer holds the parts in file order.
+   */
+
+  void write_words(const hid_t dataset_id,
+    const std::vector<hsize_t> & starts,
+    const std::vector<hsize_t> & sizes,
+    const void * buffer) {
+    transfer_words(dataset_id, starts, sizes, [&](hid_t mem, hid_t file,
+                                                hid_t xfer) {
+      return H5Dwrite(dataset_id, H5T_NATIVE_B32, mem, file, xfer, buffer);
+    });
+  } // write_words
+
+  /*!
+    Read the selected parts of a dataset of words with a single collective
+    read. The parts are stored in the buffer in file order.
+   */
+
+  void read_words(const hid_t dataset_id,
+    const std::vector<hsize_t> & starts,
+    const std::vector<hsize_t> & sizes,
+    void * buffer) {
+    transfer_words(dataset_id, starts, sizes, [&](hid_t mem, hid_t file,
+                                                hid_t xfer) {
+      return H5Dread(dataset_id, H5T_NATIVE_B32, mem, file, xfer, buffer);
+    });
+  } // read_words
+
+  template<typename TRANSFER>
+  void transfer_words(const hid_t dataset_id,
+    const std::vector<hsize_t> & starts,
+    const std::vector<hsize_t> & sizes,
+    TRANSFER && transfer) {
+    hid_t file_dataspace_id = H5Dget_space(dataset_id);
+    select_fields(file_dataspace_id, starts, sizes);
+
+    hsize_t count[1] = {0};
+    for(auto size : sizes) {
+      count[0] += size;
+    }
+    hid_t mem_dataspace_id = H5Screate_simple(1, count, NULL);
+    if(count[0] == 0)
+      H5Sselect_none(mem_dataspace_id);
+
+    // Create property list for collective dataset transfer.
+    hid_t xfer_plist_id = H5Pcreate(H5P_DATASET_XFER);
+    H5Pset_dxpl_mpio(xfer_plist_id, H5FD_MPIO_COLLECTIVE);
+
+    herr_t status;
+    status = transfer(mem_dataspace_id, file_dataspace_id, xfer_plist_id);
+    assert(status == 0);
+    status = H5Pclose(xfer_plist_id);
+    assert(status == 0);
+    status = H5Sclose(mem_dataspace_id);
+    assert(status == 0);
+    status = H5Sclose(file_dataspace_id);
+    assert(status == 0);
+  } // transfer_words
+
+  /*!
+    Return the number of bytes of a dense field that are checkpointed: its
+    exclusive and shared entities if its index space is colored, since the
+    ghosts are rebuilt from their owners on restart, and all of its data
+    otherwise.
+   */
+
+  size_t owned_bytes(const field_info_t & info) {
+    auto & context = execution::context_t::instance();
+    if(has_global_ids(info.index_space))
+      return info.size * num_owned(info.index_space);
+    return context.registered_field_data().at(info.fid).size();
+  } // owned_bytes
+
+  /*!
+    Return the number of exclusive and shared entities of a colored index
+    space.
+   */
+
+  size_t num_owned(const size_t index_space) {
+    auto & context = execution::context_t::instance();
+    const auto & color_info =
+      context.coloring_info(index_space).at(context.color());
+    return color_info.exclusive + color_info.shared;
+  } // num_owned
+
+  /*!
+    Copy the global ids of the entities owned by this rank in an index space
+    and their dense fields into a single buffer.
+   */
+
+  checkpoint_state_t::staged_index_space_t stage_index_space(
+    const size_t index_space,
+    const std::vector<const field_info_t *> & infos) {
+    auto & context = execution::context_t::instance();
+    const auto & field_data = context.registered_field_data();
+
+    checkpoint_state_t::staged_index_space_t staged;
+    staged.index_space = index_space;
+
+    if(has_global_ids(index_space)) {
+      const auto & index_map = context.index_map(index_space);
+      staged.global_ids = true;
+      staged.ids.assign(
+        index_map.begin(), index_map.begin() + num_owned(index_space));
+    }
+
+    hsize_t nsize = 0;
+    std::vector<size_t> bytes;
+    for(auto info : infos) {
+      if(info->storage_class != data::dense)
+        continue;
+      staged.fids.push_back(info->fid);
+      staged.entity_sizes.push_back(info->size);
+      bytes.push_back(owned_bytes(*info));
+      staged.sizes.push_back(word_count(bytes.back()));
+      nsize += staged.sizes.back();
+    }
+
+    // the padding at the end of each field is never read back
+    staged.buffer.resize(nsize, 0);
+    std::uint32_t * buf_ptr = staged.buffer.data();
+    for(size_t i = 0; i < staged.fids.size(); ++i) {
+      std::memcpy(buf_ptr, field_data.at(staged.fids[i]).data(), bytes[i]);
+      buf_ptr += staged.sizes[i];
+    }
+
+    return staged;
+  } // stage_index_space
+
+  /*!
+    Write the global ids and the dense fields of an index space.
+
+    Only the entities owned by this rank are written, so that each entity
+    of a colored index space is written exactly once. Their ids are written
+    in rank order to the dataset "index_space_<n>_ids", and its attribute
+    "entity_offsets" gives the range of entities of each rank. They allow a
+    checkpoint to be recovered on a different number of ranks.
+
+    The dense fields are written to the dataset "index_space_<n>" with a
+    single collective write. The ids of the fields, their offsets in the
+    dataset and their sizes per entity are stored as the attributes
+    "fids", "offsets" and "entity_sizes".
+   */
+
+  void write_index_space(const hid_t hdf5_file_id,
+    const checkpoint_state_t::staged_index_space_t & staged) {
+    if(staged.global_ids) {
+      const hsize_t count = staged.ids.size();
+      std::vector<hsize_t> all_counts(new_world_size);
+      MPI_Allgather(&count, 1, hsize_mpi_type, all_counts.data(), 1,
+        hsize_mpi_type, mpi_hdf5_comm);
+
+      std::vector<hsize_t> entity_offsets(new_world_size + 1, 0);
+      for(int r = 0; r < new_world_size; ++r) {
+        entity_offsets[r + 1] = entity_offsets[r] + all_counts[r];
+      }
+
+      hid_t dataset_id = create_words_dataset(hdf5_file_id,
+        ids_dataset_name(staged.index_space),
+        id_words * entity_offsets[new_world_size]);
+      write_attribute(dataset_id, "entity_offsets", entity_offsets);
+      write_words(dataset_id, {id_words * entity_offsets[new_rank]},
+        {id_words * staged.ids.size()}, staged.ids.data());
+      herr_t status = H5Dclose(dataset_id);
+      assert(status == 0);
+    }
+
+    if(staged.fids.empty())
+      return;
+
+    std::vector<hsize_t> offsets, displs;
+    index_space_layout(staged.sizes, offsets, displs);
+
+    hid_t dataset_id = create_words_dataset(
+      hdf5_file_id, dense_dataset_name(staged.index_space), offsets.back());
+
+    write_attribute(dataset_id, "fids",
+      std::vector<hsize_t>(staged.fids.begin(), staged.fids.end()));
+    write_attribute(dataset_id, "offsets", offsets);
+    write_attribute(dataset_id, "entity_sizes", staged.entity_sizes);
+
+    std::vector<hsize_t> starts(staged.sizes.size());
+    for(size_t i = 0; i < starts.size(); ++i) {
+      starts[i] = offsets[i] + displs[i];
+    }
+    write_words(dataset_id, starts, staged.sizes, staged.buffer.data());
+
+    herr_t status = H5Dclose(dataset_id);
+    assert(status == 0);
+  } // write_index_space
+
+  /*!
+    Read the dense fields of an index space with a single collective read.
+    The fields are looked up by id, so they do not need to be registered in
+    the same order as when the checkpoint was written.
+   */
+
+  void recover_index_space(const hid_t hdf5_file_id,
+    const size_t index_space,
+    const std::vector<const field_info_t *> & fields) {
+    auto & context = execution::context_t::instance();
+    auto & field_data = context.registered_field_data();
+
+    hid_t dataset_id =
+      open_dataset(hdf5_file_id, dense_dataset_name(index_space));
+
+    const auto file_fids = read_attribute(dataset_id, "fids");
+    const auto file_offsets = read_attribute(dataset_id, "offsets");
+
+    // A selection is always read in file order, so the fields are read in
+    // the order in which they were written.
+    std::vector<std::pair<size_t, const field_info_t *>> order;
+    for(auto info : fields) {
+      auto it = std::find(file_fids.begin(), file_fids.end(), info->fid);
+      assert(it != file_fids.end() && "field missing from checkpoint");
+      order.push_back({size_t(it - file_fids.begin()), info});
+    }
+    std::sort(order.begin(), order.end());
+
+    std::vector<hsize_t> sizes;
+    std::vector<size_t> bytes;
+    hsize_t nsize = 0;
+    for(const auto & o : order) {
+      bytes.push_back(owned_bytes(*o.second));
+      sizes.push_back(word_count(bytes.back()));
+      nsize += sizes.back();
+    }
+
+    std::vector<hsize_t> offsets, displs;
+    index_space_layout(sizes, offsets, displs);
+
+    std::vector<hsize_t> starts(order.size());
+    for(size_t i = 0; i < order.size(); ++i) {
+      starts[i] = file_offsets[order[i].first] + displs[i];
+    }
+
+    std::vector<std::uint32_t> buffer(nsize);
+    read_words(dataset_id, starts, sizes, buffer.data());
+
+    herr_t status = H5Dclose(dataset_id);
+    assert(status == 0);
+
+    const std::uint32_t * buf_ptr = buffer.data();
+    for(size_t i = 0; i < order.size(); ++i) {
+      std::memcpy(
+        field_data.at(order[i].second->fid).data(), buf_ptr, bytes[i]);
+      buf_ptr += sizes[i];
+    }
+  } // recover_index_space
+
+  std::vector<std::uint32_t> serialize_field_ragged(
     const std::vector<uint8_t> & rows,
     const hsize_t nrows,
     const field_id_t fid) {
     auto & context = execution::context_t::instance();
     auto serdez = context.get_serdez(fid);
-    hsize_t nsize = 0;
+    hsize_t size = 0;
     hsize_t row_vector_size = sizeof(data::row_vector_u<uint8_t>);
-    for(int i = 0; i < nrows; ++i) {
-      nsize += serdez->serialized_size(&rows[i * row_vector_size]);
+    for(hsize_t i = 0; i < nrows; ++i) {
+      size += serdez->serialized_size(&rows[i * row_vector_size]);
     }
-    // TODO:  handle case where this doesn't divide evenly
-    nsize /= sizeof(std::uint32_t);
-
-    hsize_t sum_nsize;
-    MPI_Allreduce(
-      &nsize, &sum_nsize, 1, hsize_mpi_type, MPI_SUM, mpi_hdf5_comm);
-    hsize_t displ;
-    MPI_Exscan(&nsize, &displ, 1, hsize_mpi_type, MPI_SUM, mpi_hdf5_comm);
-    if(new_rank == 0)
-      displ = 0;
-    std::vector<hsize_t> offset_buf(new_world_size + 1);
-    MPI_Allgather(&displ, 1, hsize_mpi_type, offset_buf.data(), 1,
-      hsize_mpi_type, mpi_hdf5_comm);
-    offset_buf[new_world_size] = sum_nsize;
 
-    bool return_val = false;
-    return_val = create_hdf5_dataset(
-      hdf5_file_id, field_name.data(), sum_nsize, mpi_hdf5_comm);
-    assert(return_val);
-
-    std::vector<std::uint32_t> buffer(nsize);
+    // round up to whole words, the padding is never read back
+    std::vector<std::uint32_t> buffer(
+      std::ceil(((double)size) / sizeof(std::uint32_t)), 0);
     const char * row_ptr = (char *)rows.data();
     char * buf_ptr = (char *)buffer.data();
-    for(int i = 0; i < nrows; ++i) {
+    for(hsize_t i = 0; i < nrows; ++i) {
       int item_size = serdez->serialize(row_ptr, buf_ptr);
       row_ptr += row_vector_size;
       buf_ptr += item_size;
     }
 
-    return_val = write_data_to_hdf5(hdf5_file_id, field_name, buffer.data(),
-      nsize, displ, mpi_hdf5_comm, offset_buf.data());
-    assert(return_val);
-  } // checkpoint_field_ragged
+    return buffer;
+  } // serialize_field_ragged
 
-  void recover_field(const hid_t hdf5_file_id,
-    const std::string & field_name,
-    void * buffer,
-    const hsize_t size) {
-    hsize_t nsize = std::ceil(((double)size) / sizeof(std::uint32_t));
-    hsize_t displ;
-    MPI_Exscan(&nsize, &displ, 1, hsize_mpi_type, MPI_SUM, mpi_hdf5_comm);
-    if(new_rank == 0)
-      displ = 0;
+  /*!
+    Serialize the exclusive and shared rows of all the ragged and sparse
+    fields.
+   */
 
-    bool return_val = false;
+  std::vector<checkpoint_state_t::staged_field_t> stage_ragged_fields() {
+    auto & context = execution::context_t::instance();
+    const auto & sparse_field_data = context.registered_sparse_field_data();
+    std::vector<checkpoint_state_t::staged_field_t> fields;
+    for(const auto & info : context.registered_fields()) {
+      if(info.storage_class == data::ragged ||
+         info.storage_class == data::sparse) {
+        field_id_t fid = info.fid;
+        auto & data = sparse_field_data.at(fid);
+        fields.push_back({"fid_" + std::to_string(fid),
+          serialize_field_ragged(
+            data.rows, data.num_exclusive + data.num_shared, fid)});
+      }
+    }
+    return fields;
+  } // stage_ragged_fields
+
+  /*!
+    Write the serialized ragged fields, one dataset each. The sizes of all
+    the fields on all the ranks are exchanged with a single allgather.
+   */
+
+  void write_fields_ragged(const hid_t hdf5_file_id,
+    const std::vector<checkpoint_state_t::staged_field_t> & fields) {
+    const int nfields = fields.size();
+    if(nfields == 0)
+      return;
+
+    std::vector<hsize_t> nsizes(nfields);
+    for(int i = 0; i < nfields; ++i) {
+      nsizes[i] = fields[i].buffer.size();
+    }
+    std::vector<hsize_t> all_nsizes(nfields * new_world_size);
+    MPI_Allgather(nsizes.data(), nfields, hsize_mpi_type, all_nsizes.data(),
+      nfields, hsize_mpi_type, mpi_hdf5_comm);
 
-    return_val = read_data_from_hdf5(
-      hdf5_file_id, field_name.data(), buffer, nsize, displ, mpi_hdf5_comm);
-    assert(return_val);
-  } // recover_field
+    std::vector<hsize_t> offset_buf(new_world_size + 1);
+    for(int i = 0; i < nfields; ++i) {
+      offset_buf[0] = 0;
+      for(int r = 0; r < new_world_size; ++r) {
+        offset_buf[r + 1] = offset_buf[r] + all_nsizes[r * nfields + i];
+      }
+
+      bool return_val = false;
+      return_val = create_hdf5_dataset(hdf5_file_id, fields[i].name,
+        offset_buf[new_world_size], mpi_hdf5_comm);
+      assert(return_val);
+
+      return_val = write_data_to_hdf5(hdf5_file_id, fields[i].name,
+        fields[i].buffer.data(), nsizes[i], offset_buf[new_rank],
+        mpi_hdf5_comm, offset_buf.data());
+      assert(return_val);
+    }
+  } // write_fields_ragged
 
   void recover_field_ragged(const hid_t hdf5_file_id,
     const std::string & field_name,
@@ -422,7 +976,7 @@ struct mpi_policy_t {
     char * row_ptr = (char *)rows.data();
     const char * buf_ptr = (char *)buffer.data();
     int row_vector_size = sizeof(data::row_vector_u<uint8_t>);
-    for(int i = 0; i < nrows; ++i) {
+    for(hsize_t i = 0; i < nrows; ++i) {
       int item_size = serdez->deserialize(row_ptr, buf_ptr);
       row_ptr += row_vector_size;
       buf_ptr += item_size;
@@ -431,7 +985,8 @@ struct mpi_policy_t {
   } // recover_field_ragged
 
   void checkpoint_all_fields(const std::string & file_name_in) {
-    // TODO:  make this happen only once
+    wait_for_checkpoint();
+
     create_hdf5_comm();
 
     hid_t hdf5_file_id = -1;
@@ -443,65 +998,162 @@ struct mpi_policy_t {
     assert(return_val == 0);
 
     // create hdf5 file
-    if(rank == 0)
-      std::cout << "Creating HDF5 file " << std::endl << world_size;
-
     std::string file_name = file_name_in + std::to_string(new_color);
     return_val = create_hdf5_file(hdf5_file_id, file_name, mpi_hdf5_comm);
     assert(return_val);
 
     // checkpoint
-    if(rank == 0)
-      std::cout << "Writing checkpoint" << std::endl;
+#if defined(FLECSI_USE_SPLIT_PHASE_GHOSTS) && !defined(FLECSI_USE_AGGCOMM)
     auto & context = execution::context_t::instance();
-    const auto & field_data = context.registered_field_data();
-    const auto & sparse_field_data = context.registered_sparse_field_data();
-    const auto & field_info = context.registered_fields();
-    for(const auto & info : field_info) {
-      switch(info.storage_class) {
-        case data::dense: {
-          field_id_t fid = info.fid;
-          std::string field_name = "fid_" + std::to_string(fid);
-          auto & data = field_data.at(fid);
-          // TODO:  handle case where this doesn't divide evenly
-          hsize_t size = data.size();
-          const void * buffer = data.data();
-          checkpoint_field(hdf5_file_id, field_name, buffer, size);
-        } break;
-
-        case data::ragged:
-        case data::sparse: {
-          field_id_t fid = info.fid;
-          std::string field_name = "fid_" + std::to_string(fid);
-          auto & data = sparse_field_data.at(fid);
-          hsize_t nrows = data.num_total;
-          const auto & rows = data.rows;
-          checkpoint_field_ragged(hdf5_file_id, field_name, rows, nrows, fid);
-        } break;
-
-        default:
-          // do nothing
-          break;
-      }
+    context.complete_ghost_exchanges();
+#endif
+    write_layout(hdf5_file_id);
+
+    // only one index space is staged at a time
+    for(const auto & fields : index_space_fields()) {
+      write_index_space(
+        hdf5_file_id, stage_index_space(fields.first, fields.second));
     }
 
+    write_fields_ragged(hdf5_file_id, stage_ragged_fields());
+
     return_val = close_hdf5_file(hdf5_file_id, mpi_hdf5_comm);
     assert(return_val);
   } // checkpoint_all_fields
 
-  void recover_all_fields(const std::string & file_name_in) {
+  /*!
+    Checkpoint all fields without waiting for the file to be written.
+
+    The data of every field is copied into a staging buffer before this
+    call returns, so the fields can be modified right away. The staged data
+    is then written by a background thread (if FleCSI was built with
+    FLECSI_USE_ASYNC_CHECKPOINT and MPI provides MPI_THREAD_MULTIPLE) on
+    its own HDF5 communicator, while the simulation continues. Otherwise,
+    it is written before this call returns.
+
+    At most one checkpoint is written at a time: if the previous one is
+    still being written, this call takes its snapshot first and then waits
+    for it, so that the two staging buffers overlap with the write.
+
+    @return A handle that can be waited on for the write to finish.
+   */
+
+  checkpoint_handle_t checkpoint_all_fields_async(
+    const std::string & file_name_in) {
+    auto state = std::make_shared<checkpoint_state_t>();
+
+#if defined(FLECSI_USE_SPLIT_PHASE_GHOSTS) && !defined(FLECSI_USE_AGGCOMM)
+    auto & context = execution::context_t::instance();
+    context.complete_ghost_exchanges();
+#endif
+    for(const auto & fields : index_space_fields()) {
+      state->index_spaces.push_back(
+        stage_index_space(fields.first, fields.second));
+    }
+
+    state->ragged_fields = stage_ragged_fields();
+
+    // the communicator and file of the previous checkpoint are in use
+    // until it has been written
+    wait_for_checkpoint();
+
     create_hdf5_comm();
 
+    int return_val = H5open();
+    assert(return_val == 0);
+
+    state->file_name = file_name_in + std::to_string(new_color);
+    pending_checkpoint_ = state;
+
+#if defined(FLECSI_USE_ASYNC_CHECKPOINT)
+    int provided;
+    MPI_Query_thread(&provided);
+    if(provided == MPI_THREAD_MULTIPLE) {
+      checkpoint_state_t * s = state.get();
+      state->thread = std::thread([this, s]() { write_checkpoint(*s); });
+      return checkpoint_handle_t(state);
+    }
+#endif
+
+    write_checkpoint(*state);
+    return checkpoint_handle_t(state);
+  } // checkpoint_all_fields_async
+
+  /*!
+    Block until the last checkpoint started with checkpoint_all_fields_async
+    has been written.
+   */
+
+  void wait_for_checkpoint() {
+    if(pending_checkpoint_) {
+      pending_checkpoint_->wait();
+      pending_checkpoint_.reset();
+    }
+  } // wait_for_checkpoint
+
+  void write_checkpoint(checkpoint_state_t & state) {
     hid_t hdf5_file_id = -1;
     bool return_val = false;
 
-    // recover
-    if(rank == 0)
-      std::cout << "Recovering checkpoint" << std::endl;
-    std::string file_name = file_name_in + std::to_string(new_color);
-    return_val = open_hdf5_file(hdf5_file_id, file_name, mpi_hdf5_comm);
+    return_val =
+      create_hdf5_file(hdf5_file_id, state.file_name, mpi_hdf5_comm);
+    assert(return_val);
+
+    write_layout(hdf5_file_id);
+
+    for(const auto & staged : state.index_spaces) {
+      write_index_space(hdf5_file_id, staged);
+    }
+
+    write_fields_ragged(hdf5_file_id, state.ragged_fields);
+
+    return_val = close_hdf5_file(hdf5_file_id, mpi_hdf5_comm);
+    assert(return_val);
+  } // write_checkpoint
+
+  /*!
+    Record the number of ranks and the number of ranks per file that a
+    checkpoint is written with, as the attribute "layout" of the file.
+   */
+
+  void write_layout(const hid_t hdf5_file_id) {
+    write_attribute(hdf5_file_id, "layout",
+      {hsize_t(world_size), hsize_t(ranks_per_file)});
+  } // write_layout
+
+  /*!
+    Return the number of ranks and the number of ranks per file that a
+    checkpoint was written with.
+
+    The layout is read from the first file, which every rank opens on
+    MPI_COMM_WORLD. Checkpoints without a layout attribute were written
+    with one dataset per field, which is not supported anymore: recovering
+    them is a fatal error.
+   */
+
+  std::vector<hsize_t> read_layout(const std::string & file_name_in) {
+    hid_t hdf5_file_id = -1;
+    bool return_val = false;
+
+    return_val =
+      open_hdf5_file(hdf5_file_id, file_name_in + "0", MPI_COMM_WORLD);
+    assert(return_val);
+
+    clog_assert(H5Aexists(hdf5_file_id, "layout") > 0,
+      "checkpoint " << file_name_in
+                    << " has no layout: the per-field format is not supported");
+    const auto layout = read_attribute(hdf5_file_id, "layout");
+
+    return_val = close_hdf5_file(hdf5_file_id, MPI_COMM_WORLD);
     assert(return_val);
+    return layout;
+  } // read_layout
+
+  /*!
+    Instantiate the fields that have not been instantiated yet.
+   */
 
+  void register_missing_fields() {
     auto & context = execution::context_t::instance();
     auto & field_data = context.registered_field_data();
     const auto & sparse_field_data = context.registered_sparse_field_data();
@@ -512,7 +1164,6 @@ struct mpi_policy_t {
         case data::dense: {
           field_id_t fid = info.fid;
           size_t is = info.index_space;
-          std::string field_name = "fid_" + std::to_string(fid);
           auto it = field_data.find(fid);
           if(it == field_data.end()) {
             // instantiate field if not already there
@@ -524,17 +1175,12 @@ struct mpi_policy_t {
             it = field_data.find(fid);
           }
           assert(it != field_data.end() && "messed up");
-          auto & data = field_data.at(fid);
-          hsize_t size = data.size();
-          void * buffer = data.data();
-          recover_field(hdf5_file_id, field_name, buffer, size);
         } break;
 
         case data::ragged:
         case data::sparse: {
           field_id_t fid = info.fid;
           size_t is = info.index_space;
-          std::string field_name = "fid_" + std::to_string(fid);
           auto it = sparse_field_data.find(fid);
           if(it == sparse_field_data.end()) {
             // instantiate field if not already there
@@ -547,10 +1193,6 @@ struct mpi_policy_t {
             it = sparse_field_data.find(fid);
           }
           assert(it != sparse_field_data.end() && "messed up");
-          auto & data = sparse_field_data.at(fid);
-          hsize_t nrows = data.num_total;
-          const auto & rows = data.rows;
-          recover_field_ragged(hdf5_file_id, field_name, rows, nrows, fid);
         } break;
 
         default:
@@ -558,11 +1200,635 @@ struct mpi_policy_t {
           break;
       }
     }
+  } // register_missing_fields
+
+  /*!
+    Recover all fields from a checkpoint. A checkpoint written with a
+    different number of ranks, or a different number of ranks per file, is
+    redistributed to the current coloring (see
+    recover_all_fields_redistributed()).
+   */
+
+  void recover_all_fields(const std::string & file_name_in) {
+    wait_for_checkpoint();
+
+    create_hdf5_comm();
+
+    auto & context = execution::context_t::instance();
+#if defined(FLECSI_USE_SPLIT_PHASE_GHOSTS) && !defined(FLECSI_USE_AGGCOMM)
+    context.complete_ghost_exchanges();
+#endif
+    register_missing_fields();
+
+    const auto layout = read_layout(file_name_in);
+    if(layout[0] != hsize_t(world_size) ||
+       layout[1] != hsize_t(ranks_per_file)) {
+      recover_all_fields_redistributed(file_name_in, layout[0], layout[1]);
+      refill_ghosts();
+      return;
+    }
+
+    hid_t hdf5_file_id = -1;
+    bool return_val = false;
+
+    // recover
+    std::string file_name = file_name_in + std::to_string(new_color);
+    return_val = open_hdf5_file(hdf5_file_id, file_name, mpi_hdf5_comm);
+    assert(return_val);
+
+    auto & sparse_field_data = context.registered_sparse_field_data();
+    for(const auto & fields : index_space_fields()) {
+      std::vector<const field_info_t *> dense, ragged;
+      split_fields(fields.second, dense, ragged);
+
+      if(!dense.empty())
+        recover_index_space(hdf5_file_id, fields.first, dense);
+
+      for(auto info : ragged) {
+        field_id_t fid = info->fid;
+        std::string field_name = "fid_" + std::to_string(fid);
+        auto & data = sparse_field_data.at(fid);
+        hsize_t nrows = data.num_exclusive + data.num_shared;
+        const auto & rows = data.rows;
+        recover_field_ragged(hdf5_file_id, field_name, rows, nrows, fid);
+        data.compacted = false;
+      }
+    }
 
     return_val = close_hdf5_file(hdf5_file_id, mpi_hdf5_comm);
     assert(return_val);
+
+    refill_ghosts();
   } // recover_all_fields
 
+  /*!
+    Rebuild the ghosts of all the fields of colored index spaces, which are
+    not written to checkpoints, from the entities of their owners.
+
+    With aggregated communication, the ghosts are marked as stale, and the
+    prolog of the next task that reads them exchanges them. Otherwise, the
+    dense fields are exchanged through their MPI windows, like in the task
+    epilog, and the rows of the ragged and sparse fields are sent to the
+    ranks that have them as ghosts.
+   */
+
+  void refill_ghosts() {
+    auto & context = execution::context_t::instance();
+    auto & index_space_data_map = context.index_space_data_map();
+#if !defined(FLECSI_USE_AGGCOMM)
+    auto & field_data = context.registered_field_data();
+    const auto & field_metadata = context.registered_field_metadata();
+#endif
+
+    for(const auto & fields : index_space_fields()) {
+      if(!has_global_ids(fields.first))
+        continue;
+      auto & isd = index_space_data_map[fields.first];
+
+      for(auto info : fields.second) {
+#if defined(FLECSI_USE_AGGCOMM)
+        isd.ghost_is_readable[info->fid] = false;
+        if(info->storage_class != data::dense)
+          isd.ghost_was_resized[info->fid] = true;
+#else
+        if(info->storage_class == data::dense) {
+          // fields that are never accessed with ghosts have no window
+          if(field_metadata.find(info->fid) == field_metadata.end())
+            continue;
+          auto ghost_data =
+            field_data.at(info->fid).data() + owned_bytes(*info);
+          context.start_ghost_exchange(
+            info->fid, ghost_data, isd.ghost_is_readable[info->fid]);
+        }
+        else {
+          exchange_ghost_rows(*info);
+        }
+#endif
+      }
+    }
+  } // refill_ghosts
+
+  /*!
+    Send the serialized shared rows of a ragged or sparse field to the ranks
+    that have them as ghosts, and deserialize the ghost rows received from
+    their owners. The rows sent to a rank are ordered by their offset in the
+    shared entities of their owner, which is how the receiver finds them.
+   */
+
+  void exchange_ghost_rows(const field_info_t & info) {
+    auto & context = execution::context_t::instance();
+    const auto & index_coloring = context.coloring(info.index_space);
+    auto & data = context.registered_sparse_field_data().at(info.fid);
+    auto serdez = context.get_serdez(info.fid);
+    const size_t row_vector_size = sizeof(data::row_vector_u<uint8_t>);
+    const size_t num_owned = data.num_exclusive + data.num_shared;
+
+    std::vector<const flecsi::coloring::entity_info_t *> shared;
+    for(const auto & entity : index_coloring.shared) {
+      shared.push_back(&entity);
+    }
+    std::sort(shared.begin(), shared.end(),
+      [](const auto * a, const auto * b) { return a->offset < b->offset; });
+
+    std::map<int, std::vector<std::uint8_t>> send;
+    for(auto entity : shared) {
+      const auto * row =
+        &data.rows[(data.num_exclusive + entity->offset) * row_vector_size];
+      for(auto peer : entity->shared) {
+        auto & buffer = send[peer];
+        const size_t size = buffer.size();
+        buffer.resize(size + serdez->serialized_size(row));
+        serdez->serialize(row, &buffer[size]);
+      }
+    }
+
+    // the local index of every ghost, by owner and offset on the owner
+    std::map<int, std::vector<std::pair<size_t, size_t>>> ghosts;
+    size_t index = num_owned;
+    for(const auto & entity : index_coloring.ghost) {
+      ghosts[entity.rank].push_back({entity.offset, index++});
+    }
+
+    std::vector<hsize_t> send_sizes, recv_sizes(ghosts.size());
+    std::vector<MPI_Request> requests;
+    for(const auto & s : send) {
+      send_sizes.push_back(s.second.size());
+    }
+    size_t i = 0;
+    for(const auto & g : ghosts) {
+      requests.emplace_back();
+      MPI_Irecv(&recv_sizes[i++], 1, hsize_mpi_type, g.first, 0,
+        MPI_COMM_WORLD, &requests.back());
+    }
+    i = 0;
+    for(const auto & s : send) {
+      requests.emplace_back();
+      MPI_Isend(&send_sizes[i++], 1, hsize_mpi_type, s.first, 0,
+        MPI_COMM_WORLD, &requests.back());
+    }
+    MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+    requests.clear();
+
+    std::vector<std::vector<std::uint8_t>> received(ghosts.size());
+    i = 0;
+    for(const auto & g : ghosts) {
+      received[i].resize(recv_sizes[i]);
+      requests.emplace_back();
+      MPI_Irecv(received[i].data(), recv_sizes[i], MPI_BYTE, g.first, 0,
+        MPI_COMM_WORLD, &requests.back());
+      ++i;
+    }
+    for(auto & s : send) {
+      requests.emplace_back();
+      MPI_Isend(s.second.data(), s.second.size(), MPI_BYTE, s.first, 0,
+        MPI_COMM_WORLD, &requests.back());
+    }
+    MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+
+    i = 0;
+    for(auto & g : ghosts) {
+      std::sort(g.second.begin(), g.second.end());
+      const std::uint8_t * ptr = received[i++].data();
+      for(const auto & ghost : g.second) {
+        ptr += serdez->deserialize(
+          &data.rows[ghost.second * row_vector_size], ptr);
+      }
+    }
+    data.compacted = false;
+  } // exchange_ghost_rows
+
+  /*!
+    Recover a checkpoint written with a different number of ranks, or a
+    different number of ranks per file.
+
+    Every rank reads the entities written by a contiguous block of the old
+    ranks, opening only the files that hold them, on its own. The entities
+    are then sent to the ranks that need them by global id, through a
+    rendezvous rank (the global id modulo the number of ranks): one
+    exchange per index space carries the ids requested by every rank and
+    the entities that were read to the rendezvous ranks, and a second one
+    carries the requested entities back. Both carry all the fields of the
+    index space at once, and only between the ranks that have something to
+    send each other (see exchange()).
+
+    The fields of index spaces without a coloring have no global ids, so
+    such a checkpoint cannot be redistributed: recovering it is a fatal
+    error.
+
+    @param file_name_in       The base name of the checkpoint files.
+    @param old_world_size     The number of ranks of the checkpoint.
+    @param old_ranks_per_file The number of ranks per file of the
+                              checkpoint.
+   */
+
+  void recover_all_fields_redistributed(const std::string & file_name_in,
+    const hsize_t old_world_size,
+    const hsize_t old_ranks_per_file) {
+    const auto fields = index_space_fields();
+    for(const auto & is_fields : fields) {
+      clog_assert(has_global_ids(is_fields.first),
+        "index space " << is_fields.first
+                       << " has no global ids: checkpoint written by "
+                       << old_world_size << " ranks cannot be recovered");
+    }
+
+    // the old ranks read by this rank
+    const hsize_t first_old =
+      (rank * old_world_size + world_size - 1) / world_size;
+    const hsize_t last_old =
+      ((rank + 1) * old_world_size + world_size - 1) / world_size;
+
+    // the records of the entities read by this rank, by index space and
+    // rendezvous rank
+    std::map<size_t, std::map<int, std::vector<std::uint8_t>>> records;
+
+    // the files that hold the old ranks of this rank, if any
+    const hsize_t first_file = first_old / old_ranks_per_file;
+    const hsize_t last_file = first_old < last_old
+                                ? (last_old + old_ranks_per_file - 1) /
+                                    old_ranks_per_file
+                                : first_file;
+    for(hsize_t f = first_file; f < last_file; ++f) {
+      hid_t hdf5_file_id = -1;
+      bool return_val = false;
+      return_val = open_hdf5_file(hdf5_file_id,
+        file_name_in + std::to_string(f), MPI_COMM_SELF, H5F_ACC_RDONLY);
+      assert(return_val);
+
+      const hsize_t file_first = f * old_ranks_per_file;
+      const hsize_t file_last =
+        std::min(file_first + old_ranks_per_file, old_world_size);
+      const hsize_t r0 = std::max(first_old, file_first) - file_first;
+      const hsize_t r1 = std::min(last_old, file_last) - file_first;
+
+      for(const auto & is_fields : fields) {
+        read_entity_records(hdf5_file_id, is_fields.first, is_fields.second,
+          r0, r1, records[is_fields.first]);
+      }
+
+      return_val = close_hdf5_file(hdf5_file_id, MPI_COMM_SELF);
+      assert(return_val);
+    }
+
+    // the exchanges of the messages of the recovery are kept apart from
+    // any other communication on MPI_COMM_WORLD
+    MPI_Comm comm;
+    MPI_Comm_dup(MPI_COMM_WORLD, &comm);
+    for(const auto & is_fields : fields) {
+      redistribute_entity_records(
+        is_fields.first, is_fields.second, records[is_fields.first], comm);
+    }
+    MPI_Comm_free(&comm);
+  } // recover_all_fields_redistributed
+
+  /*!
+    Read the entities of an index space written by the old ranks [r0, r1) of
+    a file, and append their records to the buffers of their rendezvous
+    ranks. The file is opened by this rank alone, on MPI_COMM_SELF, so the
+    reads do not involve any other rank. A record holds the global id of the entity, the size of its
+    values and the values of the fields: the dense ones and then the
+    serialized ragged ones, in the order in which they are registered.
+   */
+
+  void read_entity_records(const hid_t hdf5_file_id,
+    const size_t index_space,
+    const std::vector<const field_info_t *> & fields,
+    const hsize_t r0,
+    const hsize_t r1,
+    std::map<int, std::vector<std::uint8_t>> & records) {
+    auto & context = execution::context_t::instance();
+
+    std::vector<const field_info_t *> dense, ragged;
+    split_fields(fields, dense, ragged);
+
+    // global ids
+    hid_t ids_id = open_dataset(hdf5_file_id, ids_dataset_name(index_space));
+    const auto entity_offsets = read_attribute(ids_id, "entity_offsets");
+    assert(r1 < entity_offsets.size());
+
+    std::vector<hsize_t> ids(entity_offsets[r1] - entity_offsets[r0]);
+    read_words(ids_id, {id_words * entity_offsets[r0]},
+      {id_words * ids.size()}, ids.data());
+    herr_t status = H5Dclose(ids_id);
+    assert(status == 0);
+
+    auto num_entities = [&](hsize_t r) {
+      return entity_offsets[r + 1] - entity_offsets[r];
+    };
+
+    // dense fields, with one read in file order
+    std::vector<std::uint32_t> dense_buffer;
+    std::vector<const std::uint8_t *> dense_ptr(dense.size());
+    if(!dense.empty()) {
+      hid_t dataset_id =
+        open_dataset(hdf5_file_id, dense_dataset_name(index_space));
+      const auto file_fids = read_attribute(dataset_id, "fids");
+      const auto file_offsets = read_attribute(dataset_id, "offsets");
+      const auto entity_sizes = read_attribute(dataset_id, "entity_sizes");
+
+      std::vector<std::pair<size_t, size_t>> order;
+      for(size_t i = 0; i < dense.size(); ++i) {
+        auto it = std::find(file_fids.begin(), file_fids.end(), dense[i]->fid);
+        assert(it != file_fids.end() && "field missing from checkpoint");
+        order.push_back({size_t(it - file_fids.begin()), i});
+      }
+      std::sort(order.begin(), order.end());
+
+      std::vector<hsize_t> starts, sizes;
+      for(const auto & o : order) {
+        const hsize_t entity_size = entity_sizes[o.first];
+        assert(entity_size == dense[o.second]->size);
+        hsize_t start = file_offsets[o.first];
+        for(hsize_t r = 0; r < r0; ++r) {
+          start += word_count(num_entities(r) * entity_size);
+        }
+        hsize_t size = 0;
+        for(hsize_t r = r0; r < r1; ++r) {
+          size += word_count(num_entities(r) * entity_size);
+        }
+        starts.push_back(start);
+        sizes.push_back(size);
+      }
+
+      hsize_t nsize = 0;
+      for(auto size : sizes) {
+        nsize += size;
+      }
+      dense_buffer.resize(nsize);
+      read_words(dataset_id, starts, sizes, dense_buffer.data());
+      status = H5Dclose(dataset_id);
+      assert(status == 0);
+
+      const std::uint32_t * buf_ptr = dense_buffer.data();
+      for(size_t i = 0; i < order.size(); ++i) {
+        dense_ptr[order[i].second] = (const std::uint8_t *)buf_ptr;
+        buf_ptr += sizes[i];
+      }
+    }
+
+    // ragged fields, one read each
+    std::vector<std::vector<std::uint32_t>> ragged_buffers(ragged.size());
+    std::vector<std::vector<hsize_t>> ragged_offsets(ragged.size());
+    hsize_t max_slice = 0;
+    for(size_t i = 0; i < ragged.size(); ++i) {
+      std::string field_name = "fid_" + std::to_string(ragged[i]->fid);
+      hid_t dataset_id = open_dataset(hdf5_file_id, field_name);
+      ragged_offsets[i] = read_attribute(dataset_id, "offsets");
+      const auto & offsets = ragged_offsets[i];
+
+      ragged_buffers[i].resize(offsets[r1] - offsets[r0]);
+      read_words(dataset_id, {offsets[r0]}, {ragged_buffers[i].size()},
+        ragged_buffers[i].data());
+      status = H5Dclose(dataset_id);
+      assert(status == 0);
+
+      for(hsize_t r = r0; r < r1; ++r) {
+        max_slice = std::max(max_slice, offsets[r + 1] - offsets[r]);
+      }
+    }
+
+    // The serialized size of a row is only known by deserializing it. The
+    // scratch row borrows a buffer as large as the largest slice, so that
+    // deserializing never allocates.
+    std::vector<std::uint32_t> scratch_buffer(max_slice);
+    data::row_vector_u<std::uint8_t> scratch;
+    scratch.attach((std::uint8_t *)scratch_buffer.data(), 0,
+      std::min<hsize_t>(max_slice * sizeof(std::uint32_t),
+        scratch.borrowed_bit - 1));
+
+    std::vector<std::uint8_t> record;
+    for(hsize_t r = r0; r < r1; ++r) {
+      std::vector<const std::uint8_t *> ragged_ptr(ragged.size());
+      for(size_t i = 0; i < ragged.size(); ++i) {
+        const auto & offsets = ragged_offsets[i];
+        ragged_ptr[i] = (const std::uint8_t *)(ragged_buffers[i].data() +
+                                               (offsets[r] - offsets[r0]));
+      }
+
+      for(hsize_t e = 0; e < num_entities(r); ++e) {
+        record.clear();
+        for(size_t i = 0; i < dense.size(); ++i) {
+          append_bytes(record, dense_ptr[i] + e * dense[i]->size,
+            dense[i]->size);
+        }
+        for(size_t i = 0; i < ragged.size(); ++i) {
+          auto serdez = context.get_serdez(ragged[i]->fid);
+          size_t size = serdez->deserialize(&scratch, ragged_ptr[i]);
+          append_bytes(record, ragged_ptr[i], size);
+          ragged_ptr[i] += size;
+        }
+
+        const hsize_t id = ids[entity_offsets[r] - entity_offsets[r0] + e];
+        const hsize_t header[2] = {id, hsize_t(record.size())};
+        auto & buffer = records[id % world_size];
+        append_bytes(buffer, header, sizeof(header));
+        append_bytes(buffer, record.data(), record.size());
+      }
+
+      for(size_t i = 0; i < dense.size(); ++i) {
+        dense_ptr[i] +=
+          word_count(num_entities(r) * dense[i]->size) * sizeof(std::uint32_t);
+      }
+    }
+  } // read_entity_records
+
+  /*!
+    Send the entities of an index space read by every rank to the ranks
+    that own them, through their rendezvous ranks, and store their values.
+    This takes two sparse exchanges on comm (see exchange()): the first one
+    sends the requested ids and the records that were read to the
+    rendezvous ranks, the second one sends the requested records back. The
+    ghosts are rebuilt afterwards by refill_ghosts().
+   */
+
+  void redistribute_entity_records(const size_t index_space,
+    const std::vector<const field_info_t *> & fields,
+    std::map<int, std::vector<std::uint8_t>> & records,
+    MPI_Comm comm) {
+    auto & context = execution::context_t::instance();
+    auto & field_data = context.registered_field_data();
+    auto & sparse_field_data = context.registered_sparse_field_data();
+    const auto & index_map = context.index_map(index_space);
+    auto & reverse_index_map = context.reverse_index_map(index_space);
+
+    // the requested ids and then the records, for the rendezvous ranks
+    std::map<int, std::vector<hsize_t>> requests;
+    const size_t nowned = num_owned(index_space);
+    for(size_t i = 0; i < nowned; ++i) {
+      requests[index_map[i] % world_size].push_back(index_map[i]);
+    }
+
+    std::map<int, std::vector<std::uint8_t>> send;
+    for(const auto & r : requests) {
+      const hsize_t nrequests = r.second.size();
+      auto & buffer = send[r.first];
+      append_bytes(buffer, &nrequests, sizeof(hsize_t));
+      append_bytes(buffer, r.second.data(), nrequests * sizeof(hsize_t));
+    }
+    for(auto & r : records) {
+      auto & buffer = send[r.first];
+      if(buffer.empty()) {
+        const hsize_t nrequests = 0;
+        append_bytes(buffer, &nrequests, sizeof(hsize_t));
+      }
+      append_bytes(buffer, r.second.data(), r.second.size());
+      std::vector<std::uint8_t>().swap(r.second);
+    }
+
+    auto received = exchange(send, comm, 0);
+
+    struct record_t {
+      const std::uint8_t * data;
+      hsize_t size;
+    };
+    std::unordered_map<hsize_t, record_t> found;
+    for(const auto & r : received) {
+      const std::uint8_t * ptr = r.second.data();
+      const std::uint8_t * end = ptr + r.second.size();
+      const hsize_t nrequests = read_hsize(ptr);
+      ptr += nrequests * sizeof(hsize_t);
+      while(ptr < end) {
+        const hsize_t id = read_hsize(ptr);
+        const hsize_t size = read_hsize(ptr);
+        found.insert({id, {ptr, size}});
+        ptr += size;
+      }
+    }
+
+    send.clear();
+    for(const auto & r : received) {
+      const std::uint8_t * ptr = r.second.data();
+      const hsize_t nrequests = read_hsize(ptr);
+      for(hsize_t i = 0; i < nrequests; ++i) {
+        const hsize_t id = read_hsize(ptr);
+        auto it = found.find(id);
+        assert(it != found.end() && "entity missing from checkpoint");
+        const hsize_t header[2] = {id, it->second.size};
+        auto & buffer = send[r.first];
+        append_bytes(buffer, header, sizeof(header));
+        append_bytes(buffer, it->second.data, it->second.size);
+      }
+    }
+
+    received = exchange(send, comm, 1);
+
+    std::vector<const field_info_t *> dense, ragged;
+    split_fields(fields, dense, ragged);
+
+    const size_t row_vector_size = sizeof(data::row_vector_u<uint8_t>);
+    for(const auto & r : received) {
+      const std::uint8_t * ptr = r.second.data();
+      const std::uint8_t * end = ptr + r.second.size();
+      while(ptr < end) {
+        const hsize_t id = read_hsize(ptr);
+        const hsize_t size = read_hsize(ptr);
+        const std::uint8_t * next = ptr + size;
+        const size_t index = reverse_index_map.at(id);
+
+        for(auto info : dense) {
+          auto & data = field_data.at(info->fid);
+          std::memcpy(&data[index * info->size], ptr, info->size);
+          ptr += info->size;
+        }
+        for(auto info : ragged) {
+          auto serdez = context.get_serdez(info->fid);
+          auto & data = sparse_field_data.at(info->fid);
+          ptr +=
+            serdez->deserialize(&data.rows[index * row_vector_size], ptr);
+        }
+        assert(ptr == next);
+      }
+    }
+
+    for(auto info : ragged) {
+      sparse_field_data.at(info->fid).compacted = false;
+    }
+  } // redistribute_entity_records
+
+  static void append_bytes(std::vector<std::uint8_t> & buffer,
+    const void * data,
+    const size_t size) {
+    const std::uint8_t * bytes = (const std::uint8_t *)data;
+    buffer.insert(buffer.end(), bytes, bytes + size);
+  } // append_bytes
+
+  static hsize_t read_hsize(const std::uint8_t *& ptr) {
+    hsize_t value;
+    std::memcpy(&value, ptr, sizeof(hsize_t));
+    ptr += sizeof(hsize_t);
+    return value;
+  } // read_hsize
+
+  /*!
+    Send buffers to some of the ranks, and receive the buffers that the
+    other ranks send to this rank. The sizes travel with the buffers: they
+    are sent synchronously, received as they are probed, and the exchange
+    ends with a nonblocking barrier that every rank enters once its sends
+    have been received (nonblocking consensus).
+
+    @param send The buffers to send, by rank. Empty buffers are not sent.
+    @param comm The communicator of the exchange.
+    @param tag  The tag of the exchange. Consecutive exchanges on the same
+                communicator must use different tags, so that the messages
+                of a rank that has already started the next exchange are not
+                received by a rank that is still finishing this one.
+
+    @return The buffers received, by rank.
+   */
+
+  static std::map<int, std::vector<std::uint8_t>> exchange(
+    const std::map<int, std::vector<std::uint8_t>> & send,
+    MPI_Comm comm,
+    const int tag) {
+    std::vector<MPI_Request> requests;
+    requests.reserve(send.size());
+    for(const auto & s : send) {
+      if(s.second.empty())
+        continue;
+      assert(s.second.size() < size_t(std::numeric_limits<int>::max()));
+      requests.emplace_back();
+      MPI_Issend(s.second.data(), s.second.size(), MPI_BYTE, s.first, tag,
+        comm, &requests.back());
+    }
+
+    std::map<int, std::vector<std::uint8_t>> recv;
+    MPI_Request barrier = MPI_REQUEST_NULL;
+    bool done = false;
+
+    while(!done) {
+      int arrived;
+      MPI_Status status;
+      MPI_Iprobe(MPI_ANY_SOURCE, tag, comm, &arrived, &status);
+
+      if(arrived) {
+        int count;
+        MPI_Get_count(&status, MPI_BYTE, &count);
+        auto & buffer = recv[status.MPI_SOURCE];
+        buffer.resize(count);
+        MPI_Recv(buffer.data(), count, MPI_BYTE, status.MPI_SOURCE, tag,
+          comm, MPI_STATUS_IGNORE);
+      }
+
+      if(barrier == MPI_REQUEST_NULL) {
+        int sent;
+        MPI_Testall(
+          requests.size(), requests.data(), &sent, MPI_STATUSES_IGNORE);
+        if(sent)
+          MPI_Ibarrier(comm, &barrier);
+      }
+      else {
+        int complete;
+        MPI_Test(&barrier, &complete, MPI_STATUS_IGNORE);
+        done = complete;
+      }
+    } // while
+
+    return recv;
+  } // exchange
+
+  // every global id is stored as a pair of words
+  static constexpr hsize_t id_words = sizeof(hsize_t) / sizeof(std::uint32_t);
+
   int ranks_per_file = 1;
   int nb_files;
 
@@ -571,7 +1837,10 @@ struct mpi_policy_t {
   int new_color;
   int nb_new_comms;
 
-  MPI_Comm mpi_hdf5_comm;
+  MPI_Comm mpi_hdf5_comm = MPI_COMM_NULL;
+  int hdf5_comm_ranks_per_file_ = 0;
+
+  std::shared_ptr<checkpoint_state_t> pending_checkpoint_;
 }; // struct mpi_policy_t
 
 } // namespace io
@@ -0,0 +1,434 @@
+/*
+    @@@@@@@@  @@           @@@@@@   @@@@@@@@ @@
+   /@@/////  /@@          @@////@@ @@////// /@@
+   /@@       /@@  @@@@@  @@    // /@@       /@@
+   /@@@@@@@  /@@ @@///@@/@@       /@@@@@@@@@/@@
+   /@@////   /@@/@@@@@@@/@@       ////////@@/@@
+   /@@       /@@/@@//// //@@    @@       /@@/@@
+   /@@       @@@//@@@@@@ //@@@@@@  @@@@@@@@ /@@
+   //       ///  //////   //////  ////////  //
+
+   Copyright (c) 2016, Los Alamos National Security, LLC
+   All rights reserved.
+                                                                              */
+#pragma once
+
+/*! @file */
+
+#include <flecsi-config.h>
+
+#if !defined(FLECSI_ENABLE_MPI)
+#error FLECSI_ENABLE_MPI not defined! This file depends on MPI!
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+
+#include <flecsi/coloring/crs.h>
+#include <flecsi/coloring/dcrs_utils.h>
+#include <flecsi/io/binary_definition.h>
+#include <flecsi/topology/parallel_mesh_definition.h>
+#include <flecsi/utils/logging.h>
+
+namespace flecsi {
+namespace io {
+
+/*!
+  A distributed mesh definition read from a binary mesh definition file
+  (see binary_mesh_header_t).
+
+  Every rank reads a contiguous block of the cells with collective MPI-IO
+  reads, and then the coordinates of the vertices of its cells only, with
+  a file view that selects them. No rank reads or stores more than its
+  part of the mesh, so the definition can be handed to
+  coloring::make_dcrs_distributed() and then to coloring::migrate() (with
+  pack() and unpack()) to move the cells to their partitions.
+
+  The vertices are numbered locally: entities_crs() gives the local
+  vertices of the local cells, and local_to_global() and global_to_local()
+  map them to the ids of the file. The cells keep the ids of the file as
+  their global ids, also after they are migrated.
+
+  Only the cell-to-vertex connectivity is defined: the file does not store
+  sides or regions.
+ */
+
+template<size_t DIMENSION>
+class parallel_binary_definition_u
+  : public topology::parallel_mesh_definition_u<DIMENSION>
+{
+public:
+  using base_t = topology::parallel_mesh_definition_u<DIMENSION>;
+  using byte_t = typename base_t::byte_t;
+  using real_t = typename base_t::real_t;
+  using connectivity_t = typename base_t::connectivity_t;
+
+  /*!
+    Read a block of the cells of a file. This call is collective over the
+    communicator.
+   */
+
+  parallel_binary_definition_u(const std::string & filename,
+    MPI_Comm comm = MPI_COMM_WORLD) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    MPI_File fh;
+    int ret = MPI_File_open(
+      comm, filename.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &fh);
+    clog_assert(ret == MPI_SUCCESS, "failed opening " << filename);
+
+    // header
+    binary_mesh_header_t header;
+    ret = MPI_File_read_at_all(
+      fh, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+    clog_assert(ret == MPI_SUCCESS && header.valid(),
+      filename << " is not a binary mesh definition");
+    clog_assert(header.dimension == DIMENSION,
+      filename << " has dimension " << header.dimension);
+
+    // the block of cells of this rank
+    std::vector<size_t> cell_dist;
+    coloring::subdivide(header.num_cells, size, cell_dist);
+    const size_t cells_start = cell_dist[rank];
+    const size_t num_cells = cell_dist[rank + 1] - cells_start;
+
+    std::vector<std::uint64_t> offsets(num_cells + 1);
+    read_all(fh, header.offsets_offset(cells_start), offsets.data(),
+      offsets.size());
+
+    std::vector<std::uint64_t> vertices(offsets.back() - offsets.front());
+    read_all(fh, header.indices_offset(offsets.front()), vertices.data(),
+      vertices.size());
+
+    // number the vertices of the block locally, in the order of their ids
+    auto & vertex_l2g = local_to_global_[0];
+    vertex_l2g.assign(vertices.begin(), vertices.end());
+    std::sort(vertex_l2g.begin(), vertex_l2g.end());
+    vertex_l2g.erase(
+      std::unique(vertex_l2g.begin(), vertex_l2g.end()), vertex_l2g.end());
+
+    auto & vertex_g2l = global_to_local_[0];
+    for(size_t v = 0; v < vertex_l2g.size(); ++v) {
+      vertex_g2l.emplace_hint(vertex_g2l.end(), vertex_l2g[v], v);
+    } // for
+
+    cells_.offsets.reserve(num_cells + 1);
+    for(auto o : offsets) {
+      cells_.offsets.push_back(o - offsets.front());
+    } // for
+    cells_.indices.reserve(vertices.size());
+    for(auto v : vertices) {
+      cells_.indices.push_back(vertex_g2l.at(v));
+    } // for
+
+    auto & cell_l2g = local_to_global_[1];
+    auto & cell_g2l = global_to_local_[1];
+    for(size_t c = 0; c < num_cells; ++c) {
+      cell_l2g.push_back(cells_start + c);
+      cell_g2l.emplace_hint(cell_g2l.end(), cells_start + c, c);
+    } // for
+
+    // The coordinates of the vertices of the block, through a view of the
+    // file that selects them. Their ids are sorted, as views require.
+    const size_t num_vertices = vertex_l2g.size();
+    std::vector<MPI_Aint> displs(num_vertices);
+    for(size_t v = 0; v < num_vertices; ++v) {
+      displs[v] = vertex_l2g[v] * DIMENSION * sizeof(double);
+    } // for
+
+    MPI_Datatype filetype;
+    MPI_Type_create_hindexed_block(
+      num_vertices, DIMENSION, displs.data(), MPI_DOUBLE, &filetype);
+    MPI_Type_commit(&filetype);
+    MPI_File_set_view(fh, header.coordinates_offset(), MPI_DOUBLE, filetype,
+      "native", MPI_INFO_NULL);
+
+    coordinates_.resize(num_vertices * DIMENSION);
+    ret = MPI_File_read_all(fh, coordinates_.data(), coordinates_.size(),
+      MPI_DOUBLE, MPI_STATUS_IGNORE);
+    clog_assert(ret == MPI_SUCCESS, "failed reading " << filename);
+
+    MPI_Type_free(&filetype);
+    MPI_File_close(&fh);
+  } // parallel_binary_definition_u
+
+  /// Copy constructor (disabled)
+  parallel_binary_definition_u(const parallel_binary_definition_u &) = delete;
+
+  /// Assignment operator (disabled)
+  parallel_binary_definition_u & operator=(
+    const parallel_binary_definition_u &) = delete;
+
+  size_t num_entities(size_t dimension) const override {
+    if(dimension == 0)
+      return local_to_global_[0].size();
+    if(dimension == DIMENSION)
+      return cells_.size();
+    return 0;
+  } // num_entities
+
+  std::vector<size_t>
+  entities(size_t from_dim, size_t to_dim, size_t id) const override {
+    check_dimensions(from_dim, to_dim);
+    return utils::to_vector(cells_.at(id));
+  } // entities
+
+  /*!
+    Return the local vertices of all the local cells. The connectivity is
+    copied the first time this is called; prefer entities_crs().
+   */
+
+  const connectivity_t & entities(size_t from_dim,
+    size_t to_dim) const override {
+    check_dimensions(from_dim, to_dim);
+    if(connectivity_.empty()) {
+      for(auto vertices : cells_) {
+        connectivity_.push_back(utils::to_vector(vertices));
+      } // for
+    } // if
+    return connectivity_;
+  } // entities
+
+  const coloring::crs_t & entities_crs(size_t from_dim,
+    size_t to_dim) const override {
+    check_dimensions(from_dim, to_dim);
+    return cells_;
+  } // entities_crs
+
+  const std::vector<size_t> & local_to_global(size_t dim) const override {
+    return local_to_global_[index(dim)];
+  } // local_to_global
+
+  const std::map<size_t, size_t> & global_to_local(
+    size_t dim) const override {
+    return global_to_local_[index(dim)];
+  } // global_to_local
+
+  void create_graph(size_t from_dimension,
+    size_t to_dimension,
+    size_t min_connections,
+    coloring::dcrs_t & dcrs) const override {
+    coloring::make_dcrs_distributed<DIMENSION>(
+      *this, from_dimension, to_dimension, min_connections, dcrs);
+  } // create_graph
+
+  /*!
+    Pack a cell for migration: its global id, and the global ids and the
+    coordinates of its vertices.
+   */
+
+  void pack(size_t dimension,
+    size_t local_id,
+    std::vector<byte_t> & buffer) const override {
+    check_dimensions(dimension, 0);
+    topology::cast_insert(&local_to_global_[1][local_id], 1, buffer);
+
+    auto vertices = cells_.at(local_id);
+    const size_t num_vertices = vertices.size();
+    topology::cast_insert(&num_vertices, 1, buffer);
+    for(auto v : vertices) {
+      topology::cast_insert(&local_to_global_[0][v], 1, buffer);
+      topology::cast_insert(&coordinates_[v * DIMENSION], DIMENSION, buffer);
+    } // for
+  } // pack
+
+  /*!
+    Unpack a migrated cell (see pack()). It must be the next local cell.
+   */
+
+  void unpack(size_t dimension,
+    size_t local_id,
+    byte_t const *& buffer) override {
+    check_dimensions(dimension, 0);
+    clog_assert(local_id == cells_.size(), "cells must be unpacked in order");
+
+    size_t global_id, num_vertices;
+    topology::uncast(buffer, 1, &global_id);
+    topology::uncast(buffer, 1, &num_vertices);
+    local_to_global_[1].push_back(global_id);
+    global_to_local_[1].emplace(global_id, local_id);
+
+    std::vector<size_t> vertices(num_vertices);
+    for(auto & v : vertices) {
+      size_t vertex_id;
+      real_t coords[DIMENSION];
+      topology::uncast(buffer, 1, &vertex_id);
+      topology::uncast(buffer, DIMENSION, coords);
+
+      auto it = global_to_local_[0].find(vertex_id);
+      if(it == global_to_local_[0].end()) {
+        it = global_to_local_[0]
+               .emplace(vertex_id, local_to_global_[0].size())
+               .first;
+        local_to_global_[0].push_back(vertex_id);
+        coordinates_.insert(coordinates_.end(), coords, coords + DIMENSION);
+      } // if
+      v = it->second;
+    } // for
+
+    cells_.push_back(vertices);
+    connectivity_.clear();
+  } // unpack
+
+  /*!
+    Erase cells, given by their sorted local ids. The vertices that are no
+    longer used by a cell are erased too, and the remaining vertices and
+    cells keep their relative order.
+   */
+
+  void erase(size_t dimension, const std::vector<size_t> & local_ids) override {
+    check_dimensions(dimension, 0);
+    if(local_ids.empty())
+      return;
+
+    cells_.erase(local_ids);
+    connectivity_.clear();
+
+    auto & cell_l2g = local_to_global_[1];
+    auto id = local_ids.begin();
+    size_t kept = 0;
+    for(size_t c = 0; c < cell_l2g.size(); ++c) {
+      if(id != local_ids.end() && *id == c) {
+        ++id;
+        continue;
+      } // if
+      cell_l2g[kept++] = cell_l2g[c];
+    } // for
+    cell_l2g.resize(kept);
+
+    // renumber the vertices that are still used
+    auto & vertex_l2g = local_to_global_[0];
+    std::vector<size_t> new_ids(vertex_l2g.size(), 0);
+    for(auto v : cells_.indices) {
+      new_ids[v] = 1;
+    } // for
+
+    kept = 0;
+    for(size_t v = 0; v < vertex_l2g.size(); ++v) {
+      if(new_ids[v] == 0)
+        continue;
+      new_ids[v] = kept;
+      vertex_l2g[kept] = vertex_l2g[v];
+      std::copy_n(&coordinates_[v * DIMENSION], DIMENSION,
+        &coordinates_[kept * DIMENSION]);
+      ++kept;
+    } // for
+    vertex_l2g.resize(kept);
+    coordinates_.resize(kept * DIMENSION);
+
+    for(auto & v : cells_.indices) {
+      v = new_ids[v];
+    } // for
+
+    build_maps();
+  } // erase
+
+  /*!
+    The cell-to-vertex connectivity is the only one that is defined, and it
+    is always up to date: this only rebuilds the global-to-local maps.
+   */
+
+  void build_connectivity() override {
+    build_maps();
+  } // build_connectivity
+
+  void vertex(size_t id, real_t * coord) const override {
+    std::copy_n(&coordinates_[id * DIMENSION], DIMENSION, coord);
+  } // vertex
+
+  const std::vector<size_t> & face_owners() const override {
+    return empty_;
+  }
+
+  const std::vector<size_t> & region_ids() const override {
+    return empty_;
+  }
+
+  std::vector<size_t> element_sides(size_t) const override {
+    return {};
+  }
+
+  const coloring::crs_t & side_vertices() const override {
+    return empty_crs_;
+  }
+
+  const std::vector<size_t> & side_ids() const override {
+    return empty_;
+  }
+
+  /*!
+    Return the centroids of the local cells, e.g., for geometric
+    partitioners.
+   */
+
+  std::vector<real_t> midpoints(size_t dimension) const override {
+    check_dimensions(dimension, 0);
+    std::vector<real_t> midpoints(cells_.size() * DIMENSION, 0);
+    for(size_t c = 0; c < cells_.size(); ++c) {
+      auto vertices = cells_[c];
+      for(auto v : vertices) {
+        for(size_t d = 0; d < DIMENSION; ++d) {
+          midpoints[c * DIMENSION + d] += coordinates_[v * DIMENSION + d];
+        } // for
+      } // for
+      for(size_t d = 0; d < DIMENSION; ++d) {
+        midpoints[c * DIMENSION + d] /= vertices.size();
+      } // for
+    } // for
+    return midpoints;
+  } // midpoints
+
+private:
+  static void read_all(MPI_File fh,
+    MPI_Offset offset,
+    std::uint64_t * data,
+    size_t count) {
+    clog_assert(count <= std::numeric_limits<int>::max(), "block too large");
+    int ret = MPI_File_read_at_all(
+      fh, offset, data, count, MPI_UINT64_T, MPI_STATUS_IGNORE);
+    clog_assert(ret == MPI_SUCCESS, "failed reading a mesh definition");
+  } // read_all
+
+  static size_t index(size_t dim) {
+    clog_assert(dim == 0 || dim == DIMENSION, "invalid dimension " << dim);
+    return dim == 0 ? 0 : 1;
+  } // index
+
+  void check_dimensions(size_t from_dim, size_t to_dim) const {
+    clog_assert(from_dim == DIMENSION, "invalid dimension " << from_dim);
+    clog_assert(to_dim == 0, "invalid dimension " << to_dim);
+  } // check_dimensions
+
+  void build_maps() {
+    for(size_t i = 0; i < 2; ++i) {
+      global_to_local_[i].clear();
+      for(size_t l = 0; l < local_to_global_[i].size(); ++l) {
+        global_to_local_[i].emplace(local_to_global_[i][l], l);
+      } // for
+    } // for
+  } // build_maps
+
+  // cells to local vertices
+  coloring::crs_t cells_;
+  mutable connectivity_t connectivity_;
+
+  // vertex and cell ids, at indices 0 and 1
+  std::vector<size_t> local_to_global_[2];
+  std::map<size_t, size_t> global_to_local_[2];
+
+  std::vector<real_t> coordinates_;
+
+  std::vector<size_t> empty_;
+  coloring::crs_t empty_crs_;
+}; // class parallel_binary_definition_u
+
+} // namespace io
+} // namespace flecsi
@@ -33,35 +33,35 @@ class simple_definition_t : public topology::mesh_definition_u<2>
 {
 public:
   /// Default constructor
+  ///
+  /// The file is parsed once: the vertices and the cells are kept in memory.
+  /// For large meshes, see binary_definition_u.
   simple_definition_t(const char * filename) {
-    file_.open(filename, std::ifstream::in);
-
-    if(file_.good()) {
-      std::string line;
-      std::getline(file_, line);
-      std::istringstream iss(line);
-
-      // Read the number of vertices and cells
-      iss >> num_vertices_ >> num_cells_;
+    std::ifstream file(filename, std::ifstream::in);
 
-      // Get the offset to the beginning of the vertices
-      vertex_start_ = file_.tellg();
-
-      for(size_t i(0); i < num_vertices_; ++i) {
-        std::getline(file_, line);
-      } // for
-
-      cell_start_ = file_.tellg();
-    }
-    else {
+    if(!file.good()) {
       clog_fatal("failed opening " << filename);
     } // if
 
-    // Go to the start of the cells.
     std::string line;
-    file_.seekg(cell_start_);
+    std::getline(file, line);
+    std::istringstream iss(line);
+
+    // Read the number of vertices and cells
+    iss >> num_vertices_ >> num_cells_;
+
+    vertices_.reserve(num_vertices_);
+    for(size_t i(0); i < num_vertices_; ++i) {
+      std::getline(file, line);
+      std::istringstream iss(line);
+      point_t v;
+      iss >> v[0] >> v[1];
+      vertices_.push_back(v);
+    } // for
+
+    ids_.reserve(num_cells_);
     for(size_t l(0); l < num_cells_; ++l) {
-      std::getline(file_, line);
+      std::getline(file, line);
       std::istringstream iss(line);
       ids_.push_back(std::vector<size_t>(
         std::istream_iterator<size_t>(iss), std::istream_iterator<size_t>()));
@@ -103,69 +103,23 @@ public:
   entities(size_t from_dim, size_t to_dim, size_t entity_id) const override {
     clog_assert(from_dim == 2, "invalid dimension " << from_dim);
     clog_assert(to_dim == 0, "invalid dimension " << to_dim);
-
-    std::string line;
-    std::vector<size_t> ids;
-    size_t v0, v1, v2, v3;
-
-    // Go to the start of the cells.
-    file_.seekg(cell_start_);
-
-    // Walk to the line with the requested id.
-    for(size_t l(0); l < entity_id; ++l) {
-      std::getline(file_, line);
-    } // for
-
-    // Get the line with the information for the requested id.
-    std::getline(file_, line);
-    std::istringstream iss(line);
-
-    // Read the cell definition.
-    iss >> v0 >> v1 >> v2 >> v3;
-
-    ids.push_back(v0);
-    ids.push_back(v1);
-    ids.push_back(v2);
-    ids.push_back(v3);
-
-    return ids;
+    return ids_[entity_id];
   } // vertices
 
   ///
   ///
   ///
   point_t vertex(size_t vertex_id) const {
-    std::string line;
-    point_t v;
-
-    // Go to the start of the vertices.
-    file_.seekg(vertex_start_);
-
-    // Walk to the line with the requested id.
-    for(size_t l(0); l < vertex_id; ++l) {
-      std::getline(file_, line);
-    } // for
-
-    // Get the line with the information for the requested id.
-    std::getline(file_, line);
-    std::istringstream iss(line);
-
-    // Read the vertex coordinates.
-    iss >> v[0] >> v[1];
-
-    return v;
+    return vertices_[vertex_id];
   } // vertex
 
 private:
-  mutable std::ifstream file_;
+  std::vector<point_t> vertices_;
   std::vector<std::vector<size_t>> ids_;
 
   size_t num_vertices_;
   size_t num_cells_;
 
-  mutable std::iostream::pos_type vertex_start_;
-  mutable std::iostream::pos_type cell_start_;
-
 }; // class simple_definition_t
 
 } // namespace io
@@ -0,0 +1,73 @@
+/*~-------------------------------------------------------------------------~~*
+ * Copyright (c) 2014 Los Alamos National Security, LLC
+ * All rights reserved.
+ *~-------------------------------------------------------------------------~~*/
+
+#include <set>
+
+#include <cinchtest.h>
+
+#include <flecsi/io/binary_definition.h>
+#include <flecsi/io/simple_definition.h>
+#include <flecsi/topology/closure_utils.h>
+
+TEST(binary_definition, convert) {
+
+  flecsi::io::simple_definition_t sd("simple2d-8x8.msh");
+  flecsi::io::write_binary_definition(sd, "simple2d-8x8.bin");
+
+  flecsi::io::binary_definition_u<2> bd("simple2d-8x8.bin");
+
+  CINCH_ASSERT(EQ, bd.num_entities(0), sd.num_entities(0));
+  CINCH_ASSERT(EQ, bd.num_entities(2), sd.num_entities(2));
+
+  for(size_t c(0); c < sd.num_entities(2); ++c) {
+    CINCH_ASSERT(EQ, bd.entities(2, 0, c), sd.entities(2, 0, c));
+
+    auto view = bd.entities_crs(2, 0)[c];
+    CINCH_ASSERT(EQ, flecsi::utils::to_vector(view), sd.entities(2, 0, c));
+  } // for
+
+  CINCH_ASSERT(EQ, bd.entities(2, 0), sd.entities(2, 0));
+
+  for(size_t v(0); v < sd.num_entities(0); ++v) {
+    auto coords = bd.vertex(v);
+    CINCH_ASSERT(EQ, coords[0], sd.vertex(v)[0]);
+    CINCH_ASSERT(EQ, coords[1], sd.vertex(v)[1]);
+  } // for
+
+} // TEST
+
+TEST(binary_definition, neighbors) {
+
+  flecsi::io::simple_definition_t sd("simple2d-8x8.msh");
+  flecsi::io::write_binary_definition(sd, "simple2d-8x8.bin");
+
+  flecsi::io::binary_definition_u<2> bd("simple2d-8x8.bin");
+
+  std::set<size_t> partition = {0, 1, 2, 3, 8, 9, 10, 11, 16, 17, 18, 19};
+
+  CINCH_ASSERT(EQ, (flecsi::topology::entity_neighbors<2, 2, 1>(bd, partition)),
+    (flecsi::topology::entity_neighbors<2, 2, 1>(sd, partition)));
+
+} // TEST
+
+TEST(binary_definition, mapped_range) {
+
+  flecsi::io::simple_definition_t sd("simple2d-8x8.msh");
+  flecsi::io::write_binary_definition(sd, "simple2d-8x8.bin");
+
+  auto header = flecsi::io::read_binary_mesh_header("simple2d-8x8.bin");
+
+  // Map only the offsets of cells [10, 20)
+  flecsi::io::mapped_file_t offsets("simple2d-8x8.bin",
+    header.offsets_offset(10), 11 * sizeof(std::uint64_t));
+  auto view = offsets.as<std::uint64_t>();
+
+  CINCH_ASSERT(EQ, view.size(), 11);
+  for(size_t c(10); c < 20; ++c) {
+    CINCH_ASSERT(EQ, view[c - 10 + 1] - view[c - 10],
+      sd.entities(2, 0, c).size());
+  } // for
+
+} // TEST
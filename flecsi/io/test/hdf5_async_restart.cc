@@ -0,0 +1,161 @@
+/*~-------------------------------------------------------------------------~~*
+ * Copyright (c) 2014 Los Alamos National Security, LLC
+ * All rights reserved.
+ *~-------------------------------------------------------------------------~~*/
+
+///
+/// \file
+///
+
+#include <string>
+
+#include <cinchtest.h>
+
+#include <flecsi/io/io_interface.h>
+#include <flecsi/supplemental/coloring/add_colorings.h>
+#include <flecsi/supplemental/mesh/test_mesh_2d.h>
+
+using namespace flecsi;
+using namespace supplemental;
+using mesh_t = flecsi::supplemental::test_mesh_2d_t;
+
+//---------------------------------------------------------------------------//
+// FleCSI tasks
+//---------------------------------------------------------------------------//
+
+// The values of the fields depend on the pass that wrote them, so that a
+// recovered checkpoint shows which state it holds.
+
+void
+write_task(data_client_handle_u<mesh_t, ro> mesh,
+  dense_accessor<int, rw, rw, na> f1,
+  sparse_mutator<double> f2,
+  int pass) {
+  auto & context = execution::context_t::instance();
+  const auto & map = context.index_map(cells);
+  for(auto c : mesh.cells(flecsi::owned)) {
+    auto id = map.at(c.id());
+    f1(c) = id + 1000 * pass;
+    if(id % 2 == 0) {
+      f2(c, 0) = 100 * id + pass;
+      f2(c, 2) = 100 * id + 2 + pass;
+    }
+    else {
+      f2(c, 1) = 100 * id + 1 + pass;
+    }
+  }
+} // write_task
+
+void
+read_task(data_client_handle_u<mesh_t, ro> mesh,
+  dense_accessor<int, ro, ro, ro> f1,
+  sparse_accessor<double, ro, ro, ro> f2,
+  int pass) {
+  auto & context = execution::context_t::instance();
+  const auto & map = context.index_map(cells);
+  for(auto c : mesh.cells()) {
+    auto id = map.at(c.id());
+    ASSERT_EQ(f1(c), id + 1000 * pass);
+    if(id % 2 == 0) {
+      ASSERT_EQ(f2(c, 0), 100 * id + pass);
+      ASSERT_EQ(f2(c, 2), 100 * id + 2 + pass);
+    }
+    else {
+      ASSERT_EQ(f2(c, 1), 100 * id + 1 + pass);
+    }
+  }
+} // read_task
+
+flecsi_register_task_simple(write_task, loc, index);
+flecsi_register_task_simple(read_task, loc, index);
+
+//---------------------------------------------------------------------------//
+// Data client registration
+//---------------------------------------------------------------------------//
+flecsi_register_data_client(mesh_t, meshes, mesh1);
+
+//---------------------------------------------------------------------------//
+// Fields
+//---------------------------------------------------------------------------//
+flecsi_register_field(mesh_t, fields, x, int, dense, 1, cells);
+flecsi_register_field(mesh_t, fields, y, double, sparse, 1, cells);
+
+//----------------------------------------------------------------------------//
+// Specialization driver.
+//----------------------------------------------------------------------------//
+
+namespace flecsi {
+namespace execution {
+
+void
+specialization_tlt_init(int argc, char ** argv) {
+  supplemental::do_test_mesh_2d_coloring();
+
+  context_t::sparse_index_space_info_t isi;
+  isi.index_space = index_spaces::cells;
+  isi.max_entries_per_index = 10;
+  isi.exclusive_reserve = 8192;
+  context_t::instance().set_sparse_index_space_info(isi);
+} // specialization_tlt_init
+
+void
+specialization_spmd_init(int argc, char ** argv) {
+  auto mh = flecsi_get_client_handle(mesh_t, meshes, mesh1);
+  flecsi_execute_task(initialize_mesh, flecsi::supplemental, index, mh);
+} // specialization_spmd_init
+
+//----------------------------------------------------------------------------//
+// User driver.
+//----------------------------------------------------------------------------//
+
+void
+driver(int argc, char ** argv) {
+
+  // The checkpoints are only written by the background thread if MPI
+  // supports it.
+  int provided;
+  MPI_Query_thread(&provided);
+  clog_rank(info, 0) << "MPI thread support: "
+                     << (provided == MPI_THREAD_MULTIPLE ? "multiple" : "other")
+                     << std::endl;
+
+  io::io_interface_t cp_io;
+  cp_io.ranks_per_file = 2;
+  const std::string first_outfile{"restart.async.first.rst."};
+  const std::string second_outfile{"restart.async.second.rst."};
+
+  auto ch = flecsi_get_client_handle(mesh_t, meshes, mesh1);
+
+  auto hx = flecsi_get_handle(ch, fields, x, int, dense, 0);
+  auto hym = flecsi_get_mutator(ch, fields, y, double, sparse, 0, 2);
+  auto hy = flecsi_get_handle(ch, fields, y, double, sparse, 0);
+
+  flecsi_execute_task_simple(write_task, index, ch, hx, hym, 0);
+  cp_io.checkpoint_all_fields_async(first_outfile);
+
+  // The second checkpoint is staged while the first one is being written,
+  // and the fields are changed again while the second one is.
+  flecsi_execute_task_simple(write_task, index, ch, hx, hym, 1);
+  cp_io.checkpoint_all_fields_async(second_outfile);
+
+  flecsi_execute_task_simple(write_task, index, ch, hx, hym, 2);
+
+  cp_io.wait_for_checkpoint();
+
+  // Each checkpoint holds the state of the fields when it was started.
+  cp_io.recover_all_fields(first_outfile);
+  flecsi_execute_task_simple(read_task, index, ch, hx, hy, 0);
+
+  cp_io.recover_all_fields(second_outfile);
+  flecsi_execute_task_simple(read_task, index, ch, hx, hy, 1);
+
+} // driver
+
+//----------------------------------------------------------------------------//
+// TEST.
+//----------------------------------------------------------------------------//
+
+TEST(async_restart, testname) {} // TEST
+
+} // namespace execution
+} // namespace flecsi
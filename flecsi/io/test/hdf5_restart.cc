@@ -148,6 +148,18 @@ driver(int argc, char ** argv) {
   auto hy = flecsi_get_handle(ch, fields, y, double, sparse, 0);
   flecsi_execute_task_simple(read_task, index, ch, hx, hy);
 
+  // The fields can be modified as soon as an asynchronous checkpoint has
+  // returned: the checkpoint holds its own copy of the data.
+  std::string async_outfile{"restart.async.rst."};
+  auto checkpoint = cp_io.checkpoint_all_fields_async(async_outfile);
+
+  flecsi_execute_task_simple(clear_task, index, ch, hx, hym);
+
+  checkpoint.wait();
+  cp_io.recover_all_fields(async_outfile);
+
+  flecsi_execute_task_simple(read_task, index, ch, hx, hy);
+
 } // driver
 
 //----------------------------------------------------------------------------//
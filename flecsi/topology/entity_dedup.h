@@ -0,0 +1,259 @@
+/*
+    @@@@@@@@  @@           @@@@@@   @@@@@@@@ @@
+   /@@/////  /@@          @@////@@ @@////// /@@
+   /@@       /@@  @@@@@  @@    // /@@       /@@
+   /@@@@@@@  /@@ @@///@@/@@       /@@@@@@@@@/@@
+   /@@////   /@@/@@@@@@@/@@       ////////@@/@@
+   /@@       /@@/@@//// //@@    @@       /@@/@@
+   /@@       @@@//@@@@@@ //@@@@@@  @@@@@@@@ /@@
+   //       ///  //////   //////  ////////  //
+
+   Copyright (c) 2016, Los Alamos National Security, LLC
+   All rights reserved.
+                                                                              */
+#pragma once
+
+/*! @file */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace flecsi {
+namespace topology {
+
+/*!
+  Open-addressing table used to create entities (edges, faces, ...) uniquely
+  from the vertices that define them.
+
+  Each key is the sorted list of vertex ids of an entity. Keys are stored
+  inline in one flat array with a fixed stride (the maximum number of
+  vertices per entity), so inserting a candidate entity never allocates.
+  Collisions are resolved with linear probing; the full hash of every
+  occupied slot is kept so that probing and rehashing rarely touch the keys.
+
+  @tparam ID The id type of the vertices and of the mapped entities. Two ids
+             are considered equal if their local_id() values are equal.
+
+  @ingroup topology
+ */
+
+template<typename ID>
+class entity_dedup_table_u
+{
+public:
+  using id_t = ID;
+  using key_t = std::uint64_t;
+
+  /*!
+    Constructor.
+
+    @param width    The maximum number of vertices of any entity. Entities
+                    with more vertices are still accepted, but widen the
+                    table (which requires a rehash).
+    @param expected The number of unique entities expected to be inserted.
+   */
+
+  entity_dedup_table_u(std::size_t width, std::size_t expected = 0)
+    : width_(std::max<std::size_t>(width, 1)), scratch_(width_) {
+    reserve(expected);
+  } // entity_dedup_table_u
+
+  /*!
+    Make room for at least \em n unique entities without rehashing.
+   */
+
+  void reserve(std::size_t n) {
+    std::size_t capacity = 16;
+    while(capacity * max_load_num < n * max_load_den)
+      capacity <<= 1;
+
+    if(capacity > capacity_)
+      rehash(capacity, width_);
+  } // reserve
+
+  /*!
+    Insert an entity unless an entity with the same vertices already
+    exists. The vertices do not need to be sorted.
+
+    @param vertices Pointer to the \em m vertex ids defining the entity.
+    @param m        The number of vertices.
+    @param value    The id to associate with the entity if it is new.
+
+    @return A pair holding the id associated with the entity and a flag
+            that is true if the entity was inserted by this call.
+   */
+
+  std::pair<id_t, bool>
+  insert(const id_t * vertices, std::size_t m, const id_t & value) {
+    if(m > scratch_.size())
+      scratch_.resize(m);
+
+    key_t * key = scratch_.data();
+    make_key(vertices, m, key);
+    return insert_key(key, m, hash(key, m), value);
+  } // insert
+
+  /*!
+    Insert an entity from a key built with make_key() and its hash. This
+    allows the keys of many entities to be built concurrently, leaving
+    only the probing to be done in order.
+
+    @param key   The \em m sorted vertex keys.
+    @param m     The number of vertices.
+    @param h     The hash of the key, as returned by hash().
+    @param value The id to associate with the entity if it is new.
+
+    @return A pair holding the id associated with the entity and a flag
+            that is true if the entity was inserted by this call.
+   */
+
+  std::pair<id_t, bool> insert_key(const key_t * key,
+    std::size_t m,
+    std::uint64_t h,
+    const id_t & value) {
+    if(m > width_)
+      rehash(capacity_, m);
+
+    if((size_ + 1) * max_load_den > capacity_ * max_load_num)
+      rehash(capacity_ << 1, width_);
+
+    const std::size_t mask = capacity_ - 1;
+
+    for(std::size_t slot = h & mask;; slot = (slot + 1) & mask) {
+      if(counts_[slot] == 0) {
+        std::copy(key, key + m, keys_.begin() + slot * width_);
+        counts_[slot] = static_cast<std::uint32_t>(m);
+        hashes_[slot] = h;
+        values_[slot] = value;
+        ++size_;
+        return {value, true};
+      } // if
+
+      if(hashes_[slot] == h && counts_[slot] == m &&
+         std::equal(key, key + m, keys_.begin() + slot * width_)) {
+        return {values_[slot], false};
+      } // if
+    } // for
+  } // insert_key
+
+  /*!
+    Build the key of an entity, i.e., its sorted vertex keys, so that the
+    same entity always produces the same key, independent of the order of
+    its vertices.
+
+    @param vertices Pointer to the \em m vertex ids defining the entity.
+    @param m        The number of vertices.
+    @param key      Storage for \em m keys.
+   */
+
+  static void make_key(const id_t * vertices, std::size_t m, key_t * key) {
+    for(std::size_t i{0}; i < m; ++i) {
+      key_t k = vertices[i].local_id();
+      std::size_t j = i;
+      for(; j > 0 && key[j - 1] > k; --j)
+        key[j] = key[j - 1];
+      key[j] = k;
+    } // for
+  } // make_key
+
+  /*!
+    Hash a key built with make_key().
+   */
+
+  static std::uint64_t hash(const key_t * key, std::size_t m) {
+    std::uint64_t h = 0x9e3779b97f4a7c15ull ^ m;
+    for(std::size_t i{0}; i < m; ++i)
+      h = mix(h ^ (key[i] + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2)));
+    return h;
+  } // hash
+
+  /*!
+    Return the number of unique entities in the table.
+   */
+
+  std::size_t size() const {
+    return size_;
+  } // size
+
+  /*!
+    Return the number of slots in the table.
+   */
+
+  std::size_t capacity() const {
+    return capacity_;
+  } // capacity
+
+  /*!
+    Return the maximum number of vertices per entity that can be stored
+    without widening the table.
+   */
+
+  std::size_t width() const {
+    return width_;
+  } // width
+
+private:
+  // Keep the table at most 70% full.
+  static constexpr std::size_t max_load_num = 7;
+  static constexpr std::size_t max_load_den = 10;
+
+  // 64-bit finalizer from MurmurHash3.
+  static std::uint64_t mix(std::uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb93e63fe1a85ull;
+    x ^= x >> 33;
+    return x;
+  } // mix
+
+  void rehash(std::size_t capacity, std::size_t width) {
+    std::vector<key_t> keys(capacity * width);
+    std::vector<std::uint32_t> counts(capacity, 0);
+    std::vector<std::uint64_t> hashes(capacity);
+    std::vector<id_t> values(capacity);
+
+    const std::size_t mask = capacity - 1;
+
+    for(std::size_t s{0}; s < capacity_; ++s) {
+      if(counts_[s] == 0)
+        continue;
+
+      std::size_t slot = hashes_[s] & mask;
+      while(counts[slot] != 0)
+        slot = (slot + 1) & mask;
+
+      std::copy(keys_.begin() + s * width_,
+        keys_.begin() + s * width_ + counts_[s],
+        keys.begin() + slot * width);
+      counts[slot] = counts_[s];
+      hashes[slot] = hashes_[s];
+      values[slot] = values_[s];
+    } // for
+
+    keys_.swap(keys);
+    counts_.swap(counts);
+    hashes_.swap(hashes);
+    values_.swap(values);
+    capacity_ = capacity;
+    width_ = width;
+  } // rehash
+
+  std::size_t width_;
+  std::size_t capacity_ = 0;
+  std::size_t size_ = 0;
+
+  std::vector<key_t> keys_;
+  std::vector<std::uint32_t> counts_; // zero marks an empty slot
+  std::vector<std::uint64_t> hashes_;
+  std::vector<id_t> values_;
+
+  std::vector<key_t> scratch_;
+
+}; // class entity_dedup_table_u
+
+} // namespace topology
+} // namespace flecsi
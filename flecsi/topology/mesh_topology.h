@@ -17,6 +17,7 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstring>
@@ -28,7 +29,9 @@
 #include <unordered_map>
 #include <vector>
 
+#include <flecsi/concurrency/parallel_for.h>
 #include <flecsi/execution/context.h>
+#include <flecsi/topology/entity_dedup.h>
 #include <flecsi/topology/mesh_storage.h>
 #include <flecsi/topology/mesh_types.h>
 #include <flecsi/topology/partition.h>
@@ -311,6 +314,25 @@ public:
     compute_bindings_u<DOM, std::tuple_size<BT>::value, BT>::compute(*this);
   } // init
 
+  //------------------------------------------------------------------------//
+  //! Same as init(), but the construction of entities and connectivities is
+  //! spread over the threads of the given pool. The calling thread takes
+  //! part in the work.
+  //!
+  //! \remark The create_entities() methods of the cell types of the mesh
+  //! policy are called concurrently, and must not modify shared state.
+  //!
+  //! @tparam DOM domain
+  //!
+  //! @param pool the thread pool to use
+  //------------------------------------------------------------------------//
+  template<size_t DOM = 0>
+  void init(thread_pool & pool) {
+    pool_ = &pool;
+    init<DOM>();
+    pool_ = nullptr;
+  } // init
+
   //--------------------------------------------------------------------------//
   //! Similar to init(), but only compute bindings. This method should be called
   //! when a domain is sparse, i.e: missing certain entity types such as cells
@@ -1173,15 +1195,6 @@ private:
     connectivity_t & cell_to_entity =
       get_connectivity_(Domain, UsingDimension, DimensionToBuild);
 
-    // Storage for entity-to-vertex connectivity information.
-    connection_vector_t entity_vertex_conn;
-
-    // Helper variables
-    size_t max_cell_entity_conns = 1;
-
-    // keep track of the local ids, since they may be added out of order
-    std::vector<size_t> entity_ids;
-
     domain_connectivity_u<MESH_TYPE::num_dimensions> & dc =
       this->storage.topology[Domain][Domain];
 
@@ -1191,35 +1204,23 @@ private:
 
     const size_t _num_cells = num_entities<UsingDimension, Domain>();
 
-    // Storage for cell-to-entity connectivity information.
-    connection_vector_t cell_entity_conn(_num_cells);
-
-    // This map is primarily used to make sure that entities are not
-    // created multiple times, i.e., that they are unique.  The
-    // emplace method of the map is used to only define a new entity
-    // if it does not already exist in the map.
-
-    // hash use for mapping in building topology connectivity
-    struct id_vector_hash_t {
-      size_t operator()(const std::vector<id_t> & v) const {
-        size_t h = 0;
-        for(auto id : v) {
-          h |= static_cast<size_t>(id.entity());
-        } // for
-
-        return h;
-      } // operator()
-    }; // struct id_vector_hash_t
-
-    // used when building the topology connectivities
-    using id_vector_map_t =
-      std::unordered_map<std::vector<id_t>, id_t, id_vector_hash_t>;
-
-    id_vector_map_t entity_vertices_map;
+    // No entity created from a cell can have more vertices than the cell
+    // itself, so this bounds the width of the keys in the dedup table.
+    size_t max_cell_vertices = 1;
+    for(size_t c{0}; c < cell_to_vertex.from_size(); ++c) {
+      auto r = cell_to_vertex.range(c);
+      max_cell_vertices = std::max(max_cell_vertices, r.second - r.first);
+    } // for
 
-    // This buffer should be large enough to hold all entities
-    // vertices that potentially need to be created
-    std::array<id_t, 4096> entity_vertices;
+    // This table is primarily used to make sure that entities are not
+    // created multiple times, i.e., that they are unique. An entity is
+    // only defined if its sorted vertices are not already in the table.
+    // It is presized from the number of cells, and resized once the
+    // number of entities per cell is known.
+    using dedup_table_t = entity_dedup_table_u<id_t>;
+    using key_t = typename dedup_table_t::key_t;
+    dedup_table_t entity_vertices_map(max_cell_vertices, _num_cells);
+    bool entity_vertices_map_sized = false;
 
     using cell_type = entity_type<UsingDimension, Domain>;
     using entity_type = entity_type<DimensionToBuild, Domain>;
@@ -1255,146 +1256,239 @@ private:
     auto has_intermediate_map = !reverse_intermediate_map.empty();
 
     // Get the index map for the entity.
-    auto & entity_index_map = context_.reverse_index_map(entity_index_space);
+    const auto & entity_index_map =
+      context_.reverse_index_map(entity_index_space);
 
     // Get the map of the vertex ids. This map takes
     // local compacted vertex ids to mesh index space ids.
     // CIS -> MIS.
-    auto & vertex_map = context_.index_map(vertex_index_space);
+    const auto & vertex_map = context_.index_map(vertex_index_space);
 
-    // a counter for added entityes
-    size_t entity_counter{0};
+    // The cells, in the order in which they create entities.
+    std::vector<size_t> cells;
+    cells.reserve(gis_to_cis.size());
+    for(const auto & citr : gis_to_cis) {
+      cells.push_back(citr.second);
+    } // for
 
-    for(auto & citr : gis_to_cis) {
-      size_t c = citr.second;
+    // The number of entities of each cell, and the local ids of these
+    // entities in the order in which the cells are visited.
+    index_vector_t cell_counts(_num_cells, 0);
+    id_vector_t cell_entities;
 
-      // Get the cell object
-      const auto cell = &cis.get_offset(c);
-      id_t cell_id = cell->global_id();
+    // The vertices of the created entities, in order of creation.
+    index_vector_t entity_counts;
+    id_vector_t entity_vertices;
+    std::vector<size_t> entity_ids;
 
-      // Get storage reference.
-      id_vector_t & conns = cell_entity_conn[c];
+    // Candidate entities created by the cells of one chunk. Besides the
+    // vertices, we keep the sorted keys and hashes used by the dedup table,
+    // and the id of the entity if it is given by the intermediate map.
+    struct candidates_t {
+      std::vector<uint32_t> counts;
+      std::vector<id_t> vertices;
+      std::vector<key_t> keys;
+      std::vector<uint64_t> hashes;
+      std::vector<size_t> ids;
+    }; // struct candidates_t
+
+    // Cells are processed in batches, so that the candidates do not have
+    // to be stored for the whole mesh at once.
+    constexpr size_t batch_size = 1 << 16;
 
-      // Try to optimize storage.
-      conns.reserve(max_cell_entity_conns);
+    // a counter for added entityes
+    size_t entity_counter{0};
 
-      // This call allows the users specialization to create
-      // whatever entities are needed to complete the mesh.
-      //
-      // p.first:   The number of entities per cell.
-      // p.second:  A std::vector of id_t containing the ids of the
-      //            vertices that define the entity.
-      auto sv = cell->create_entities(
-        cell_id, DimensionToBuild, dc, entity_vertices.data());
-
-      size_t n = sv.size();
-
-      // iterate over the newly-defined entities
-      for(size_t i = 0, pos = 0; i < n; ++i) {
-        size_t m = sv[i];
-
-        // Get the vertices that define this entity by getting
-        // a pointer to the vector-of-vector data and then constructing
-        // a vector of ids for only this entity.
-        id_t * a = &entity_vertices[pos];
-        std::vector<id_t> ev(a, a + m);
-
-        // Sort the ids for the current entity so that they are
-        // monotonically increasing. This ensures that entities are
-        // created uniquely (using emplace_back below) because the ids
-        // will always occur in the same order for the same entity.
-        std::sort(ev.begin(), ev.end());
-
-        //
-        // The following set of steps use the vertices that define
-        // the entity to be created to lookup the id so
-        // that the topology creates it at the correct offset.
-        // This requires:
-        //
-        // 1) lookup the MIS vertex ids
-        // 2) create a vector of the MIS vertex ids
-        // 3) lookup the MIS id of the entity
-        // 4) lookup the CIS id of the entity
-        //
-        // The CIS id of the entity is passed to the create_entity
-        // method. The specialization developer must pass this
-        // information to 'make' so that the coloring id of the
-        // entity is consitent with the id/offset of the entity
-        // created by the topology.
-        //
-
-        size_t entity_id;
-        if(has_intermediate_map) {
+    for(size_t batch{0}; batch < cells.size(); batch += batch_size) {
+      const size_t batch_cells = std::min(batch_size, cells.size() - batch);
+      const parallel_range_t range(pool_, batch_cells, 256);
+      std::vector<candidates_t> candidates(range.size());
+
+      // Let the cells create their entities and build the keys of these
+      // entities. This only reads the mesh and is done concurrently.
+      parallel_for(
+        pool_, range, [&](size_t chunk, size_t first, size_t last) {
+          candidates_t & cand = candidates[chunk];
+
+          // This buffer should be large enough to hold all entities
+          // vertices that potentially need to be created
+          std::array<id_t, 4096> buffer;
 
           std::vector<size_t> vertices_mis;
-          vertices_mis.reserve(m);
 
-          // Push the MIS vertex ids onto a vector to search for the
-          // associated entity.
-          for(id_t * aptr{a}; aptr < (a + m); ++aptr) {
-            vertices_mis.push_back(vertex_map[aptr->entity()]);
+          for(size_t k{batch + first}; k < batch + last; ++k) {
+            size_t c = cells[k];
+
+            // Get the cell object
+            const auto cell = &cis.get_offset(c);
+            id_t cell_id = cell->global_id();
+
+            // This call allows the users specialization to create
+            // whatever entities are needed to complete the mesh. It
+            // returns the number of vertices of each entity, and writes
+            // the vertices into the buffer.
+            auto sv =
+              cell->create_entities(cell_id, DimensionToBuild, dc, buffer.data());
+
+            size_t n = sv.size();
+            cell_counts[c] = n;
+
+            // iterate over the newly-defined entities
+            for(size_t i = 0, pos = 0; i < n; ++i) {
+              size_t m = sv[i];
+              id_t * a = &buffer[pos];
+
+              cand.counts.push_back(static_cast<uint32_t>(m));
+              cand.vertices.insert(cand.vertices.end(), a, a + m);
+
+              // The dedup table sorts the vertices, so that the same
+              // entity is always found, independent of the order in which
+              // the cells list them.
+              cand.keys.resize(cand.keys.size() + m);
+              key_t * key = cand.keys.data() + cand.keys.size() - m;
+              dedup_table_t::make_key(a, m, key);
+              cand.hashes.push_back(dedup_table_t::hash(key, m));
+
+              //
+              // The following set of steps use the vertices that define
+              // the entity to be created to lookup the id so
+              // that the topology creates it at the correct offset.
+              // This requires:
+              //
+              // 1) lookup the MIS vertex ids
+              // 2) create a vector of the MIS vertex ids
+              // 3) lookup the MIS id of the entity
+              // 4) lookup the CIS id of the entity
+              //
+              // The CIS id of the entity is passed to the create_entity
+              // method. The specialization developer must pass this
+              // information to 'make' so that the coloring id of the
+              // entity is consitent with the id/offset of the entity
+              // created by the topology.
+              //
+              if(has_intermediate_map) {
+                vertices_mis.clear();
+
+                // Push the MIS vertex ids onto a vector to search for the
+                // associated entity.
+                for(id_t * aptr{a}; aptr < (a + m); ++aptr) {
+                  vertices_mis.push_back(vertex_map.at(aptr->entity()));
+                } // for
+
+                // Lookup the MIS id of the entity.
+                std::sort(vertices_mis.begin(), vertices_mis.end());
+                const auto entity_id_mis =
+                  reverse_intermediate_map.at(vertices_mis);
+
+                // Lookup the CIS id of the entity.
+                cand.ids.push_back(entity_index_map.at(entity_id_mis));
+              } // if
+
+              // pos keeps track of the current array index when looping
+              // through results of create_entities
+              pos += m;
+            } // for
           } // for
+        });
 
-          // Lookup the MIS id of the entity.
-          std::sort(vertices_mis.begin(), vertices_mis.end());
-          const auto entity_id_mis = reverse_intermediate_map.at(vertices_mis);
+      // Most entities are shared by at least two cells, so half the
+      // entities of the first cell times the number of cells is a good
+      // estimate of the number of unique entities.
+      if(!entity_vertices_map_sized && batch_cells) {
+        entity_vertices_map.reserve(
+          _num_cells * std::max<size_t>(cell_counts[cells[0]] / 2, 1));
+        entity_vertices_map_sized = true;
+      } // if
 
-          // Lookup the CIS id of the entity.
-          entity_id = entity_index_map.at(entity_id_mis);
-        }
-        else {
+      // Insert the candidates in order, so that entities are numbered in
+      // the order in which the cells are visited.
+      for(size_t chunk{0}; chunk < range.size(); ++chunk) {
+        const candidates_t & cand = candidates[chunk];
+        size_t e = 0, pos = 0;
 
-          entity_id = entity_counter;
+        for(size_t k{batch + range.first(chunk)}; k < batch + range.last(chunk);
+            ++k) {
+          size_t c = cells[k];
+          id_t cell_id = cis.get_offset(c).global_id();
 
-        } // intermediate_map
+          for(size_t i{0}; i < cell_counts[c]; ++i, ++e) {
+            size_t m = cand.counts[e];
 
-        id_t id = id_t::make<DimensionToBuild, Domain>(entity_id, color);
+            size_t entity_id =
+              has_intermediate_map ? cand.ids[e] : entity_counter;
 
-        // Emplace the sorted vertices into the entity map
-        auto itr = entity_vertices_map.emplace(std::move(ev),
-          id_t::make<DimensionToBuild, Domain>(entity_id, cell_id.partition()));
+            id_t id = id_t::make<DimensionToBuild, Domain>(entity_id, color);
 
-        // Add this id to the cell to entity connections
-        conns.push_back(itr.first->second.entity());
+            // Insert the vertices into the entity table
+            auto itr = entity_vertices_map.insert_key(&cand.keys[pos], m,
+              cand.hashes[e],
+              id_t::make<DimensionToBuild, Domain>(
+                entity_id, cell_id.partition()));
 
-        // If the insertion took place
-        if(itr.second) {
+            // Add this id to the cell to entity connections
+            cell_entities.push_back(itr.first.entity());
 
-          // what does this do?
-          auto ev2 = id_vector_t(m);
-          for(unsigned i = 0; i < m; ++i)
-            ev2[i] = (a + i)->entity();
-          entity_vertex_conn.emplace_back(std::move(ev2));
-          entity_ids.emplace_back(entity_id);
+            // If the insertion took place
+            if(itr.second) {
 
-          max_cell_entity_conns = std::max(max_cell_entity_conns, conns.size());
+              // keep the entity to vertex connections
+              entity_counts.push_back(m);
+              for(size_t j{0}; j < m; ++j)
+                entity_vertices.push_back(cand.vertices[pos + j].entity());
+              entity_ids.emplace_back(entity_id);
 
-          auto ent =
-            MESH_TYPE::template create_entity<Domain, DimensionToBuild>(
-              this, m, id);
+              auto ent =
+                MESH_TYPE::template create_entity<Domain, DimensionToBuild>(
+                  this, m, id);
 
-          ++entity_counter;
+              ++entity_counter;
 
-        } // if
-
-        // pos keeps track of the current array index when looping through
-        // results of create_entities
-        pos += m;
+            } // if
 
+            pos += m;
+          } // for
+        } // for
       } // for
     } // for
 
-    // sort the entity connectivity. Entities may have been created out of
-    // order.  Sort them using the list of entity ids we kept track of
-    if(has_intermediate_map)
-      utils::reorder_destructive(
-        entity_ids.begin(), entity_ids.end(), entity_vertex_conn.begin());
+    // Set the connectivity information from the cells to the created
+    // entities. Cells may not have been visited in order, so the rows are
+    // scattered to their final offsets.
+    cell_to_entity.resize(cell_counts);
+
+    std::vector<size_t> visit_offsets(cells.size() + 1, 0);
+    for(size_t k{0}; k < cells.size(); ++k) {
+      visit_offsets[k + 1] = visit_offsets[k] + cell_counts[cells[k]];
+    } // for
+
+    parallel_for(pool_, cells.size(), [&](size_t k) {
+      for(size_t i{visit_offsets[k]}; i < visit_offsets[k + 1]; ++i) {
+        cell_to_entity.set(cells[k], cell_entities[i], i - visit_offsets[k]);
+      } // for
+    });
 
     // Set the connectivity information from the created entities to
-    // the vertices.
+    // the vertices. Entities may have been created out of order, so
+    // the rows are placed using the list of entity ids we kept track of.
+    const size_t num_created = entity_ids.size();
+
+    index_vector_t entity_to_vertex_counts(num_created, 0);
+    std::vector<size_t> entity_offsets(num_created + 1, 0);
+    for(size_t k{0}; k < num_created; ++k) {
+      assert(entity_ids[k] < num_created && "invalid entity id");
+      entity_to_vertex_counts[entity_ids[k]] = entity_counts[k];
+      entity_offsets[k + 1] = entity_offsets[k] + entity_counts[k];
+    } // for
+
     auto & entity_to_vertex = dc.template get<DimensionToBuild>(0);
-    entity_to_vertex.init(entity_vertex_conn);
-    cell_to_entity.init(cell_entity_conn);
+    entity_to_vertex.resize(entity_to_vertex_counts);
+
+    parallel_for(pool_, num_created, [&](size_t k) {
+      for(size_t i{entity_offsets[k]}; i < entity_offsets[k + 1]; ++i) {
+        entity_to_vertex.set(
+          entity_ids[k], entity_vertices[i], i - entity_offsets[k]);
+      } // for
+    });
   } // build_connectivity
 
   //--------------------------------------------------------------------------//
@@ -1420,26 +1514,37 @@ private:
 
     // get the list of "to" entities
     const auto & to_entities = entities<TO_DIM, TO_DOM>();
+    const size_t num_from_ent = num_entities_(FROM_DIM, FROM_DOM);
 
-    index_vector_t pos(num_entities_(FROM_DIM, FROM_DOM), 0);
+    // Count how many connectivities go into each slot. Several "to"
+    // entities may connect to the same "from" entity, so the counters
+    // are atomic.
+    std::unique_ptr<std::atomic<uint32_t>[]> counts(
+      new std::atomic<uint32_t>[num_from_ent]());
 
-    // Count how many connectivities go into each slot
-    for(auto to_entity : to_entities) {
+    parallel_for(pool_, to_entities.size(), [&](size_t t) {
+      auto to_entity = to_entities[t];
       for(auto from_id : entity_ids<FROM_DIM, TO_DOM, FROM_DOM>(to_entity)) {
-        ++pos[from_id];
+        counts[from_id].fetch_add(1, std::memory_order_relaxed);
       }
-    }
+    });
 
-    out_conn.resize(pos);
+    index_vector_t pos(num_from_ent);
+    for(size_t i{0}; i < num_from_ent; ++i) {
+      pos[i] = counts[i].load(std::memory_order_relaxed);
+      counts[i].store(0, std::memory_order_relaxed);
+    } // for
 
-    std::fill(pos.begin(), pos.end(), 0);
+    out_conn.resize(pos);
 
-    // now do the actual transpose
-    for(auto to_entity : to_entities) {
+    // now do the actual transpose, writing straight into the connectivity
+    parallel_for(pool_, to_entities.size(), [&](size_t t) {
+      auto to_entity = to_entities[t];
       for(auto from_lid : entity_ids<FROM_DIM, TO_DOM, FROM_DOM>(to_entity)) {
-        out_conn.set(from_lid, to_entity, pos[from_lid]++);
+        out_conn.set(from_lid, to_entity,
+          counts[from_lid].fetch_add(1, std::memory_order_relaxed));
       }
-    }
+    });
 
     // now we need to sort the connecvtivity arrays:
     // .. we have to make sure the order of connectivity information apears in
@@ -1456,10 +1561,12 @@ private:
     const auto & to_cis_to_gis = context_.index_map(to_index_space);
     const auto & to_ids = entity_ids<TO_DIM, TO_DOM>();
 
-    // do the final sort of the connectivity arrays
-    for(auto from_id : entity_ids<FROM_DIM, FROM_DOM>()) {
+    // do the final sort of the connectivity arrays. This also makes the
+    // result independent of the order in which the entries were filled.
+    const auto & from_ids = entity_ids<FROM_DIM, FROM_DOM>();
+    parallel_for(pool_, from_ids.size(), [&](size_t f) {
       // get the connectivity array
-      const auto conn = out_conn.get_entities(from_id.entity());
+      const auto conn = out_conn.get_entities(from_ids[f].entity());
       // pack it into a list of id and global id pairs
       std::vector<std::pair<std::size_t, id_t>> gids(conn.size());
       std::transform(conn.begin(), conn.end(), gids.begin(), [&](auto id) {
@@ -1472,7 +1579,7 @@ private:
       // upack the results
       std::transform(gids.begin(), gids.end(), conn.begin(),
         [](auto id_pair) { return id_pair.second.entity(); });
-    }
+    });
   } // transpose
 
   //--------------------------------------------------------------------------//
@@ -1505,16 +1612,6 @@ private:
 
     // the number of each entity type
     auto num_from_ent = num_entities_(FROM_DIM, FROM_DOM);
-    auto num_to_ent = num_entities_(TO_DIM, FROM_DOM);
-
-    // Temporary storage for connection id's
-    connection_vector_t conns(num_from_ent);
-
-    // Keep track of which to id's we have visited
-    using visited_vec = std::vector<bool>;
-    visited_vec visited(num_to_ent);
-
-    size_t max_size = 1;
 
     // Read connectivities
     connectivity_t & c = get_connectivity_(FROM_DOM, FROM_DIM, DIM);
@@ -1523,73 +1620,99 @@ private:
     connectivity_t & c2 = get_connectivity_(TO_DOM, TO_DIM, DIM);
     assert(!c2.empty());
 
-    // Iterate through entities in "from" topological dimension
-    for(auto from_entity : entities<FROM_DIM, FROM_DOM>()) {
-
-      id_t from_id = from_entity->global_id();
-      id_vector_t & ents = conns[from_id.entity()];
-      ents.reserve(max_size);
-
-      // Create a copy of to vertices so they can be sorted
-      auto from_verts = c.get_entities_vec(from_id.entity());
-      // sort so we have a unique key for from vertices
-      std::sort(from_verts.begin(), from_verts.end());
-
-      // initially set all to id's to unvisited
-      for(auto from_ent2 : entities<DIM, FROM_DOM>(from_entity)) {
-        for(auto to_id : entity_ids<TO_DIM, TO_DOM>(from_ent2)) {
-          visited[to_id] = false;
-        }
-      }
+    const auto from_entities = entities<FROM_DIM, FROM_DOM>();
+    const parallel_range_t range(pool_, from_entities.size());
 
-      // Loop through each from entity again
-      for(auto from_ent2 : entities<DIM, FROM_DOM>(from_entity)) {
-        for(auto to_id : entity_ids<TO_DIM, TO_DOM>(from_ent2)) {
+    // The number of connections of each "from" entity, and the
+    // connections found by each chunk, in the order of its entities.
+    index_vector_t counts(num_from_ent, 0);
+    std::vector<id_vector_t> chunk_conns(range.size());
 
-          // If we have already visited, skip
-          if(visited[to_id]) {
-            continue;
-          } // if
+    // Iterate through entities in "from" topological dimension
+    parallel_for(pool_, range, [&](size_t chunk, size_t first, size_t last) {
+      id_vector_t & ents = chunk_conns[chunk];
+
+      // Keep track of which to id's we have visited for the current
+      // entity. There are only a few of them, so a linear search is
+      // faster than a mesh-sized flag array, which would also have to be
+      // duplicated for every thread.
+      id_vector_t visited;
+
+      for(size_t f{first}; f < last; ++f) {
+        auto from_entity = from_entities[f];
+
+        id_t from_id = from_entity->global_id();
+        const size_t start = ents.size();
+        visited.clear();
+
+        // Create a copy of to vertices so they can be sorted
+        auto from_verts = c.get_entities_vec(from_id.entity());
+        // sort so we have a unique key for from vertices
+        std::sort(from_verts.begin(), from_verts.end());
+
+        // Loop through each from entity
+        for(auto from_ent2 : entities<DIM, FROM_DOM>(from_entity)) {
+          for(auto to_id : entity_ids<TO_DIM, TO_DOM>(from_ent2)) {
+
+            // If we have already visited, skip
+            if(std::find(visited.begin(), visited.end(), to_id) !=
+               visited.end()) {
+              continue;
+            } // if
 
-          visited[to_id] = true;
+            visited.push_back(to_id);
 
-          // If the topological dimensions are the same, always add to id
-          if(FROM_DIM == TO_DIM) {
-            if(from_id.entity() != to_id) {
-              ents.push_back(to_id);
-            } // if
-          }
-          else {
-            // Create a copy of to vertices so they can be sorted
-            auto to_verts = c2.get_entities_vec(to_id);
-            // Sort to verts so we can do an inclusion check
-            std::sort(to_verts.begin(), to_verts.end());
-
-            // If from vertices contains the to vertices add to id
-            // to this connection set
-            if(DIM < TO_DIM) {
-              if(std::includes(from_verts.begin(), from_verts.end(),
-                   to_verts.begin(), to_verts.end()))
-                ents.emplace_back(to_id);
+            // If the topological dimensions are the same, always add to id
+            if(FROM_DIM == TO_DIM) {
+              if(from_id.entity() != to_id) {
+                ents.push_back(to_id);
+              } // if
             }
-            // If we are going through a higher level, then set
-            // intersection is sufficient. i.e. one set does not need to
-            // be a subset of the other
             else {
-              if(utils::intersects(from_verts.begin(), from_verts.end(),
-                   to_verts.begin(), to_verts.end()))
-                ents.emplace_back(to_id);
-            } // if
+              // Create a copy of to vertices so they can be sorted
+              auto to_verts = c2.get_entities_vec(to_id);
+              // Sort to verts so we can do an inclusion check
+              std::sort(to_verts.begin(), to_verts.end());
+
+              // If from vertices contains the to vertices add to id
+              // to this connection set
+              if(DIM < TO_DIM) {
+                if(std::includes(from_verts.begin(), from_verts.end(),
+                     to_verts.begin(), to_verts.end()))
+                  ents.emplace_back(to_id);
+              }
+              // If we are going through a higher level, then set
+              // intersection is sufficient. i.e. one set does not need to
+              // be a subset of the other
+              else {
+                if(utils::intersects(from_verts.begin(), from_verts.end(),
+                     to_verts.begin(), to_verts.end()))
+                  ents.emplace_back(to_id);
+              } // if
 
-          } // if
+            } // if
+          } // for
         } // for
+
+        counts[from_id.entity()] = ents.size() - start;
       } // for
+    });
 
-      max_size = std::max(ents.size(), max_size);
-    } // for
+    // Finally create the connection: size it from the counts, then copy
+    // the connections found by each chunk into place.
+    out_conn.resize(counts);
 
-    // Finally create the connection from the temporary conns
-    out_conn.init(conns);
+    parallel_for(pool_, range, [&](size_t chunk, size_t first, size_t last) {
+      const id_vector_t & ents = chunk_conns[chunk];
+      size_t pos = 0;
+
+      for(size_t f{first}; f < last; ++f) {
+        const size_t from = from_entities[f]->global_id().entity();
+        for(size_t i{0}; i < counts[from]; ++i) {
+          out_conn.set(from, ents[pos++], i);
+        } // for
+      } // for
+    });
 
   } // intersect
 
@@ -1869,7 +1992,7 @@ private:
 
     // Iterate over cells (this lets us iterate in the order of the global
     // index space)
-    for(auto & cell_itr : cell_gis_to_cis) {
+    for(const auto & cell_itr : cell_gis_to_cis) {
 
       // Get the cell object
       auto c = cell_itr.second;
@@ -2123,6 +2246,10 @@ private:
     return get_connectivity_(domain, domain, from_dim, to_dim);
   } // get_connectivity
 
+  // The pool used to build the topology in parallel (see init()), or
+  // nullptr to build it on the calling thread.
+  thread_pool * pool_ = nullptr;
+
 }; // class mesh_topology_u
 
 } // namespace topology
@@ -0,0 +1,69 @@
+/*~-------------------------------------------------------------------------~~*
+ * Copyright (c) 2014 Los Alamos National Security, LLC
+ * All rights reserved.
+ *~-------------------------------------------------------------------------~~*/
+
+#include <cinchtest.h>
+
+#include <flecsi/topology/entity_dedup.h>
+#include <flecsi/utils/id.h>
+
+#include <array>
+
+using entity_id_t = flecsi::utils::id_<20, 40, 4, 60>;
+using table_t = flecsi::topology::entity_dedup_table_u<entity_id_t>;
+
+// Inserting the same vertices in any order must find the same entity.
+TEST(entity_dedup, permutations) {
+
+  table_t table(4);
+
+  std::array<entity_id_t, 4> quad{
+    entity_id_t(7), entity_id_t(3), entity_id_t(11), entity_id_t(5)};
+  auto r0 = table.insert(quad.data(), 4, entity_id_t(0));
+  ASSERT_TRUE(r0.second);
+  ASSERT_EQ(r0.first.entity(), 0);
+
+  std::array<entity_id_t, 4> rotated{
+    entity_id_t(11), entity_id_t(5), entity_id_t(7), entity_id_t(3)};
+  auto r1 = table.insert(rotated.data(), 4, entity_id_t(1));
+  ASSERT_FALSE(r1.second);
+  ASSERT_EQ(r1.first.entity(), 0);
+
+  // A subset of the same vertices is a different entity.
+  auto r2 = table.insert(quad.data(), 3, entity_id_t(2));
+  ASSERT_TRUE(r2.second);
+  ASSERT_EQ(r2.first.entity(), 2);
+
+  ASSERT_EQ(table.size(), 2);
+} // TEST
+
+// Edges of a structured grid, which used to collide heavily, must all be
+// found again after growing the table and widening its keys.
+TEST(entity_dedup, grow) {
+
+  constexpr size_t n = 200;
+  table_t table(1);
+
+  size_t created = 0;
+  for(size_t pass = 0; pass < 2; ++pass) {
+    for(size_t j = 0; j < n; ++j) {
+      for(size_t i = 0; i + 1 < n; ++i) {
+        std::array<entity_id_t, 2> e{
+          entity_id_t(j * n + i + 1), entity_id_t(j * n + i)};
+        if(pass)
+          std::swap(e[0], e[1]);
+        auto r = table.insert(e.data(), 2, entity_id_t(created));
+        if(r.second)
+          ++created;
+        else
+          ASSERT_EQ(r.first.entity(), j * (n - 1) + i);
+      } // for
+    } // for
+  } // for
+
+  ASSERT_EQ(created, n * (n - 1));
+  ASSERT_EQ(table.size(), n * (n - 1));
+  ASSERT_GE(table.width(), 2);
+  ASSERT_LE(table.size() * 10, table.capacity() * 7);
+} // TEST
@@ -0,0 +1,180 @@
+#include <cinchtest.h>
+#include <cmath>
+#include <iostream>
+#include <set>
+
+#include "pseudo_random.h"
+#include <flecsi/topology/tree_topology.h>
+
+using namespace std;
+using namespace flecsi;
+
+class tree_policy
+{
+public:
+  using branch_int_t = uint64_t;
+
+  static const size_t dimension = 2;
+
+  using element_t = double;
+
+  using storage_t = topology::morton_tree_storage_t;
+
+  using point_t = point_u<element_t, dimension>;
+
+  class entity
+  {
+  public:
+    entity(const point_t & p) : coordinates_(p) {}
+
+    const point_t & coordinates() const {
+      return coordinates_;
+    }
+
+    void move(const point_t & offset) {
+      coordinates_ += offset;
+    }
+
+  private:
+    point_t coordinates_;
+  };
+
+  using entity_t = entity;
+};
+
+using tree_topology_u = topology::tree_topology<tree_policy>;
+using entity_t = tree_topology_u::entity_t;
+using point_t = tree_topology_u::point_t;
+using branch_t = tree_topology_u::branch_t;
+using element_t = tree_topology_u::element_t;
+
+// Check that every branch is the concatenation of its children and that
+// the entities of every leaf lie in it.
+void
+check_branch(tree_topology_u & t, const branch_t & b) {
+  if(b.is_leaf()) {
+    for(auto ent : t.entities(b)) {
+      auto & leaf = t.find_parent(tree_topology_u::branch_id_t(
+        {{{0, 0}, {50, 30}}}, ent->coordinates(), t.max_depth()));
+      ASSERT_EQ(&leaf, &b);
+    }
+    return;
+  }
+
+  size_t pos = b.begin();
+
+  for(size_t ci = 0; ci < tree_topology_u::num_children; ++ci) {
+    const branch_t & c = t.child(b, ci);
+    ASSERT_EQ(c.begin(), pos);
+    pos = c.end();
+    check_branch(t, c);
+  }
+
+  ASSERT_EQ(pos, b.end());
+}
+
+TEST(morton_tree_storage, branches) {
+  tree_topology_u t({0, 0}, {50, 30}, 4);
+
+  pseudo_random rng;
+
+  for(size_t i = 0; i < 1000; ++i) {
+    t.make_entity(point_t{rng.uniform(0, 50), rng.uniform(0, 30)});
+  }
+
+  t.update_all();
+
+  ASSERT_EQ(t.root().size(), 1000);
+  check_branch(t, t.root());
+}
+
+TEST(morton_tree_storage, neighbors) {
+  tree_topology_u t({0, 0}, {50, 30});
+  thread_pool pool;
+  pool.start(4);
+
+  pseudo_random rng;
+
+  size_t n = 1000;
+
+  for(size_t i = 0; i < n; ++i) {
+    t.make_entity(point_t{rng.uniform(0, 50), rng.uniform(0, 30)});
+  }
+
+  for(size_t step = 0; step < 3; ++step) {
+    if(step > 0) {
+      // Move the entities, keeping them inside the tree's range.
+      for(auto ent : t.all_entities()) {
+        point_t p = ent->coordinates();
+        point_t offset = {rng.uniform(-1, 1), rng.uniform(-1, 1)};
+        point_t max = {50, 30};
+
+        for(size_t d = 0; d < 2; ++d) {
+          if(p[d] + offset[d] < 0 || p[d] + offset[d] >= max[d]) {
+            offset[d] = 0;
+          }
+        }
+
+        ent->move(offset);
+      }
+    }
+
+    if(step % 2) {
+      t.update_all(pool);
+    }
+    else {
+      t.update_all();
+    }
+
+    for(auto ent : t.all_entities()) {
+      auto ns = t.find_in_radius(ent->coordinates(), 5.0);
+
+      set<entity_t *> s1;
+      s1.insert(ns.begin(), ns.end());
+
+      set<entity_t *> s2;
+
+      for(auto ej : t.all_entities()) {
+        if(distance(ent->coordinates(), ej->coordinates()) <= 5.0) {
+          s2.insert(ej);
+        }
+      }
+
+      ASSERT_TRUE(s1 == s2);
+    }
+  }
+}
+
+TEST(morton_tree_storage, neighbors_box) {
+  tree_topology_u t;
+
+  pseudo_random rng;
+
+  for(size_t i = 0; i < 1000; ++i) {
+    t.make_entity(point_t{rng.uniform(0, 1), rng.uniform(0, 1)});
+  }
+
+  t.update_all();
+
+  for(element_t x = 0; x < 1.0; x += 0.1) {
+    for(element_t y = 0; y < 1.0; y += 0.1) {
+      point_t min = {x, y};
+      point_t max = {x + 0.1, y + 0.1};
+
+      auto ns = t.find_in_box(min, max);
+      set<entity_t *> s1;
+      s1.insert(ns.begin(), ns.end());
+
+      set<entity_t *> s2;
+
+      for(auto ej : t.all_entities()) {
+        point_t p = ej->coordinates();
+
+        if(p[0] < max[0] && p[0] > min[0] && p[1] < max[1] && p[1] > min[1]) {
+          s2.insert(ej);
+        }
+      }
+      ASSERT_TRUE(s1 == s2);
+    }
+  }
+}
@@ -0,0 +1,179 @@
+/*~-------------------------------------------------------------------------~~*
+ * Copyright (c) 2014 Los Alamos National Security, LLC
+ * All rights reserved.
+ *~-------------------------------------------------------------------------~~*/
+
+#include <cinchtest.h>
+
+#include <flecsi/concurrency/thread_pool.h>
+#include <flecsi/execution/context.h>
+#include <flecsi/topology/mesh.h>
+#include <flecsi/topology/mesh_topology.h>
+
+#include <memory>
+#include <vector>
+
+using namespace flecsi;
+using namespace flecsi::topology;
+
+using entity_id_t = utils::id_t;
+
+struct vertex_t : mesh_entity_u<0, 1> {
+  static constexpr size_t domain = 0;
+}; // struct vertex_t
+
+struct edge_t : mesh_entity_u<1, 1> {
+  static constexpr size_t domain = 0;
+}; // struct edge_t
+
+struct cell_t : mesh_entity_u<2, 1> {
+  static constexpr size_t domain = 0;
+
+  // The vertices of a cell are (i, j), (i, j + 1), (i + 1, j) and
+  // (i + 1, j + 1): its edges go around it.
+  std::vector<size_t> create_entities(entity_id_t cell_id,
+    size_t dim,
+    domain_connectivity_u<2> & c,
+    entity_id_t * e) {
+    auto v = c.get_entities(cell_id, 0);
+    const size_t around[8] = {0, 2, 2, 3, 3, 1, 1, 0};
+    for(size_t i = 0; i < 8; ++i) {
+      e[i] = entity_id_t::make<0, 0>(v[around[i]], 0);
+    } // for
+    return {2, 2, 2, 2};
+  } // create_entities
+}; // struct cell_t
+
+struct mesh_policy_t {
+  flecsi_register_number_dimensions(2);
+  flecsi_register_number_domains(1);
+
+  flecsi_register_entity_types(flecsi_entity_type(0, 0, vertex_t),
+    flecsi_entity_type(1, 0, edge_t),
+    flecsi_entity_type(2, 0, cell_t));
+
+  flecsi_register_connectivities(flecsi_connectivity(3, 0, cell_t, vertex_t),
+    flecsi_connectivity(4, 0, cell_t, edge_t),
+    flecsi_connectivity(5, 0, edge_t, vertex_t),
+    flecsi_connectivity(6, 0, vertex_t, edge_t),
+    flecsi_connectivity(7, 0, vertex_t, cell_t),
+    flecsi_connectivity(8, 0, edge_t, cell_t),
+    flecsi_connectivity(9, 0, cell_t, cell_t),
+    flecsi_connectivity(10, 0, vertex_t, vertex_t),
+    flecsi_connectivity(11, 0, edge_t, edge_t));
+
+  flecsi_register_bindings();
+
+  template<size_t M, size_t D, typename ST>
+  static mesh_entity_base_u<num_domains> *
+  create_entity(mesh_topology_base_u<ST> * mesh, size_t, entity_id_t const &) {
+    if constexpr(D == 1)
+      return mesh->template make<edge_t>();
+    else
+      return nullptr;
+  } // create_entity
+}; // struct mesh_policy_t
+
+using mesh_t = mesh_topology_u<mesh_policy_t>;
+
+//----------------------------------------------------------------------------//
+// A structured nx x ny mesh of quads, with the storage of its entities and
+// connectivities.
+//----------------------------------------------------------------------------//
+
+struct test_mesh_t {
+  test_mesh_t(size_t nx, size_t ny) {
+    const size_t nv = (nx + 1) * (ny + 1);
+    const size_t ne = nx * (ny + 1) + ny * (nx + 1);
+    const size_t nc = nx * ny;
+    const size_t counts[3] = {nv, ne, nc};
+    const size_t sizes[3] = {sizeof(vertex_t), sizeof(edge_t), sizeof(cell_t)};
+
+    for(size_t d = 0; d < 3; ++d) {
+      entities.emplace_back(new char[sizes[d] * counts[d]]);
+      ids.emplace_back(new entity_id_t[counts[d]]);
+      mesh.storage.init_entities(0, d,
+        (mesh_entity_base_ *)entities.back().get(), ids.back().get(), 0,
+        counts[d], 0, 0, 0, false);
+    } // for
+
+    const size_t capacity = 16 * ne + 16;
+    for(size_t from = 0; from < 3; ++from) {
+      for(size_t to = 0; to < 3; ++to) {
+        offsets.emplace_back(new utils::offset_t[capacity + 1]);
+        indices.emplace_back(new utils::indices_t[capacity]);
+        mesh.storage.init_connectivity(0, 0, from, to, offsets.back().get(),
+          capacity, indices.back().get(), capacity, false);
+      } // for
+    } // for
+    mesh.initialize_storage();
+
+    std::vector<vertex_t *> vs;
+    for(size_t i = 0; i < nv; ++i) {
+      vs.push_back(mesh.make<vertex_t>());
+    } // for
+
+    const size_t w = nx + 1;
+    for(size_t j = 0; j < ny; ++j) {
+      for(size_t i = 0; i < nx; ++i) {
+        auto c = mesh.make<cell_t>();
+        mesh.init_cell<0>(c,
+          std::vector<vertex_t *>{vs[i + j * w], vs[i + (j + 1) * w],
+            vs[i + 1 + j * w], vs[i + 1 + (j + 1) * w]});
+      } // for
+    } // for
+  } // test_mesh_t
+
+  mesh_t mesh;
+  std::vector<std::unique_ptr<char[]>> entities;
+  std::vector<std::unique_ptr<entity_id_t[]>> ids;
+  std::vector<std::unique_ptr<utils::offset_t[]>> offsets;
+  std::vector<std::unique_ptr<utils::indices_t[]>> indices;
+}; // struct test_mesh_t
+
+//----------------------------------------------------------------------------//
+// Building the connectivity on a pool gives the same entities, with the
+// same ids, as building it on the calling thread.
+//----------------------------------------------------------------------------//
+
+TEST(parallel_connectivity, matches_serial) {
+  const size_t nx = 37, ny = 23;
+  const size_t nv = (nx + 1) * (ny + 1);
+  const size_t ne = nx * (ny + 1) + ny * (nx + 1);
+  const size_t nc = nx * ny;
+
+  auto & context = execution::context_t::instance();
+  std::vector<size_t> vertex_map(nv), edge_map(ne), cell_map(nc);
+  for(size_t i = 0; i < nv; ++i)
+    vertex_map[i] = i;
+  for(size_t i = 0; i < ne; ++i)
+    edge_map[i] = i;
+  // the cells are visited in reverse order
+  for(size_t i = 0; i < nc; ++i)
+    cell_map[i] = nc - 1 - i;
+  context.add_index_map(0, vertex_map);
+  context.add_index_map(1, edge_map);
+  context.add_index_map(2, cell_map);
+
+  test_mesh_t serial(nx, ny);
+  serial.mesh.init<0>();
+
+  thread_pool pool;
+  pool.start(4);
+  test_mesh_t pooled(nx, ny);
+  pooled.mesh.init<0>(pool);
+
+  ASSERT_EQ(ne, pooled.mesh.num_entities(1));
+
+  for(size_t from = 0; from < 3; ++from) {
+    for(size_t to = 0; to < 3; ++to) {
+      const auto & s = serial.mesh.storage.topology[0][0].get(from, to);
+      const auto & p = pooled.mesh.storage.topology[0][0].get(from, to);
+      ASSERT_EQ(s.from_size(), p.from_size());
+      for(size_t i = 0; i < s.from_size(); ++i) {
+        ASSERT_EQ(s.get_entities_vec(i), p.get_entities_vec(i))
+          << from << " -> " << to << " of entity " << i;
+      } // for
+    } // for
+  } // for
+} // TEST
@@ -19,7 +19,7 @@ public:
 
   using element_t = double;
 
-  using point_t = point<element_t, dimension>;
+  using point_t = point_u<element_t, dimension>;
 
   class entity : public topology::tree_entity<branch_int_t, dimension>
   {
@@ -80,7 +80,7 @@ public:
     }
 
     point_t coordinates(
-      const std::array<point<element_t, dimension>, 2> & range) const {
+      const std::array<point_u<element_t, dimension>, 2> & range) const {
       point_t p;
       id().coordinates(range, p);
       return p;
@@ -107,6 +107,7 @@ using point_t = tree_topology_u::point_t;
 using branch_t = tree_topology_u::branch_t;
 using branch_id_t = tree_topology_u::branch_id_t;
 using element_t = tree_topology_u::element_t;
+using entity_vector_t = tree_topology_u::entity_vector_t;
 
 TEST(tree_topology, insert_find_remove) {
   tree_topology_u t;
@@ -341,6 +342,50 @@ TEST(tree_topology, neighbors_thread_pool) {
   }
 }
 
+TEST(tree_topology, find_neighbors) {
+  tree_topology_u t({0, 0}, {50, 30});
+  thread_pool pool;
+  pool.start(8);
+
+  pseudo_random rng;
+
+  size_t n = 1000;
+
+  for(size_t i = 0; i < n; ++i) {
+    point_t p = {rng.uniform(0, 50), rng.uniform(0, 30)};
+    t.insert(t.make_entity(p));
+  }
+
+  entity_vector_t ents;
+  std::vector<size_t> offsets;
+  entity_vector_t neighbors;
+
+  t.find_neighbors(2.5, ents, offsets, neighbors);
+
+  ASSERT_EQ(ents.size(), n);
+  ASSERT_EQ(offsets.size(), n + 1);
+  ASSERT_EQ(offsets[n], neighbors.size());
+
+  for(size_t i = 0; i < n; ++i) {
+    auto ns = t.find_in_radius(ents[i]->coordinates(), 2.5);
+
+    entity_vector_t row(
+      neighbors.begin() + offsets[i], neighbors.begin() + offsets[i + 1]);
+
+    ASSERT_TRUE(row == ns);
+  }
+
+  entity_vector_t pents;
+  std::vector<size_t> poffsets;
+  entity_vector_t pneighbors;
+
+  t.find_neighbors(pool, 2.5, pents, poffsets, pneighbors);
+
+  ASSERT_TRUE(pents == ents);
+  ASSERT_TRUE(poffsets == offsets);
+  ASSERT_TRUE(pneighbors == neighbors);
+}
+
 TEST(tree_topology, neighbors_rectangular) {
   tree_topology_u t({0, 0}, {50, 30});
 
@@ -420,6 +465,44 @@ TEST(tree_topology, neighbors_box) {
   }
 }
 
+TEST(tree_topology, neighbors_box_thread_pool) {
+  tree_topology_u t;
+  thread_pool pool;
+  pool.start(8);
+
+  pseudo_random rng;
+
+  std::vector<entity_t *> ents;
+
+  size_t n = 1000;
+
+  for(size_t i = 0; i < n; ++i) {
+    point_t p = {rng.uniform(0, 1), rng.uniform(0, 1)};
+    auto e = t.make_entity(p);
+    t.insert(e);
+    ents.push_back(e);
+  }
+
+  for(element_t x = 0; x < 1.0; x += 0.1) {
+    for(element_t y = 0; y < 1.0; y += 0.1) {
+      point_t min = {x, y};
+      point_t max = {x + 0.1, y + 0.1};
+
+      auto ns = t.find_in_box(pool, min, max);
+      set<entity_t *> s1;
+      s1.insert(ns.begin(), ns.end());
+
+      ASSERT_EQ(ns.size(), s1.size());
+
+      auto ms = t.find_in_box(min, max);
+      set<entity_t *> s2;
+      s2.insert(ms.begin(), ms.end());
+
+      ASSERT_TRUE(s1 == s2);
+    }
+  }
+}
+
 TEST(tree_topology, iterator_update_all) {
   tree_topology_u t;
 
@@ -24,12 +24,14 @@
 #include <iostream>
 #include <map>
 #include <memory> // make_unique
-#include <mutex>
 #include <set>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
 #include "flecsi/utils/array_ref.h"
+#include <flecsi/concurrency/parallel_for.h>
+#include <flecsi/concurrency/radix_sort.h>
 #include <flecsi/concurrency/thread_pool.h>
 #include <flecsi/data/data_client.h>
 #include <flecsi/data/storage.h>
@@ -67,7 +69,7 @@ struct tree_geometry_u {};
 //-----------------------------------------------------------------//
 template<typename T>
 struct tree_geometry_u<T, 1> {
-  using point_t = point<T, 1>;
+  using point_t = point_u<T, 1>;
   using element_t = T;
 
   //-----------------------------------------------------------------//
@@ -138,7 +140,7 @@ struct tree_geometry_u<T, 1> {
 //-----------------------------------------------------------------//
 template<typename T>
 struct tree_geometry_u<T, 2> {
-  using point_t = point<T, 2>;
+  using point_t = point_u<T, 2>;
   using element_t = T;
 
   //-----------------------------------------------------------------//
@@ -222,7 +224,7 @@ struct tree_geometry_u<T, 2> {
 //-----------------------------------------------------------------//
 template<typename T>
 struct tree_geometry_u<T, 3> {
-  using point_t = point<T, 3>;
+  using point_t = point_u<T, 3>;
   using element_t = T;
 
   //-----------------------------------------------------------------//
@@ -325,8 +327,8 @@ public:
   //! for the branch id.
   //-----------------------------------------------------------------//
   template<typename S>
-  branch_id_u(const std::array<point<S, dimension>, 2> & range,
-    const point<S, dimension> & p,
+  branch_id_u(const std::array<point_u<S, dimension>, 2> & range,
+    const point_u<S, dimension> & p,
     size_t depth)
     : id_(int_t(1) << depth * dimension + (bits - 1) % dimension) {
     std::array<int_t, dimension> coords;
@@ -485,8 +487,8 @@ public:
   //! Convert this branch id to coordinates in range.
   //-----------------------------------------------------------------//
   template<typename S>
-  void coordinates(const std::array<point<S, dimension>, 2> & range,
-    point<S, dimension> & p) const {
+  void coordinates(const std::array<point_u<S, dimension>, 2> & range,
+    point_u<S, dimension> & p) const {
     std::array<int_t, dimension> coords;
     coords.fill(int_t(0));
 
@@ -540,12 +542,40 @@ struct branch_id_hasher_u {
 enum class action : uint8_t { none = 0b00, refine = 0b01, coarsen = 0b10 };
 
 //-----------------------------------------------------------------//
-//! The tree topology is parameterized on a policy P which defines its branch
-//! and entity types.
+//! The storage of a tree topology. With hashed_tree_storage_t, the
+//! default, the branches are reached through a hash map of their ids and
+//! entities are inserted and removed one at a time. With
+//! morton_tree_storage_t, the entities are kept sorted by their Morton key
+//! and the tree is rebuilt as a whole by update_all().
+//-----------------------------------------------------------------//
+struct hashed_tree_storage_t {};
+struct morton_tree_storage_t {};
+
 //-----------------------------------------------------------------//
+//! The storage selected by a policy: its storage_t type if it defines
+//! one, hashed_tree_storage_t otherwise.
+//-----------------------------------------------------------------//
+template<class P, typename = void>
+struct tree_storage_u {
+  using type = hashed_tree_storage_t;
+};
+
 template<class P>
+struct tree_storage_u<P, std::void_t<typename P::storage_t>> {
+  using type = typename P::storage_t;
+};
+
+//-----------------------------------------------------------------//
+//! The tree topology is parameterized on a policy P which defines its branch
+//! and entity types, and on its storage S, which defaults to the one
+//! selected by the policy.
+//-----------------------------------------------------------------//
+template<class P, class S = typename tree_storage_u<P>::type>
 class tree_topology : public P, public data::data_client_t
 {
+  static_assert(std::is_same<S, hashed_tree_storage_t>::value,
+    "unknown tree storage");
+
 public:
   using Policy = P;
 
@@ -553,7 +583,7 @@ public:
 
   using element_t = typename Policy::element_t;
 
-  using point_t = point<element_t, dimension>;
+  using point_t = point_u<element_t, dimension>;
 
   using range_t = std::pair<element_t, element_t>;
 
@@ -605,8 +635,8 @@ public:
   //! Construct a tree topology with specified ranges [end, start] for
   //! each dimension.
   //-----------------------------------------------------------------//
-  tree_topology(const point<element_t, dimension> & start,
-    const point<element_t, dimension> & end) {
+  tree_topology(const point_u<element_t, dimension> & start,
+    const point_u<element_t, dimension> & end) {
     branch_id_t bid = branch_id_t::root();
     root_ = new branch_t;
     root_->set_id_(bid);
@@ -696,8 +726,8 @@ public:
   //! coordinates are assumed to have changed. Additionally expands or contracts
   //! the coordinate ranges of each dimension to [start, end].
   //-----------------------------------------------------------------//
-  void update_all(const point<element_t, dimension> & start,
-    const point<element_t, dimension> & end) {
+  void update_all(const point_u<element_t, dimension> & start,
+    const point_u<element_t, dimension> & end) {
 
     for(size_t d = 0; d < dimension; ++d) {
       scale_[d] = end[d] - start[d];
@@ -786,22 +816,19 @@ public:
 
   /*!
     Return an index space containing all entities within the specified
-    spheroid. (Concurrent version.)
+    spheroid. (Concurrent version.) Use apply_in_radius to visit the entities
+    without building the index space.
    */
   entity_vector_t
   find_in_radius(thread_pool & pool, const point_t & center, element_t radius) {
 
     size_t queue_depth = get_queue_depth(pool);
-    size_t m = branch_int_t(1) << queue_depth * P::dimension;
 
     auto ef = [&](entity_t * ent, const point_t & center,
                 element_t radius) -> bool {
       return geometry_t::within(ent->coordinates(), center, radius);
     };
 
-    virtual_semaphore sem(1 - int(m));
-    std::mutex mtx;
-
     entity_vector_t ents;
 
     size_t depth;
@@ -809,10 +836,8 @@ public:
     branch_t * b = find_start_(center, radius, depth, size);
     queue_depth += depth;
 
-    find_(pool, sem, mtx, queue_depth, depth, b, size, ents, ef,
-      geometry_t::intersects, center, radius);
-
-    sem.acquire();
+    find_(pool, queue_depth, depth, b, size, ents, ef, geometry_t::intersects,
+      center, radius);
 
     return ents;
   }
@@ -851,12 +876,12 @@ public:
 
   /*!
     Return an index space containing all entities within the specified
-    box. (Concurrent version.)
+    box. (Concurrent version.) Use apply_in_box to visit the entities
+    without building the index space.
    */
   entity_vector_t
   find_in_box(thread_pool & pool, const point_t & min, const point_t & max) {
     size_t queue_depth = get_queue_depth(pool);
-    size_t m = branch_int_t(1) << queue_depth * P::dimension;
 
     auto ef = [&](entity_t * ent, const point_t & min,
                 const point_t & max) -> bool {
@@ -882,14 +907,9 @@ public:
 
     queue_depth += depth;
 
-    virtual_semaphore sem(1 - int(m));
-    std::mutex mtx;
-
-    find_(pool, sem, mtx, queue_depth, depth, b, size, ents, ef,
+    find_(pool, queue_depth, depth, b, size, ents, ef,
       geometry_t::intersects_box, min, max);
 
-    sem.acquire();
-
     return ents;
   }
 
@@ -928,7 +948,6 @@ public:
     ARGS &&... args) {
 
     size_t queue_depth = get_queue_depth(pool);
-    size_t m = branch_int_t(1) << queue_depth * P::dimension;
 
     auto f = [&](entity_t * ent, const point_t & center, element_t radius) {
       if(geometry_t::within(ent->coordinates(), center, radius)) {
@@ -941,12 +960,12 @@ public:
     branch_t * b = find_start_(center, radius, depth, size);
     queue_depth += depth;
 
-    virtual_semaphore sem(1 - int(m));
+    wait_group wg;
 
-    apply_(pool, sem, queue_depth, depth, b, size, f, geometry_t::intersects,
+    apply_(pool, wg, queue_depth, depth, b, size, f, geometry_t::intersects,
       center, radius);
 
-    sem.acquire();
+    pool.wait(wg);
   }
 
   //-----------------------------------------------------------------//
@@ -961,7 +980,6 @@ public:
     ARGS &&... args) {
 
     size_t queue_depth = get_queue_depth(pool);
-    size_t m = branch_int_t(1) << queue_depth * P::dimension;
 
     auto f = [&](entity_t * ent, const point_t & min, const point_t & max) {
       if(geometry_t::within_box(ent->coordinates(), min, max)) {
@@ -985,12 +1003,12 @@ public:
     branch_t * b = find_start_(center, radius, depth, size);
     queue_depth += depth;
 
-    virtual_semaphore sem(1 - int(m));
+    wait_group wg;
 
-    apply_(pool, sem, queue_depth, depth, b, size, f,
+    apply_(pool, wg, queue_depth, depth, b, size, f,
       geometry_t::intersects_box, min, max);
 
-    sem.acquire();
+    pool.wait(wg);
   }
 
   /*!
@@ -1026,6 +1044,44 @@ public:
     apply_(b, size, f, geometry_t::intersects_box, min, max);
   }
 
+  //-----------------------------------------------------------------//
+  //! Build the neighbor lists of all entities in one pass. Rather than
+  //! searching the tree from the root for every entity, the tree is
+  //! searched once per leaf for the leaves that intersect the leaf's box
+  //! grown by radius, and the entities of the leaf are then only tested
+  //! against the entities of those leaves.
+  //!
+  //! The result is stored in compressed row (CSR) form: the neighbors of
+  //! ents[i] are neighbors[offsets[i]] ... neighbors[offsets[i+1] - 1].
+  //! The rows are in tree (Morton) order, and each row holds the same
+  //! entities as find_in_radius(ents[i]->coordinates(), radius).
+  //!
+  //! @param      radius    The search radius.
+  //! @param[out] ents      The entities of the tree, in Morton order.
+  //! @param[out] offsets   The row offsets (ents.size() + 1 of them).
+  //! @param[out] neighbors The concatenated neighbor lists.
+  //-----------------------------------------------------------------//
+  void find_neighbors(element_t radius,
+    entity_vector_t & ents,
+    std::vector<size_t> & offsets,
+    entity_vector_t & neighbors) {
+    find_neighbors_(nullptr, radius, ents, offsets, neighbors);
+  }
+
+  /*!
+    Build the neighbor lists of all entities in one pass. (Concurrent
+    version.) The leaves are split into contiguous blocks that are
+    processed by the pool, so the result is the same as the one of the
+    serial version.
+   */
+  void find_neighbors(thread_pool & pool,
+    element_t radius,
+    entity_vector_t & ents,
+    std::vector<size_t> & offsets,
+    entity_vector_t & neighbors) {
+    find_neighbors_(&pool, radius, ents, offsets, neighbors);
+  }
+
   //-----------------------------------------------------------------//
   //! Construct a new entity. The entity's constructor should not be called
   //! directly.
@@ -1081,14 +1137,13 @@ public:
   template<typename F, typename... ARGS>
   void visit(thread_pool & pool, branch_t * b, F && f, ARGS &&... args) {
     size_t queue_depth = get_queue_depth(pool);
-    size_t m = branch_int_t(1) << queue_depth * P::dimension;
 
-    virtual_semaphore sem(1 - int(m));
+    wait_group wg;
 
-    visit_(pool, sem, b, 0, queue_depth, std::forward<F>(f),
+    visit_(pool, wg, b, 0, queue_depth, std::forward<F>(f),
       std::forward<ARGS>(args)...);
 
-    sem.acquire();
+    pool.wait(wg);
   }
 
   //-----------------------------------------------------------------//
@@ -1118,14 +1173,13 @@ public:
   void
   visit_children(thread_pool & pool, branch_t * b, F && f, ARGS &&... args) {
     size_t queue_depth = get_queue_depth(pool);
-    size_t m = branch_int_t(1) << queue_depth * P::dimension;
 
-    virtual_semaphore sem(1 - int(m));
+    wait_group wg;
 
-    visit_children_(pool, sem, 0, queue_depth, b, std::forward<F>(f),
+    visit_children_(pool, wg, 0, queue_depth, b, std::forward<F>(f),
       std::forward<ARGS>(args)...);
 
-    sem.acquire();
+    pool.wait(wg);
   }
 
   //-----------------------------------------------------------------//
@@ -1401,7 +1455,7 @@ private:
 
   template<typename EF, typename BF, typename... ARGS>
   void apply_(thread_pool & pool,
-    virtual_semaphore & sem,
+    wait_group & wg,
     size_t queue_depth,
     size_t depth,
     branch_t * b,
@@ -1415,12 +1469,6 @@ private:
         ef(ent, std::forward<ARGS>(args)...);
       }
 
-      size_t m = branch_int_t(1) << (queue_depth - depth) * P::dimension;
-
-      for(size_t i = 0; i < m; ++i) {
-        sem.release();
-      }
-
       return;
     }
 
@@ -1437,28 +1485,15 @@ private:
           auto f = [&, size, ci]() {
             apply_(ci, size, std::forward<EF>(ef), std::forward<BF>(bf),
               std::forward<ARGS>(args)...);
-
-            sem.release();
           };
 
-          pool.queue(f);
+          pool.queue(wg, f);
         }
         else {
-          apply_(pool, sem, queue_depth, depth, ci, size, std::forward<EF>(ef),
+          apply_(pool, wg, queue_depth, depth, ci, size, std::forward<EF>(ef),
             std::forward<BF>(bf), std::forward<ARGS>(args)...);
         }
       }
-      else {
-        if(depth > queue_depth) {
-          continue;
-        }
-
-        size_t m = branch_int_t(1) << (queue_depth - depth) * P::dimension;
-
-        for(size_t i = 0; i < m; ++i) {
-          sem.release();
-        }
-      }
     }
   }
 
@@ -1492,10 +1527,13 @@ private:
     }
   }
 
+  // Concurrent search: the subtrees rooted at queue_depth are searched by
+  // the pool, each one into its own result vector, and the results are
+  // concatenated in tree order once all of them are done. Entities found
+  // above queue_depth are collected by the calling thread. No locks are
+  // taken on the search path.
   template<typename EF, typename BF, typename... ARGS>
   void find_(thread_pool & pool,
-    virtual_semaphore & sem,
-    std::mutex & mtx,
     size_t queue_depth,
     size_t depth,
     branch_t * b,
@@ -1505,21 +1543,58 @@ private:
     BF && bf,
     ARGS &&... args) {
 
+    std::vector<std::pair<branch_t *, element_t>> subtrees;
+
+    find_subtrees_(queue_depth, depth, b, size, ents, subtrees, ef, bf,
+      args...);
+
+    if(subtrees.empty()) {
+      return;
+    }
+
+    std::vector<entity_vector_t> found(subtrees.size());
+
+    wait_group wg;
+
+    for(size_t i = 1; i < subtrees.size(); ++i) {
+      pool.queue(wg, [&, i]() {
+        find_(subtrees[i].first, subtrees[i].second, found[i], ef, bf,
+          args...);
+      });
+    }
+
+    find_(subtrees[0].first, subtrees[0].second, found[0], ef, bf, args...);
+
+    pool.wait(wg);
+
+    size_t n = ents.size();
+    for(auto & f : found) {
+      n += f.size();
+    }
+
+    ents.reserve(n);
+    for(auto & f : found) {
+      ents.insert(ents.end(), f.begin(), f.end());
+    }
+  }
+
+  template<typename EF, typename BF, typename... ARGS>
+  void find_subtrees_(size_t queue_depth,
+    size_t depth,
+    branch_t * b,
+    element_t size,
+    entity_vector_t & ents,
+    std::vector<std::pair<branch_t *, element_t>> & subtrees,
+    EF && ef,
+    BF && bf,
+    ARGS &&... args) {
+
     if(b->is_leaf()) {
-      mtx.lock();
       for(auto ent : *b) {
-        if(ef(ent, std::forward<ARGS>(args)...)) {
+        if(ef(ent, args...)) {
           ents.push_back(ent);
         }
       }
-      mtx.unlock();
-
-      size_t m = branch_int_t(1) << (queue_depth - depth) * P::dimension;
-
-      for(size_t i = 0; i < m; ++i) {
-        sem.release();
-      }
-
       return;
     }
 
@@ -1529,41 +1604,149 @@ private:
     for(size_t i = 0; i < branch_t::num_children; ++i) {
       branch_t * ci = b->template child_<branch_t>(i);
 
-      if(bf(ci->coordinates(range_), size, scale_,
-           std::forward<ARGS>(args)...)) {
+      if(bf(ci->coordinates(range_), size, scale_, args...)) {
         if(depth == queue_depth) {
+          subtrees.emplace_back(ci, size);
+        }
+        else {
+          find_subtrees_(
+            queue_depth, depth, ci, size, ents, subtrees, ef, bf, args...);
+        }
+      }
+    }
+  }
 
-          auto f = [&, size, ci]() {
-            entity_vector_t branch_ents;
+  void find_neighbors_(thread_pool * pool,
+    element_t radius,
+    entity_vector_t & ents,
+    std::vector<size_t> & offsets,
+    entity_vector_t & neighbors) {
+
+    // Non-empty leaves in Morton order, with their sizes.
+    std::vector<std::pair<branch_t *, element_t>> leaves;
+    find_leaves_(root_, element_t(1), leaves);
 
-            find_(ci, size, branch_ents, std::forward<EF>(ef),
-              std::forward<BF>(bf), std::forward<ARGS>(args)...);
+    struct block_t {
+      entity_vector_t ents;
+      std::vector<size_t> counts;
+      entity_vector_t neighbors;
+    };
 
-            mtx.lock();
-            ents.insert(ents.end(), branch_ents.begin(), branch_ents.end());
-            mtx.unlock();
+    parallel_range_t range(pool, leaves.size(), 16);
+    std::vector<block_t> blocks(range.size());
 
-            sem.release();
-          };
+    parallel_for(pool, range, [&](size_t c, size_t first, size_t last) {
+      block_t & block = blocks[c];
+      std::vector<branch_t *> candidates;
+
+      for(size_t l{first}; l < last; ++l) {
+        branch_t * b = leaves[l].first;
+        element_t size = leaves[l].second;
 
-          pool.queue(f);
+        point_t min = b->coordinates(range_);
+        point_t max = min;
+
+        for(size_t d = 0; d < dimension; ++d) {
+          min[d] -= radius;
+          max[d] += size * scale_[d] + radius;
         }
-        else {
-          find_(pool, sem, mtx, queue_depth, depth, ci, size, ents,
-            std::forward<EF>(ef), std::forward<BF>(bf),
-            std::forward<ARGS>(args)...);
+
+        candidates.clear();
+        find_leaves_(root_, element_t(1), candidates,
+          geometry_t::intersects_box, min, max);
+
+        for(auto ent : *b) {
+          const size_t n = block.neighbors.size();
+
+          for(auto ci : candidates) {
+            for(auto ej : *ci) {
+              if(geometry_t::within(
+                   ej->coordinates(), ent->coordinates(), radius)) {
+                block.neighbors.push_back(ej);
+              }
+            }
+          }
+
+          block.ents.push_back(ent);
+          block.counts.push_back(block.neighbors.size() - n);
         }
       }
-      else {
-        if(depth > queue_depth) {
-          continue;
-        }
+    });
 
-        size_t m = branch_int_t(1) << (queue_depth - depth) * P::dimension;
+    size_t num_ents = 0;
+    size_t num_neighbors = 0;
+    std::vector<size_t> ent_start(blocks.size());
+    std::vector<size_t> neighbor_start(blocks.size());
 
-        for(size_t i = 0; i < m; ++i) {
-          sem.release();
-        }
+    for(size_t c = 0; c < blocks.size(); ++c) {
+      ent_start[c] = num_ents;
+      neighbor_start[c] = num_neighbors;
+      num_ents += blocks[c].ents.size();
+      num_neighbors += blocks[c].neighbors.size();
+    }
+
+    ents.resize(num_ents);
+    offsets.resize(num_ents + 1);
+    neighbors.resize(num_neighbors);
+    offsets[num_ents] = num_neighbors;
+
+    parallel_for(pool, blocks.size(), [&](size_t c) {
+      const block_t & block = blocks[c];
+      size_t offset = neighbor_start[c];
+
+      for(size_t i = 0; i < block.ents.size(); ++i) {
+        ents[ent_start[c] + i] = block.ents[i];
+        offsets[ent_start[c] + i] = offset;
+        offset += block.counts[i];
+      }
+
+      std::copy(block.neighbors.begin(), block.neighbors.end(),
+        neighbors.begin() + neighbor_start[c]);
+    }, 1);
+  }
+
+  // Collect the non-empty leaves under b, in Morton order.
+  void find_leaves_(branch_t * b,
+    element_t size,
+    std::vector<std::pair<branch_t *, element_t>> & leaves) {
+
+    if(b->is_leaf()) {
+      if(b->begin() != b->end()) {
+        leaves.emplace_back(b, size);
+      }
+      return;
+    }
+
+    size /= 2;
+
+    for(size_t i = 0; i < branch_t::num_children; ++i) {
+      find_leaves_(b->template child_<branch_t>(i), size, leaves);
+    }
+  }
+
+  // Collect the non-empty leaves under b that pass the intersection test
+  // bf, in Morton order.
+  template<typename BF, typename... ARGS>
+  void find_leaves_(branch_t * b,
+    element_t size,
+    std::vector<branch_t *> & leaves,
+    BF && bf,
+    ARGS &&... args) {
+
+    if(b->is_leaf()) {
+      if(b->begin() != b->end()) {
+        leaves.push_back(b);
+      }
+      return;
+    }
+
+    size /= 2;
+
+    for(size_t i = 0; i < branch_t::num_children; ++i) {
+      branch_t * ci = b->template child_<branch_t>(i);
+
+      if(bf(ci->coordinates(range_), size, scale_, args...)) {
+        find_leaves_(ci, size, leaves, bf, args...);
       }
     }
   }
@@ -1586,7 +1769,7 @@ private:
 
   template<typename F, typename... ARGS>
   void visit_(thread_pool & pool,
-    virtual_semaphore & sem,
+    wait_group & wg,
     branch_t * b,
     size_t depth,
     size_t queue_depth,
@@ -1596,44 +1779,31 @@ private:
     if(depth == queue_depth) {
       auto vf = [&, depth, b]() {
         visit_(b, depth, std::forward<F>(f), std::forward<ARGS>(args)...);
-        sem.release();
       };
 
-      pool.queue(vf);
+      pool.queue(wg, vf);
       return;
     }
 
     if(f(b, depth, std::forward<ARGS>(args)...)) {
-      size_t m = branch_int_t(1) << (queue_depth - depth) * P::dimension;
-
-      for(size_t i = 0; i < m; ++i) {
-        sem.release();
-      }
-
       return;
     }
 
     if(b->is_leaf()) {
-      size_t m = branch_int_t(1) << (queue_depth - depth) * P::dimension;
-
-      for(size_t i = 0; i < m; ++i) {
-        sem.release();
-      }
-
       return;
     }
 
     for(size_t i = 0; i < branch_t::num_children; ++i) {
       branch_t * bi = b->template child_<branch_t>(i);
 
-      visit_(pool, sem, bi, depth + 1, queue_depth, std::forward<F>(f),
+      visit_(pool, wg, bi, depth + 1, queue_depth, std::forward<F>(f),
         std::forward<ARGS>(args)...);
     }
   }
 
   template<typename F, typename... ARGS>
   void visit_children_(thread_pool & pool,
-    virtual_semaphore & sem,
+    wait_group & wg,
     size_t depth,
     size_t queue_depth,
     branch_t * b,
@@ -1643,10 +1813,9 @@ private:
     if(depth == queue_depth) {
       auto vf = [&, b]() {
         visit_children(b, std::forward<F>(f), std::forward<ARGS>(args)...);
-        sem.release();
       };
 
-      pool.queue(vf);
+      pool.queue(wg, vf);
       return;
     }
 
@@ -1655,18 +1824,12 @@ private:
         f(ent, std::forward<ARGS>(args)...);
       }
 
-      size_t m = branch_int_t(1) << (queue_depth - depth) * P::dimension;
-
-      for(size_t i = 0; i < m; ++i) {
-        sem.release();
-      }
-
       return;
     }
 
     for(size_t i = 0; i < branch_t::num_children; ++i) {
       branch_t * bi = b->template child_<branch_t>(i);
-      visit_children_(pool, sem, depth + 1, queue_depth, bi, std::forward<F>(f),
+      visit_children_(pool, wg, depth + 1, queue_depth, bi, std::forward<F>(f),
         std::forward<ARGS>(args)...);
     }
   }
@@ -1675,8 +1838,8 @@ private:
   size_t max_depth_;
   branch_t * root_;
   entity_vector_t entities_;
-  std::array<point<element_t, dimension>, 2> range_;
-  point<element_t, dimension> scale_;
+  std::array<point_u<element_t, dimension>, 2> range_;
+  point_u<element_t, dimension> scale_;
   element_t max_scale_;
 };
 
@@ -1703,7 +1866,7 @@ public:
   }
 
 private:
-  template<class P>
+  template<class P, class S>
   friend class tree_topology;
 
   void set_branch_id_(branch_id_t bid) {
@@ -1771,7 +1934,7 @@ public:
   }
 
 private:
-  template<class P>
+  template<class P, class S>
   friend class tree_topology;
 
   void set_id_(branch_id_t id) {
@@ -1837,5 +2000,430 @@ private:
   branch_id_t id_;
 };
 
+//-----------------------------------------------------------------//
+//! The tree topology with Morton-sorted storage: a linear tree that
+//! stores its entities in arrays sorted by their Morton key, i.e., by
+//! the value of the branch_id_u of maximum depth that contains them.
+//! Every branch is a contiguous range of these arrays, so that traversals
+//! and leaf scans walk memory in order, and the tree has no pointer-based
+//! branches or hash map to maintain.
+//!
+//! The tree is rebuilt from scratch by update_all(): the keys of all
+//! entities are computed and radix sorted, and the branches are built
+//! top-down by binary search over the sorted keys. This makes rebuilds
+//! after every step cheap when all the entities move.
+//!
+//! The policy P defines dimension, element_t, branch_int_t and entity_t,
+//! which must provide coordinates(). It does not define a branch type:
+//! the branches are ranges of the sorted entities.
+//!
+//! Entities are created with make_entity() and are part of the tree after
+//! the next call to update_all(). The searches use the coordinates of the
+//! entities at that call.
+//-----------------------------------------------------------------//
+template<class P>
+class tree_topology<P, morton_tree_storage_t> : public P,
+                                                public data::data_client_t
+{
+public:
+  using Policy = P;
+
+  static const size_t dimension = Policy::dimension;
+
+  using element_t = typename Policy::element_t;
+
+  using point_t = point_u<element_t, dimension>;
+
+  using branch_int_t = typename Policy::branch_int_t;
+
+  using branch_id_t = branch_id_u<branch_int_t, dimension>;
+
+  using entity_t = typename Policy::entity_t;
+
+  using entity_vector_t = std::vector<entity_t *>;
+
+  using geometry_t = tree_geometry_u<element_t, dimension>;
+
+  static constexpr size_t num_children = size_t(1) << dimension;
+
+  //-----------------------------------------------------------------//
+  //! A branch: its id and the range of the sorted entities it contains.
+  //-----------------------------------------------------------------//
+  class branch_t
+  {
+  public:
+    branch_id_t id() const {
+      return id_;
+    }
+
+    bool is_leaf() const {
+      return children_ == 0;
+    }
+
+    //! The index of the first entity of the branch in Morton order.
+    size_t begin() const {
+      return begin_;
+    }
+
+    //! One past the index of the last entity of the branch.
+    size_t end() const {
+      return end_;
+    }
+
+    size_t size() const {
+      return end_ - begin_;
+    }
+
+  private:
+    friend class tree_topology;
+
+    branch_id_t id_;
+    size_t begin_ = 0;
+    size_t end_ = 0;
+    size_t children_ = 0; // index of the first child, 0 for leaves
+  }; // class branch_t
+
+  //-----------------------------------------------------------------//
+  //! Construct a tree with unit coordinates, i.e. each coordinate
+  //! dimension is in range [0, 1].
+  //!
+  //! @param leaf_size The number of entities above which a branch is
+  //!                  refined.
+  //-----------------------------------------------------------------//
+  tree_topology(size_t leaf_size = 8) : leaf_size_(leaf_size) {
+    for(size_t d = 0; d < dimension; ++d) {
+      range_[0][d] = element_t(0);
+      range_[1][d] = element_t(1);
+      scale_[d] = element_t(1);
+    }
+
+    clear_();
+  }
+
+  //-----------------------------------------------------------------//
+  //! Construct a tree with specified ranges [start, end] for each
+  //! dimension.
+  //-----------------------------------------------------------------//
+  tree_topology(const point_t & start,
+    const point_t & end,
+    size_t leaf_size = 8)
+    : leaf_size_(leaf_size) {
+    set_range_(start, end);
+    clear_();
+  }
+
+  ~tree_topology() {
+    for(auto ent : entities_) {
+      delete ent;
+    }
+  }
+
+  //-----------------------------------------------------------------//
+  //! Construct a new entity. The entity's constructor should not be called
+  //! directly.
+  //-----------------------------------------------------------------//
+  template<class... Args>
+  entity_t * make_entity(Args &&... args) {
+    auto safe = std::make_unique<entity_t>(std::forward<Args>(args)...);
+    entities_.push_back(safe.get());
+    return safe.release();
+  }
+
+  //-----------------------------------------------------------------//
+  //! Return a span over all entities, in creation order.
+  //-----------------------------------------------------------------//
+  utils::span<entity_t * const> all_entities() const {
+    return entities_;
+  }
+
+  //-----------------------------------------------------------------//
+  //! Return a span over the entities of the tree, in Morton order.
+  //-----------------------------------------------------------------//
+  utils::span<entity_t * const> entities() const {
+    return sorted_;
+  }
+
+  //-----------------------------------------------------------------//
+  //! Return a span over the entities of a branch, in Morton order.
+  //-----------------------------------------------------------------//
+  utils::span<entity_t * const> entities(const branch_t & b) const {
+    return {sorted_.data() + b.begin(), b.size()};
+  }
+
+  //-----------------------------------------------------------------//
+  //! Rebuild the tree from the current coordinates of all entities.
+  //-----------------------------------------------------------------//
+  void update_all() {
+    update_all_(nullptr);
+  }
+
+  /*!
+    Rebuild the tree from the current coordinates of all entities.
+    (Concurrent version.)
+   */
+  void update_all(thread_pool & pool) {
+    update_all_(&pool);
+  }
+
+  //-----------------------------------------------------------------//
+  //! Rebuild the tree from the current coordinates of all entities, after
+  //! expanding or contracting the coordinate ranges of each dimension to
+  //! [start, end].
+  //-----------------------------------------------------------------//
+  void update_all(const point_t & start, const point_t & end) {
+    set_range_(start, end);
+    update_all_(nullptr);
+  }
+
+  //-----------------------------------------------------------------//
+  //! Get the root branch (depth 0).
+  //-----------------------------------------------------------------//
+  const branch_t & root() const {
+    return branches_[0];
+  }
+
+  //-----------------------------------------------------------------//
+  //! Get the ci-th child of the given branch.
+  //-----------------------------------------------------------------//
+  const branch_t & child(const branch_t & b, size_t ci) const {
+    assert(!b.is_leaf() && ci < num_children);
+    return branches_[b.children_ + ci];
+  }
+
+  //-----------------------------------------------------------------//
+  //! Find the deepest branch that contains the given branch id.
+  //-----------------------------------------------------------------//
+  const branch_t & find_parent(branch_id_t bid) const {
+    const size_t depth = bid.depth();
+    const branch_t * b = &branches_[0];
+
+    for(size_t d = 1; d <= depth && !b->is_leaf(); ++d) {
+      branch_id_t cid = bid;
+      cid.truncate(d);
+      b = &branches_[b->children_ +
+                     (cid.value_() & branch_int_t(num_children - 1))];
+    }
+
+    return *b;
+  }
+
+  //-----------------------------------------------------------------//
+  //! Return the tree's current max depth.
+  //-----------------------------------------------------------------//
+  size_t max_depth() const {
+    return max_depth_;
+  }
+
+  //-----------------------------------------------------------------//
+  //! Return an index space containing all entities within the specified
+  //! spheroid.
+  //-----------------------------------------------------------------//
+  entity_vector_t find_in_radius(const point_t & center, element_t radius) {
+    entity_vector_t ents;
+
+    apply_(0, element_t(1),
+      [&](size_t i) {
+        if(geometry_t::within(points_[i], center, radius)) {
+          ents.push_back(sorted_[i]);
+        }
+      },
+      geometry_t::intersects, center, radius);
+
+    return ents;
+  }
+
+  //-----------------------------------------------------------------//
+  //! Return an index space containing all entities within the specified
+  //! box.
+  //-----------------------------------------------------------------//
+  entity_vector_t find_in_box(const point_t & min, const point_t & max) {
+    entity_vector_t ents;
+
+    apply_(0, element_t(1),
+      [&](size_t i) {
+        if(geometry_t::within_box(points_[i], min, max)) {
+          ents.push_back(sorted_[i]);
+        }
+      },
+      geometry_t::intersects_box, min, max);
+
+    return ents;
+  }
+
+  //-----------------------------------------------------------------//
+  //! For all entities within the specified spheroid, apply the given callable
+  //! object ef with args.
+  //-----------------------------------------------------------------//
+  template<typename EF, typename... ARGS>
+  void apply_in_radius(const point_t & center,
+    element_t radius,
+    EF && ef,
+    ARGS &&... args) {
+
+    apply_(0, element_t(1),
+      [&](size_t i) {
+        if(geometry_t::within(points_[i], center, radius)) {
+          ef(sorted_[i], std::forward<ARGS>(args)...);
+        }
+      },
+      geometry_t::intersects, center, radius);
+  }
+
+  //-----------------------------------------------------------------//
+  //! For all entities within the specified box, apply the given callable
+  //! object ef with args.
+  //-----------------------------------------------------------------//
+  template<typename EF, typename... ARGS>
+  void apply_in_box(const point_t & min,
+    const point_t & max,
+    EF && ef,
+    ARGS &&... args) {
+
+    apply_(0, element_t(1),
+      [&](size_t i) {
+        if(geometry_t::within_box(points_[i], min, max)) {
+          ef(sorted_[i], std::forward<ARGS>(args)...);
+        }
+      },
+      geometry_t::intersects_box, min, max);
+  }
+
+private:
+  void set_range_(const point_t & start, const point_t & end) {
+    for(size_t d = 0; d < dimension; ++d) {
+      scale_[d] = end[d] - start[d];
+      range_[0][d] = start[d];
+      range_[1][d] = end[d];
+    }
+  }
+
+  void clear_() {
+    branches_.clear();
+    branches_.emplace_back();
+    branches_[0].id_ = branch_id_t::root();
+    max_depth_ = 0;
+  }
+
+  void update_all_(thread_pool * pool) {
+    const size_t n = entities_.size();
+
+    keys_.resize(n);
+    std::vector<size_t> order(n);
+
+    parallel_for(pool, n, [&](size_t i) {
+      keys_[i] =
+        branch_id_t(range_, entities_[i]->coordinates(), branch_id_t::max_depth)
+          .value_();
+      order[i] = i;
+    });
+
+    radix_sort(pool, keys_, order);
+
+    sorted_.resize(n);
+    points_.resize(n);
+
+    parallel_for(pool, n, [&](size_t i) {
+      sorted_[i] = entities_[order[i]];
+      points_[i] = sorted_[i]->coordinates();
+    });
+
+    clear_();
+    branches_[0].end_ = n;
+    build_(0, 0);
+  }
+
+  // Refine branch b, whose entities are the sorted keys in
+  // [begin, end), by splitting its range at the bounds of its children.
+  void build_(size_t b, size_t depth) {
+    const size_t begin = branches_[b].begin_;
+    const size_t end = branches_[b].end_;
+
+    if(end - begin <= leaf_size_ || depth == branch_id_t::max_depth) {
+      return;
+    }
+
+    const size_t first = branches_.size();
+    branches_.resize(first + num_children);
+    branches_[b].children_ = first;
+    max_depth_ = std::max(max_depth_, depth + 1);
+
+    // Shift from the id of a child to the keys of maximum depth.
+    const size_t shift = (branch_id_t::max_depth - depth - 1) * dimension;
+
+    size_t pos = begin;
+
+    for(size_t ci = 0; ci < num_children; ++ci) {
+      branch_id_t cid = branches_[b].id_;
+      cid.push(branch_int_t(ci));
+
+      size_t last = end;
+
+      if(ci + 1 < num_children) {
+        const branch_int_t bound = (cid.value_() + 1) << shift;
+        last =
+          std::lower_bound(keys_.begin() + pos, keys_.begin() + end, bound) -
+          keys_.begin();
+      }
+
+      branch_t & c = branches_[first + ci];
+      c.id_ = cid;
+      c.begin_ = pos;
+      c.end_ = last;
+
+      pos = last;
+    }
+
+    for(size_t ci = 0; ci < num_children; ++ci) {
+      build_(first + ci, depth + 1);
+    }
+  }
+
+  template<typename EF, typename BF, typename... ARGS>
+  void
+  apply_(size_t b, element_t size, EF && ef, BF && bf, ARGS &&... args) const {
+    const branch_t & br = branches_[b];
+
+    if(br.is_leaf()) {
+      for(size_t i = br.begin_; i < br.end_; ++i) {
+        ef(i);
+      }
+      return;
+    }
+
+    size /= 2;
+
+    for(size_t ci = 0; ci < num_children; ++ci) {
+      const branch_t & c = branches_[br.children_ + ci];
+
+      if(c.begin_ == c.end_) {
+        continue;
+      }
+
+      point_t origin;
+      c.id_.coordinates(range_, origin);
+
+      if(bf(origin, size, scale_, args...)) {
+        apply_(br.children_ + ci, size, ef, bf, args...);
+      }
+    }
+  }
+
+  size_t leaf_size_;
+  size_t max_depth_;
+
+  entity_vector_t entities_;
+
+  // Morton keys, entities and coordinates, in Morton order.
+  std::vector<branch_int_t> keys_;
+  entity_vector_t sorted_;
+  std::vector<point_t> points_;
+
+  // The branches; the children of a branch are contiguous.
+  std::vector<branch_t> branches_;
+
+  std::array<point_u<element_t, dimension>, 2> range_;
+  point_u<element_t, dimension> scale_;
+};
+
 } // namespace topology
 } // namespace flecsi
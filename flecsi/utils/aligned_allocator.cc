@@ -0,0 +1,55 @@
+/*
+    @@@@@@@@  @@           @@@@@@   @@@@@@@@ @@
+   /@@/////  /@@          @@////@@ @@////// /@@
+   /@@       /@@  @@@@@  @@    // /@@       /@@
+   /@@@@@@@  /@@ @@///@@/@@       /@@@@@@@@@/@@
+   /@@////   /@@/@@@@@@@/@@       ////////@@/@@
+   /@@       /@@/@@//// //@@    @@       /@@/@@
+   /@@       @@@//@@@@@@ //@@@@@@  @@@@@@@@ /@@
+   //       ///  //////   //////  ////////  //
+
+   Copyright (c) 2016, Los Alamos National Security, LLC
+   All rights reserved.
+                                                                              */
+
+/*! @file */
+
+#include <flecsi/utils/aligned_allocator.h>
+
+#include <cstdlib>
+#include <new>
+
+#include <sys/mman.h>
+
+namespace flecsi {
+namespace utils {
+
+void *
+aligned_allocate(size_t bytes, size_t alignment) {
+#if defined(FLECSI_USE_HUGE_PAGES)
+  if(bytes >= FLECSI_HUGE_PAGE_SIZE) {
+    alignment = FLECSI_HUGE_PAGE_SIZE;
+    bytes = (bytes + alignment - 1) / alignment * alignment;
+  } // if
+#endif
+
+  void * p = nullptr;
+  if(::posix_memalign(&p, alignment, bytes == 0 ? alignment : bytes) != 0)
+    throw std::bad_alloc();
+
+#if defined(FLECSI_USE_HUGE_PAGES) && defined(MADV_HUGEPAGE)
+  // This is only a hint: the buffer is still usable if it is ignored.
+  if(alignment == FLECSI_HUGE_PAGE_SIZE)
+    ::madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+
+  return p;
+} // aligned_allocate
+
+void
+aligned_deallocate(void * p) noexcept {
+  std::free(p);
+} // aligned_deallocate
+
+} // namespace utils
+} // namespace flecsi
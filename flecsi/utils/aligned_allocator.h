@@ -0,0 +1,148 @@
+/*
+    @@@@@@@@  @@           @@@@@@   @@@@@@@@ @@
+   /@@/////  /@@          @@////@@ @@////// /@@
+   /@@       /@@  @@@@@  @@    // /@@       /@@
+   /@@@@@@@  /@@ @@///@@/@@       /@@@@@@@@@/@@
+   /@@////   /@@/@@@@@@@/@@       ////////@@/@@
+   /@@       /@@/@@//// //@@    @@       /@@/@@
+   /@@       @@@//@@@@@@ //@@@@@@  @@@@@@@@ /@@
+   //       ///  //////   //////  ////////  //
+
+   Copyright (c) 2016, Los Alamos National Security, LLC
+   All rights reserved.
+                                                                              */
+#pragma once
+
+/*! @file */
+
+#include <flecsi-config.h>
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if !defined(FLECSI_FIELD_ALIGNMENT)
+#define FLECSI_FIELD_ALIGNMENT 64
+#endif
+
+#if !defined(FLECSI_HUGE_PAGE_SIZE)
+#define FLECSI_HUGE_PAGE_SIZE (size_t(2) << 20)
+#endif
+
+/*!
+  Tell the compiler that a pointer to the first element of a field is
+  aligned to FLECSI_FIELD_ALIGNMENT bytes. Only the MPI runtime allocates
+  field data with utils::aligned_allocator_u; the pointer is returned
+  unchanged with the other runtimes.
+ */
+
+#if FLECSI_RUNTIME_MODEL == FLECSI_RUNTIME_MODEL_mpi && defined(__GNUC__)
+#define FLECSI_ASSUME_FIELD_ALIGNED(p)                                         \
+  static_cast<decltype(p)>(                                                    \
+    __builtin_assume_aligned((p), FLECSI_FIELD_ALIGNMENT))
+#else
+#define FLECSI_ASSUME_FIELD_ALIGNED(p) (p)
+#endif
+
+namespace flecsi {
+namespace utils {
+
+/*!
+  Allocate a buffer of a number of bytes aligned to a power of two. If
+  FLECSI_USE_HUGE_PAGES is defined, buffers of at least one huge page are
+  aligned to a huge page, and transparent huge pages are requested for
+  them. Throws std::bad_alloc on failure.
+ */
+
+void * aligned_allocate(size_t bytes, size_t alignment);
+
+/*!
+  Free a buffer returned by aligned_allocate().
+ */
+
+void aligned_deallocate(void * p) noexcept;
+
+/*!
+  An allocator that returns buffers aligned to ALIGNMENT bytes.
+
+  Elements that are constructed without arguments are default-initialized,
+  so that, e.g., std::vector::resize() does not write to the new elements
+  of trivial types. The pages of the buffer are then first touched by
+  whoever initializes them, which decides their NUMA placement.
+
+  Large buffers may be backed by huge pages, see aligned_allocate().
+
+  @tparam T         The value type.
+  @tparam ALIGNMENT The alignment in bytes, a power of two that is at
+                    least the alignment of a pointer.
+ */
+
+template<typename T, size_t ALIGNMENT = FLECSI_FIELD_ALIGNMENT>
+class aligned_allocator_u
+{
+  static_assert((ALIGNMENT & (ALIGNMENT - 1)) == 0,
+    "alignment must be a power of two");
+  static_assert(ALIGNMENT >= sizeof(void *) && ALIGNMENT >= alignof(T),
+    "alignment is too small");
+
+public:
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = std::ptrdiff_t;
+  using propagate_on_container_move_assignment = std::true_type;
+  using is_always_equal = std::true_type;
+
+  template<typename U>
+  struct rebind {
+    using other = aligned_allocator_u<U, ALIGNMENT>;
+  };
+
+  static constexpr size_t alignment = ALIGNMENT;
+
+  aligned_allocator_u() = default;
+
+  template<typename U>
+  aligned_allocator_u(const aligned_allocator_u<U, ALIGNMENT> &) noexcept {}
+
+  T * allocate(size_t n) {
+    if(n > std::numeric_limits<size_t>::max() / sizeof(T))
+      throw std::bad_alloc();
+    return static_cast<T *>(aligned_allocate(n * sizeof(T), ALIGNMENT));
+  } // allocate
+
+  void deallocate(T * p, size_t) noexcept {
+    aligned_deallocate(p);
+  } // deallocate
+
+  //! Default-initialize elements constructed without arguments.
+  template<typename U>
+  void construct(U * p) noexcept(
+    std::is_nothrow_default_constructible<U>::value) {
+    ::new(static_cast<void *>(p)) U;
+  } // construct
+
+  template<typename U, typename... ARGS>
+  void construct(U * p, ARGS &&... args) {
+    ::new(static_cast<void *>(p)) U(std::forward<ARGS>(args)...);
+  } // construct
+
+}; // class aligned_allocator_u
+
+template<typename T, typename U, size_t ALIGNMENT>
+bool
+operator==(const aligned_allocator_u<T, ALIGNMENT> &,
+  const aligned_allocator_u<U, ALIGNMENT> &) {
+  return true;
+}
+
+template<typename T, typename U, size_t ALIGNMENT>
+bool
+operator!=(const aligned_allocator_u<T, ALIGNMENT> &,
+  const aligned_allocator_u<U, ALIGNMENT> &) {
+  return false;
+}
+
+} // namespace utils
+} // namespace flecsi
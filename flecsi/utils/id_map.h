@@ -0,0 +1,292 @@
+/*
+    @@@@@@@@  @@           @@@@@@   @@@@@@@@ @@
+   /@@/////  /@@          @@////@@ @@////// /@@
+   /@@       /@@  @@@@@  @@    // /@@       /@@
+   /@@@@@@@  /@@ @@///@@/@@       /@@@@@@@@@/@@
+   /@@////   /@@/@@@@@@@/@@       ////////@@/@@
+   /@@       /@@/@@//// //@@    @@       /@@/@@
+   /@@       @@@//@@@@@@ //@@@@@@  @@@@@@@@ /@@
+   //       ///  //////   //////  ////////  //
+
+   Copyright (c) 2016, Los Alamos National Security, LLC
+   All rights reserved.
+                                                                              */
+#pragma once
+
+/*! @file */
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace flecsi {
+namespace utils {
+
+/*!
+  A read-only map between entity ids, e.g., from mesh ids to local ids.
+
+  The map is built once from all of its entries, and is then stored in
+  flat arrays sorted by key: the values are in one array, and lookups are
+  binary searches. When the keys form a few contiguous runs, as they do
+  for block-distributed ids, only the first key of every run is stored,
+  and a single run is looked up in constant time.
+
+  Iteration visits the entries in the order of their keys, like a
+  std::map, but yields (key, value) pairs by value.
+
+  @tparam KEY   The key type, an integer type.
+  @tparam VALUE The value type.
+ */
+
+template<typename KEY, typename VALUE>
+class id_map_u
+{
+  struct run_t {
+    KEY key;
+    size_t index;
+  }; // struct run_t
+
+public:
+  using key_type = KEY;
+  using mapped_type = VALUE;
+  using value_type = std::pair<KEY, VALUE>;
+  using size_type = size_t;
+
+  class const_iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = id_map_u::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type *;
+    using reference = value_type;
+
+    const_iterator() = default;
+
+    const_iterator(const id_map_u * map, size_t index, size_t run)
+      : map_(map), index_(index), run_(run) {}
+
+    value_type operator*() const {
+      return {map_->key(index_, run_), map_->values_[index_]};
+    }
+
+    //! A proxy so that it->second works as for a std::map.
+    struct arrow_t {
+      value_type entry;
+      const value_type * operator->() const {
+        return &entry;
+      }
+    }; // struct arrow_t
+
+    arrow_t operator->() const {
+      return {**this};
+    }
+
+    const_iterator & operator++() {
+      ++index_;
+      if(run_ + 1 < map_->runs_.size() &&
+         map_->runs_[run_ + 1].index == index_)
+        ++run_;
+      return *this;
+    } // operator ++
+
+    const_iterator operator++(int) {
+      auto it = *this;
+      ++*this;
+      return it;
+    } // operator ++
+
+    bool operator==(const const_iterator & it) const {
+      return index_ == it.index_;
+    }
+
+    bool operator!=(const const_iterator & it) const {
+      return index_ != it.index_;
+    }
+
+  private:
+    const id_map_u * map_ = nullptr;
+    size_t index_ = 0;
+    size_t run_ = 0;
+  }; // class const_iterator
+
+  using iterator = const_iterator;
+
+  id_map_u() = default;
+
+  /*!
+    Build the map from its keys and the corresponding values, in any
+    order. The keys must be unique.
+   */
+
+  id_map_u(std::vector<KEY> keys, std::vector<VALUE> values) {
+    assign(std::move(keys), std::move(values));
+  } // id_map_u
+
+  /*!
+    Build the inverse of an index map, i.e., the map from index_map[i] to i.
+   */
+
+  static id_map_u invert(const std::vector<KEY> & index_map) {
+    std::vector<VALUE> values(index_map.size());
+    for(size_t i = 0; i < values.size(); ++i) {
+      values[i] = static_cast<VALUE>(i);
+    } // for
+    return id_map_u(index_map, std::move(values));
+  } // invert
+
+  /*!
+    Replace the entries of the map.
+   */
+
+  void assign(std::vector<KEY> keys, std::vector<VALUE> values) {
+    assert(keys.size() == values.size() && "keys and values do not match");
+
+    if(!std::is_sorted(keys.begin(), keys.end())) {
+      std::vector<size_t> order(keys.size());
+      for(size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+      } // for
+      std::sort(order.begin(), order.end(),
+        [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+      std::vector<KEY> sorted_keys(keys.size());
+      std::vector<VALUE> sorted_values(values.size());
+      for(size_t i = 0; i < order.size(); ++i) {
+        sorted_keys[i] = keys[order[i]];
+        sorted_values[i] = std::move(values[order[i]]);
+      } // for
+      keys.swap(sorted_keys);
+      values.swap(sorted_values);
+    } // if
+
+    assert(std::adjacent_find(keys.begin(), keys.end()) == keys.end() &&
+           "duplicate keys");
+
+    values_ = std::move(values);
+    runs_.clear();
+    keys_.clear();
+
+    for(size_t i = 0; i < keys.size(); ++i) {
+      if(i == 0 || keys[i] != keys[i - 1] + 1)
+        runs_.push_back({keys[i], i});
+    } // for
+
+    // Keep the runs only if they are more compact than the keys.
+    if(runs_.size() * sizeof(run_t) > keys.size() * sizeof(KEY)) {
+      runs_.clear();
+      keys_ = std::move(keys);
+      keys_.shrink_to_fit();
+    } // if
+  } // assign
+
+  void clear() {
+    keys_.clear();
+    runs_.clear();
+    values_.clear();
+  } // clear
+
+  size_t size() const {
+    return values_.size();
+  }
+
+  bool empty() const {
+    return values_.empty();
+  }
+
+  const_iterator begin() const {
+    return {this, 0, 0};
+  }
+
+  const_iterator end() const {
+    return {this, size(), runs_.empty() ? 0 : runs_.size() - 1};
+  }
+
+  /*!
+    Find the entry of a key, or return end().
+   */
+
+  const_iterator find(KEY key) const {
+    size_t run = 0;
+    const size_t index = lookup(key, run);
+    return index == size() ? end() : const_iterator(this, index, run);
+  } // find
+
+  size_t count(KEY key) const {
+    size_t run;
+    return lookup(key, run) == size() ? 0 : 1;
+  } // count
+
+  /*!
+    Return the value of a key. Throws std::out_of_range if the key is not
+    in the map.
+   */
+
+  const VALUE & at(KEY key) const {
+    size_t run;
+    const size_t index = lookup(key, run);
+    if(index == size())
+      throw std::out_of_range("id_map_u::at");
+    return values_[index];
+  } // at
+
+  /*!
+    Return the value of a key, which must be in the map. Unlike for a
+    std::map, this never inserts.
+   */
+
+  const VALUE & operator[](KEY key) const {
+    size_t run;
+    const size_t index = lookup(key, run);
+    assert(index < size() && "key not found");
+    return values_[index];
+  } // operator []
+
+private:
+  KEY key(size_t index, size_t run) const {
+    if(runs_.empty())
+      return keys_[index];
+    return runs_[run].key + KEY(index - runs_[run].index);
+  } // key
+
+  /*!
+    Return the position of a key in the map, or size() if it is not in
+    the map, and the run that contains it.
+   */
+
+  size_t lookup(KEY key, size_t & run) const {
+    run = 0;
+
+    if(runs_.empty()) {
+      auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+      return it != keys_.end() && *it == key ? it - keys_.begin() : size();
+    } // if
+
+    // The last run whose first key is not greater than the key.
+    auto it = std::upper_bound(runs_.begin(), runs_.end(), key,
+      [](KEY k, const run_t & r) { return k < r.key; });
+    if(it == runs_.begin())
+      return size();
+    --it;
+
+    const size_t end =
+      std::next(it) == runs_.end() ? size() : std::next(it)->index;
+    const size_t index = it->index + size_t(key - it->key);
+    if(index >= end)
+      return size();
+
+    run = it - runs_.begin();
+    return index;
+  } // lookup
+
+  std::vector<KEY> keys_;
+  std::vector<run_t> runs_;
+  std::vector<VALUE> values_;
+}; // class id_map_u
+
+} // namespace utils
+} // namespace flecsi
@@ -0,0 +1,66 @@
+/*~-------------------------------------------------------------------------~~*
+ * Copyright (c) 2016 Los Alamos National Laboratory, LLC
+ * All rights reserved
+ *~-------------------------------------------------------------------------~~*/
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Tests related to the aligned allocator.
+////////////////////////////////////////////////////////////////////////////////
+
+// user includes
+#include <flecsi/utils/aligned_allocator.h>
+
+// system includes
+#include <cinchtest.h>
+
+#include <cstdint>
+#include <vector>
+
+template<typename T, size_t ALIGNMENT = FLECSI_FIELD_ALIGNMENT>
+using aligned_vector_t =
+  std::vector<T, flecsi::utils::aligned_allocator_u<T, ALIGNMENT>>;
+
+template<size_t ALIGNMENT>
+bool
+is_aligned(const void * p) {
+  return reinterpret_cast<std::uintptr_t>(p) % ALIGNMENT == 0;
+} // is_aligned
+
+///////////////////////////////////////////////////////////////////////////////
+//! \brief Test that buffers of any size are aligned.
+///////////////////////////////////////////////////////////////////////////////
+TEST(aligned_allocator, alignment) {
+  for(size_t n : {1, 3, 17, 64, 1000, 1 << 20}) {
+    aligned_vector_t<uint8_t> bytes(n);
+    ASSERT_TRUE(is_aligned<FLECSI_FIELD_ALIGNMENT>(bytes.data()));
+
+    aligned_vector_t<double, 4096> doubles(n);
+    ASSERT_TRUE(is_aligned<4096>(doubles.data()));
+  } // for
+} // TEST
+
+///////////////////////////////////////////////////////////////////////////////
+//! \brief Test that the contents are kept when buffers grow, and that
+//! elements constructed with a value are initialized.
+///////////////////////////////////////////////////////////////////////////////
+TEST(aligned_allocator, resize) {
+  aligned_vector_t<int> v(10, 7);
+  for(size_t i = 0; i < v.size(); ++i)
+    ASSERT_EQ(7, v[i]);
+
+  for(size_t i = 0; i < v.size(); ++i)
+    v[i] = i;
+  v.resize(100000);
+  ASSERT_TRUE(is_aligned<FLECSI_FIELD_ALIGNMENT>(v.data()));
+  for(size_t i = 0; i < 10; ++i)
+    ASSERT_EQ(int(i), v[i]);
+
+  v.resize(5);
+  v.shrink_to_fit();
+  ASSERT_TRUE(is_aligned<FLECSI_FIELD_ALIGNMENT>(v.data()));
+  for(size_t i = 0; i < 5; ++i)
+    ASSERT_EQ(int(i), v[i]);
+
+  aligned_vector_t<int> w(v);
+  ASSERT_EQ(v, w);
+} // TEST
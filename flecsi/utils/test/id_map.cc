@@ -0,0 +1,102 @@
+/*~-------------------------------------------------------------------------~~*
+ * Copyright (c) 2016 Los Alamos National Laboratory, LLC
+ * All rights reserved
+ *~-------------------------------------------------------------------------~~*/
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Tests related to the flat id maps.
+////////////////////////////////////////////////////////////////////////////////
+
+// user includes
+#include <flecsi/utils/id_map.h>
+
+// system includes
+#include <cinchtest.h>
+
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+using id_map_t = flecsi::utils::id_map_u<size_t, uint32_t>;
+
+//! \brief Compare an id map with the equivalent std::map.
+void
+check(const id_map_t & map, const std::map<size_t, uint32_t> & expected) {
+  ASSERT_EQ(expected.size(), map.size());
+
+  auto it = expected.begin();
+  for(const auto & entry : map) {
+    ASSERT_EQ(it->first, entry.first);
+    ASSERT_EQ(it->second, entry.second);
+    ++it;
+  } // for
+
+  for(const auto & entry : expected) {
+    ASSERT_EQ(entry.second, map.at(entry.first));
+    ASSERT_EQ(entry.second, map[entry.first]);
+    ASSERT_EQ(1, map.count(entry.first));
+    ASSERT_EQ(entry.second, map.find(entry.first)->second);
+  } // for
+} // check
+
+///////////////////////////////////////////////////////////////////////////////
+//! \brief Test scattered keys, which are stored explicitly.
+///////////////////////////////////////////////////////////////////////////////
+TEST(id_map, scattered) {
+  std::vector<size_t> index_map = {42, 7, 19, 3, 100, 8, 55};
+  auto map = id_map_t::invert(index_map);
+
+  std::map<size_t, uint32_t> expected;
+  for(size_t i = 0; i < index_map.size(); ++i)
+    expected[index_map[i]] = i;
+
+  check(map, expected);
+
+  for(size_t key : {0, 4, 9, 56, 1000}) {
+    ASSERT_EQ(0, map.count(key));
+    ASSERT_TRUE(map.find(key) == map.end());
+    ASSERT_THROW(map.at(key), std::out_of_range);
+  } // for
+} // TEST
+
+///////////////////////////////////////////////////////////////////////////////
+//! \brief Test keys in contiguous runs, e.g., exclusive, shared and ghost
+//! blocks of a block-distributed index space.
+///////////////////////////////////////////////////////////////////////////////
+TEST(id_map, runs) {
+  std::vector<size_t> index_map;
+  for(size_t id = 100; id < 200; ++id)
+    index_map.push_back(id);
+  for(size_t id = 20; id < 30; ++id)
+    index_map.push_back(id);
+  for(size_t id = 300; id < 310; ++id)
+    index_map.push_back(id);
+  auto map = id_map_t::invert(index_map);
+
+  std::map<size_t, uint32_t> expected;
+  for(size_t i = 0; i < index_map.size(); ++i)
+    expected[index_map[i]] = i;
+
+  check(map, expected);
+
+  for(size_t key : {0, 19, 30, 99, 200, 299, 310}) {
+    ASSERT_EQ(0, map.count(key));
+    ASSERT_THROW(map.at(key), std::out_of_range);
+  } // for
+} // TEST
+
+///////////////////////////////////////////////////////////////////////////////
+//! \brief Test a single contiguous run and an empty map.
+///////////////////////////////////////////////////////////////////////////////
+TEST(id_map, contiguous) {
+  id_map_t map({5, 4, 3, 2}, {10, 11, 12, 13});
+
+  std::map<size_t, uint32_t> expected = {{2, 13}, {3, 12}, {4, 11}, {5, 10}};
+  check(map, expected);
+  ASSERT_EQ(0, map.count(6));
+
+  map.clear();
+  ASSERT_TRUE(map.empty());
+  ASSERT_TRUE(map.begin() == map.end());
+  ASSERT_EQ(0, map.count(2));
+} // TEST